@@ -0,0 +1,85 @@
+//
+// Created by pengcheng.tan on 2024/8/30.
+//
+
+#ifndef TMEDIABENCH_TMEDIABENCH_H
+#define TMEDIABENCH_TMEDIABENCH_H
+
+#include <vector>
+#include "tmediaplayer.h"
+
+typedef int (*tMediaBenchMain)(int argc, char **argv);
+
+/**
+ * One sub command of tmediabench, return 0 if success.
+ */
+typedef struct tMediaBenchCommand {
+    const char *name;
+    const char *usage;
+    tMediaBenchMain main;
+} tMediaBenchCommand;
+
+/**
+ * Options are "--name value" pairs, others are positional args.
+ */
+typedef struct tMediaBenchArgs {
+    std::vector<const char *> positional;
+    std::vector<const char *> optionNames;
+    std::vector<const char *> optionValues;
+
+    void parse(int argc, char **argv);
+
+    const char *option(const char *name, const char *defaultValue) const;
+
+    int64_t optionInt(const char *name, int64_t defaultValue) const;
+} tMediaBenchArgs;
+
+int64_t benchNowMicros();
+
+// Cpu time of all threads of process.
+int64_t benchCpuMicros();
+
+/**
+ * Evict file pages from page cache, so next run reads storage. Only clean pages are evicted, no root needed.
+ */
+void benchDropFileCache(const char *file);
+
+int64_t benchFileSize(const char *file);
+
+/**
+ * Prepare player the same way as Java player, return null if fail.
+ */
+tMediaPlayerContext *benchPreparePlayer(
+        const char *file,
+        bool requestHw,
+        tMediaIOMode ioMode,
+        int64_t readAheadBufferSize,
+        tMediaDecodeThreadType threadType,
+        int threadCount);
+
+void benchReleasePlayer(tMediaPlayerContext *player);
+
+/**
+ * p is in [0, 100], values are sorted.
+ */
+int64_t benchPercentile(std::vector<int64_t> &values, double p);
+
+const char *benchIOModeName(tMediaIOMode mode);
+
+int benchIO(int argc, char **argv);
+
+int benchPktAlloc(int argc, char **argv);
+
+int benchDecode(int argc, char **argv);
+
+int benchPixCheck(int argc, char **argv);
+
+int benchPix(int argc, char **argv);
+
+int benchHighBitDepth(int argc, char **argv);
+
+int benchSws(int argc, char **argv);
+
+int benchStress(int argc, char **argv);
+
+#endif //TMEDIABENCH_TMEDIABENCH_H
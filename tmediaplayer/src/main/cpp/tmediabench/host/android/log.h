@@ -0,0 +1,42 @@
+//
+// Created by pengcheng.tan on 2024/8/30.
+//
+
+#ifndef TMEDIABENCH_HOST_ANDROID_LOG_H
+#define TMEDIABENCH_HOST_ANDROID_LOG_H
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+
+/**
+ * Host shim of android log, print to stderr.
+ */
+enum android_LogPriority {
+    ANDROID_LOG_UNKNOWN = 0,
+    ANDROID_LOG_DEFAULT,
+    ANDROID_LOG_VERBOSE,
+    ANDROID_LOG_DEBUG,
+    ANDROID_LOG_INFO,
+    ANDROID_LOG_WARN,
+    ANDROID_LOG_ERROR,
+    ANDROID_LOG_FATAL,
+    ANDROID_LOG_SILENT
+};
+
+__attribute__((format(printf, 3, 4)))
+static inline int __android_log_print(int prio, const char *tag, const char *fmt, ...) {
+    // Debug logs flood benchmark results, print them only if TMEDIA_BENCH_VERBOSE is set.
+    if (prio < ANDROID_LOG_WARN && getenv("TMEDIA_BENCH_VERBOSE") == nullptr) {
+        return 0;
+    }
+    va_list args;
+    va_start(args, fmt);
+    fprintf(stderr, "%s: ", tag);
+    int ret = vfprintf(stderr, fmt, args);
+    fputc('\n', stderr);
+    va_end(args);
+    return ret;
+}
+
+#endif //TMEDIABENCH_HOST_ANDROID_LOG_H
@@ -0,0 +1,17 @@
+//
+// Created by pengcheng.tan on 2024/8/30.
+//
+
+#ifndef TMEDIABENCH_HOST_JNI_H
+#define TMEDIABENCH_HOST_JNI_H
+
+/**
+ * Host shim of jni.h, player core only keeps these handles for JNI entries, they are always null without JVM.
+ */
+struct _JavaVM;
+typedef _JavaVM JavaVM;
+class _jobject {};
+typedef _jobject *jobject;
+typedef jobject jclass;
+
+#endif //TMEDIABENCH_HOST_JNI_H
@@ -0,0 +1,144 @@
+//
+// Created by pengcheng.tan on 2024/8/30.
+//
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <ctime>
+#include <algorithm>
+#include "tmediabench.h"
+
+extern "C" {
+#include "libavutil/time.h"
+}
+
+static const tMediaBenchCommand benchCommands[] = {
+        {"io", "io <file>... [--runs 3] [--buffer 8388608]: demux throughput of custom io modes (io_uring included) and default file protocol, pass interleaved and non-interleaved files", benchIO},
+        {"pktalloc", "pktalloc <file>... [--io 0]: demuxer payload allocations per second of media, io is ordinal of tMediaIOMode", benchPktAlloc},
+        {"decode", "decode <file>... [--frames 0] [--max-threads cores]: software video decode fps and cpu time of every thread policy", benchDecode},
+        {"pixcheck", "pixcheck [--seed 1]: simd pixel kernels against scalar and conversions against swscale, odd sizes and every supported format", benchPixCheck},
+        {"pix", "pix [--width 3840] [--height 2160] [--iterations 20]: throughput of every pixel kernel level and conversions against swscale", benchPix},
+        {"highbitdepth", "highbitdepth <file>... [--frames 300]: per frame time of 10 bits conversion to yuv420p against passthrough, pass 4K 10 bits files", benchHighBitDepth},
+        {"sws", "sws [--width 3840] [--height 2160] [--iterations 30] [--max-threads 8]: sliced sws conversion time with auto and 1..N slice threads", benchSws},
+        {"stress", "stress <file>... [--players 32] [--rounds 4] [--frames 30]: players prepare, decode and release in parallel, prepare latency percentiles", benchStress},
+};
+
+void tMediaBenchArgs::parse(int argc, char **argv) {
+    for (int i = 0; i < argc; i ++) {
+        if (strncmp(argv[i], "--", 2) == 0 && i + 1 < argc) {
+            optionNames.push_back(argv[i] + 2);
+            optionValues.push_back(argv[i + 1]);
+            i ++;
+        } else {
+            positional.push_back(argv[i]);
+        }
+    }
+}
+
+const char *tMediaBenchArgs::option(const char *name, const char *defaultValue) const {
+    for (size_t i = 0; i < optionNames.size(); i ++) {
+        if (strcmp(optionNames[i], name) == 0) {
+            return optionValues[i];
+        }
+    }
+    return defaultValue;
+}
+
+int64_t tMediaBenchArgs::optionInt(const char *name, int64_t defaultValue) const {
+    const char *value = option(name, nullptr);
+    return value != nullptr ? strtoll(value, nullptr, 10) : defaultValue;
+}
+
+int64_t benchNowMicros() {
+    return av_gettime_relative();
+}
+
+int64_t benchCpuMicros() {
+    struct timespec ts {};
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (int64_t) ts.tv_sec * 1000000L + ts.tv_nsec / 1000L;
+}
+
+void benchDropFileCache(const char *file) {
+    int fd = open(file, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+}
+
+int64_t benchFileSize(const char *file) {
+    struct stat st {};
+    if (stat(file, &st) != 0) {
+        return -1;
+    }
+    return st.st_size;
+}
+
+tMediaPlayerContext *benchPreparePlayer(
+        const char *file,
+        bool requestHw,
+        tMediaIOMode ioMode,
+        int64_t readAheadBufferSize,
+        tMediaDecodeThreadType threadType,
+        int threadCount) {
+    auto player = new tMediaPlayerContext;
+    auto result = player->prepare(file, requestHw, 2, 48000, 16, ioMode, readAheadBufferSize, false, threadType, threadCount);
+    if (result != OptSuccess) {
+        benchReleasePlayer(player);
+        return nullptr;
+    }
+    return player;
+}
+
+void benchReleasePlayer(tMediaPlayerContext *player) {
+    player->release();
+}
+
+int64_t benchPercentile(std::vector<int64_t> &values, double p) {
+    if (values.empty()) {
+        return 0;
+    }
+    std::sort(values.begin(), values.end());
+    auto index = (size_t) (p / 100.0 * (double) (values.size() - 1) + 0.5);
+    return values[std::min(index, values.size() - 1)];
+}
+
+const char *benchIOModeName(tMediaIOMode mode) {
+    switch (mode) {
+        case IODefault:
+            return "default";
+        case IOMmap:
+            return "mmap";
+        case IOReadAhead:
+            return "readahead";
+        case IOAsyncRead:
+            return "asyncread";
+        case IOUringRead:
+            return "uringread";
+        default:
+            return "unknown";
+    }
+}
+
+static void printUsage() {
+    fprintf(stderr, "Usage: tmediabench <command> [args]\n");
+    for (auto &c : benchCommands) {
+        fprintf(stderr, "  %s\n", c.usage);
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        printUsage();
+        return 1;
+    }
+    for (auto &c : benchCommands) {
+        if (strcmp(argv[1], c.name) == 0) {
+            return c.main(argc - 2, argv + 2);
+        }
+    }
+    printUsage();
+    return 1;
+}
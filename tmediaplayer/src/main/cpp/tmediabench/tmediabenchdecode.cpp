@@ -0,0 +1,126 @@
+//
+// Created by pengcheng.tan on 2024/8/30.
+//
+#include <thread>
+#include "tmediabench.h"
+
+// Stop decode after continuous read fails.
+#define BENCH_DECODE_MAX_READ_FAILS 16
+
+typedef struct tMediaBenchDecodeRun {
+    int64_t frames = 0;
+    int64_t wallTime = 0;
+    int64_t cpuTime = 0;
+    int64_t threadStats[DECODE_THREADS_STATS_SIZE] = {0};
+} tMediaBenchDecodeRun;
+
+static void countDecoded(tMediaDecodeResult result, tMediaBenchDecodeRun *run) {
+    if (result == DecodeSuccess || result == DecodeSuccessAndSkipNextPkt) {
+        run->frames ++;
+    }
+}
+
+static bool runDecode(const char *file, tMediaDecodeThreadType type, int threadCount, int64_t maxFrames, tMediaBenchDecodeRun *run) {
+    auto player = benchPreparePlayer(file, false, IODefault, IO_READ_AHEAD_DEFAULT_BUFFER_SIZE, type, threadCount);
+    if (player == nullptr) {
+        fprintf(stderr, "Prepare %s fail.\n", file);
+        return false;
+    }
+    if (player->video_stream == nullptr || player->videoIsAttachPic) {
+        fprintf(stderr, "%s has no video stream.\n", file);
+        benchReleasePlayer(player);
+        return false;
+    }
+    int fails = 0;
+    int64_t wallStart = benchNowMicros();
+    int64_t cpuStart = benchCpuMicros();
+    while (fails < BENCH_DECODE_MAX_READ_FAILS && (maxFrames <= 0 || run->frames < maxFrames)) {
+        auto readResult = player->readPacket();
+        if (readResult == ReadEof) {
+            // Send null packet and drain frames buffered by frame threads.
+            auto result = player->decodeVideo(nullptr);
+            countDecoded(result, run);
+            while (avcodec_receive_frame(player->video_decoder_ctx, player->video_frame) >= 0) {
+                run->frames ++;
+                av_frame_unref(player->video_frame);
+            }
+            break;
+        }
+        if (readResult == ReadFail) {
+            fails ++;
+            continue;
+        }
+        fails = 0;
+        if (readResult != ReadVideoSuccess) {
+            av_packet_unref(player->pkt);
+            continue;
+        }
+        auto result = player->decodeVideo(player->pkt);
+        countDecoded(result, run);
+        // Decoder was full, packet is kept in video_pkt.
+        while (result == DecodeSuccessAndSkipNextPkt) {
+            result = player->decodeVideo(nullptr);
+            countDecoded(result, run);
+        }
+    }
+    run->wallTime = benchNowMicros() - wallStart;
+    run->cpuTime = benchCpuMicros() - cpuStart;
+    player->video_decode_threads.writeStats(run->threadStats);
+    benchReleasePlayer(player);
+    return true;
+}
+
+static const char *threadTypeName(int64_t type) {
+    switch (type) {
+        case DecodeThreadAuto:
+            return "auto";
+        case DecodeThreadFrame:
+            return "frame";
+        case DecodeThreadSlice:
+            return "slice";
+        default:
+            return "single";
+    }
+}
+
+int benchDecode(int argc, char **argv) {
+    tMediaBenchArgs args;
+    args.parse(argc, argv);
+    if (args.positional.empty()) {
+        fprintf(stderr, "No input files.\n");
+        return 1;
+    }
+    int64_t maxFrames = args.optionInt("frames", 0);
+    int maxThreads = (int) args.optionInt("max-threads", FFMIN((int) std::thread::hardware_concurrency(), DECODE_MAX_THREAD_COUNT));
+    maxThreads = FFMAX(maxThreads, 1);
+    // Requested policies: auto, then frame and slice threading with 1, 2, 4 ... maxThreads threads.
+    std::vector<std::pair<tMediaDecodeThreadType, int>> policies;
+    policies.emplace_back(DecodeThreadAuto, 0);
+    for (auto type : {DecodeThreadFrame, DecodeThreadSlice}) {
+        for (int count = 1; count <= maxThreads; count *= 2) {
+            policies.emplace_back(type, count);
+        }
+        if ((maxThreads & (maxThreads - 1)) != 0) {
+            policies.emplace_back(type, maxThreads);
+        }
+    }
+    // cpuPerFrameUs: cpu time of all threads per frame, (cpuMs / wallMs) is cores used.
+    printf("file,requestType,requestCount,appliedType,appliedCount,retunes,frames,wallMs,fps,cpuMs,cpuPerFrameUs\n");
+    for (auto file : args.positional) {
+        for (auto &p : policies) {
+            benchDropFileCache(file);
+            tMediaBenchDecodeRun run;
+            if (!runDecode(file, p.first, p.second, maxFrames, &run)) {
+                break;
+            }
+            double wallMs = (double) FFMAX(run.wallTime, (int64_t) 1) / 1000.0;
+            printf("%s,%s,%d,%s,%lld,%lld,%lld,%.1f,%.1f,%.1f,%.1f\n",
+                   file, threadTypeName(p.first), p.second,
+                   threadTypeName(run.threadStats[0]), (long long) run.threadStats[1], (long long) run.threadStats[5],
+                   (long long) run.frames, wallMs, (double) run.frames * 1000.0 / wallMs,
+                   (double) run.cpuTime / 1000.0,
+                   (double) run.cpuTime / (double) FFMAX(run.frames, (int64_t) 1));
+        }
+    }
+    return 0;
+}
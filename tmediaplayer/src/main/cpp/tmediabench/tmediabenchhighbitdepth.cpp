@@ -0,0 +1,134 @@
+//
+// Created by pengcheng.tan on 2024/8/30.
+//
+#include "tmediabench.h"
+
+// Stop decode after continuous read fails.
+#define BENCH_HIGH_BIT_DEPTH_MAX_READ_FAILS 16
+
+typedef struct tMediaBenchHighBitDepthRun {
+    int64_t frames = 0;
+    // Frames output as yuv420p10 / p010 with passthrough.
+    int64_t passthroughFrames = 0;
+    int64_t convertTime = 0;
+    int64_t passthroughTime = 0;
+    int64_t convertBytes = 0;
+    int64_t passthroughBytes = 0;
+} tMediaBenchHighBitDepthRun;
+
+static int64_t bufferContentBytes(tMediaVideoBuffer *b) {
+    return (int64_t) b->rgbaContentSize + b->yContentSize + b->uContentSize + b->vContentSize + b->uvContentSize;
+}
+
+static void resetContentSizes(tMediaVideoBuffer *b) {
+    b->rgbaContentSize = 0;
+    b->yContentSize = 0;
+    b->uContentSize = 0;
+    b->vContentSize = 0;
+    b->uvContentSize = 0;
+}
+
+/**
+ * Move decoded frame to buffer twice, converted to 8 bits yuv420p and passthrough, frame is kept in keep.
+ */
+static void moveFrame(tMediaPlayerContext *player, AVFrame *keep, tMediaVideoBuffer *convertBuffer,
+                      tMediaVideoBuffer *passthroughBuffer, tMediaBenchHighBitDepthRun *run) {
+    av_frame_unref(keep);
+    if (av_frame_ref(keep, player->video_frame) < 0) {
+        return;
+    }
+    player->video_high_bit_depth_passthrough = false;
+    resetContentSizes(convertBuffer);
+    int64_t start = benchNowMicros();
+    auto result = player->moveDecodedVideoFrameToBuffer(convertBuffer);
+    run->convertTime += benchNowMicros() - start;
+    if (result != OptSuccess) {
+        return;
+    }
+    run->convertBytes += bufferContentBytes(convertBuffer);
+
+    av_frame_ref(player->video_frame, keep);
+    player->video_high_bit_depth_passthrough = true;
+    resetContentSizes(passthroughBuffer);
+    start = benchNowMicros();
+    result = player->moveDecodedVideoFrameToBuffer(passthroughBuffer);
+    run->passthroughTime += benchNowMicros() - start;
+    if (result != OptSuccess) {
+        return;
+    }
+    run->passthroughBytes += bufferContentBytes(passthroughBuffer);
+    if (passthroughBuffer->type == Yuv420p10 || passthroughBuffer->type == P010) {
+        run->passthroughFrames ++;
+    }
+    run->frames ++;
+}
+
+static void moveDecodedFrames(tMediaPlayerContext *player, tMediaDecodeResult result, AVFrame *keep, tMediaVideoBuffer *convertBuffer,
+                              tMediaVideoBuffer *passthroughBuffer, tMediaBenchHighBitDepthRun *run) {
+    if (result == DecodeSuccess || result == DecodeSuccessAndSkipNextPkt) {
+        moveFrame(player, keep, convertBuffer, passthroughBuffer, run);
+    }
+}
+
+int benchHighBitDepth(int argc, char **argv) {
+    tMediaBenchArgs args;
+    args.parse(argc, argv);
+    if (args.positional.empty()) {
+        fprintf(stderr, "No input files.\n");
+        return 1;
+    }
+    int64_t maxFrames = args.optionInt("frames", 300);
+    // Time of moveDecodedVideoFrameToBuffer() per frame, bytes are buffer content Java copies per frame.
+    printf("file,size,pixFmt,frames,passthroughFrames,convertUs,passthroughUs,savedUs,convertKB,passthroughKB\n");
+    for (auto file : args.positional) {
+        auto player = benchPreparePlayer(file, false, IODefault, IO_READ_AHEAD_DEFAULT_BUFFER_SIZE, DecodeThreadAuto, 0);
+        if (player == nullptr) {
+            fprintf(stderr, "Prepare %s fail.\n", file);
+            continue;
+        }
+        if (player->video_stream == nullptr || player->videoIsAttachPic) {
+            fprintf(stderr, "%s has no video stream.\n", file);
+            benchReleasePlayer(player);
+            continue;
+        }
+        auto keep = av_frame_alloc();
+        auto convertBuffer = new tMediaVideoBuffer;
+        auto passthroughBuffer = new tMediaVideoBuffer;
+        tMediaBenchHighBitDepthRun run;
+        int fails = 0;
+        while (fails < BENCH_HIGH_BIT_DEPTH_MAX_READ_FAILS && run.frames < maxFrames) {
+            auto readResult = player->readPacket();
+            if (readResult == ReadEof) {
+                break;
+            }
+            if (readResult == ReadFail) {
+                fails ++;
+                continue;
+            }
+            fails = 0;
+            if (readResult != ReadVideoSuccess) {
+                av_packet_unref(player->pkt);
+                continue;
+            }
+            auto result = player->decodeVideo(player->pkt);
+            moveDecodedFrames(player, result, keep, convertBuffer, passthroughBuffer, &run);
+            while (result == DecodeSuccessAndSkipNextPkt) {
+                result = player->decodeVideo(nullptr);
+                moveDecodedFrames(player, result, keep, convertBuffer, passthroughBuffer, &run);
+            }
+        }
+        auto frames = (double) FFMAX(run.frames, (int64_t) 1);
+        double convertUs = (double) run.convertTime / frames;
+        double passthroughUs = (double) run.passthroughTime / frames;
+        printf("%s,%dx%d,%s,%lld,%lld,%.1f,%.1f,%.1f,%.1f,%.1f\n",
+               file, player->video_width, player->video_height, av_get_pix_fmt_name(player->video_pixel_format),
+               (long long) run.frames, (long long) run.passthroughFrames,
+               convertUs, passthroughUs, convertUs - passthroughUs,
+               (double) run.convertBytes / frames / 1024.0, (double) run.passthroughBytes / frames / 1024.0);
+        convertBuffer->release();
+        passthroughBuffer->release();
+        av_frame_free(&keep);
+        benchReleasePlayer(player);
+    }
+    return 0;
+}
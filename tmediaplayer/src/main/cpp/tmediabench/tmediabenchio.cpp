@@ -0,0 +1,110 @@
+//
+// Created by pengcheng.tan on 2024/8/30.
+//
+#include <algorithm>
+#include "tmediabench.h"
+
+// Stop a run after continuous read fails.
+#define BENCH_IO_MAX_READ_FAILS 16
+
+typedef struct tMediaBenchIORun {
+    int64_t prepareTime = 0;
+    int64_t demuxTime = 0;
+    int64_t packets = 0;
+    int64_t bytesRead = 0;
+    int64_t readSyscalls = -1;
+    int64_t stallTime = -1;
+    int64_t seekCount = -1;
+    // Sum of distance between end of a packet and start of next packet, large on badly interleaved files.
+    int64_t jumpBytes = 0;
+} tMediaBenchIORun;
+
+static bool runDemux(const char *file, tMediaIOMode mode, int64_t bufferSize, tMediaBenchIORun *run) {
+    benchDropFileCache(file);
+    int64_t start = benchNowMicros();
+    auto player = benchPreparePlayer(file, false, mode, bufferSize, DecodeThreadAuto, 0);
+    if (player == nullptr) {
+        fprintf(stderr, "Prepare %s with %s io fail.\n", file, benchIOModeName(mode));
+        return false;
+    }
+    run->prepareTime = benchNowMicros() - start;
+    int fails = 0;
+    int64_t lastEnd = -1;
+    while (fails < BENCH_IO_MAX_READ_FAILS) {
+        auto result = player->readPacket();
+        if (result == ReadEof) {
+            break;
+        }
+        if (result == ReadFail) {
+            fails ++;
+            continue;
+        }
+        fails = 0;
+        run->packets ++;
+        auto p = player->pkt;
+        if (p->pos >= 0) {
+            if (lastEnd >= 0) {
+                run->jumpBytes += FFABS(p->pos - lastEnd);
+            }
+            lastEnd = p->pos + p->size;
+        }
+        av_packet_unref(p);
+    }
+    run->demuxTime = benchNowMicros() - start - run->prepareTime;
+    if (player->io_ctx != nullptr) {
+        int64_t stats[IO_STATS_SIZE];
+        player->io_ctx->writeStats(stats);
+        run->bytesRead = stats[0];
+        run->readSyscalls = stats[1];
+        run->stallTime = stats[2];
+        run->seekCount = stats[3];
+    } else if (player->format_ctx->pb != nullptr) {
+        run->bytesRead = player->format_ctx->pb->bytes_read;
+    }
+    benchReleasePlayer(player);
+    return true;
+}
+
+int benchIO(int argc, char **argv) {
+    tMediaBenchArgs args;
+    args.parse(argc, argv);
+    if (args.positional.empty()) {
+        fprintf(stderr, "No input files.\n");
+        return 1;
+    }
+    int runs = (int) FFMAX(args.optionInt("runs", 3), (int64_t) 1);
+    int64_t bufferSize = args.optionInt("buffer", IO_READ_AHEAD_DEFAULT_BUFFER_SIZE);
+    const tMediaIOMode modes[] = {IODefault, IOMmap, IOReadAhead, IOAsyncRead, IOUringRead};
+    printf("io_uring supported: %d\n", isIOUringSupported());
+    // avgJumpKB: average distance between packets in file, near 0 for interleaved files.
+    printf("file,mode,prepareMs,demuxMs,MBps,packets,avgJumpKB,bytesRead,readSyscalls,stallMs,seeks\n");
+    for (auto file : args.positional) {
+        int64_t fileSize = benchFileSize(file);
+        for (auto mode : modes) {
+            // Median of total time, page cache is dropped before every run.
+            std::vector<tMediaBenchIORun> results;
+            for (int i = 0; i < runs; i ++) {
+                tMediaBenchIORun run;
+                if (runDemux(file, mode, bufferSize, &run)) {
+                    results.push_back(run);
+                }
+            }
+            if (results.empty()) {
+                continue;
+            }
+            std::sort(results.begin(), results.end(), [](const tMediaBenchIORun &a, const tMediaBenchIORun &b) {
+                return a.prepareTime + a.demuxTime < b.prepareTime + b.demuxTime;
+            });
+            auto &r = results[results.size() / 2];
+            int64_t total = FFMAX(r.prepareTime + r.demuxTime, (int64_t) 1);
+            printf("%s,%s,%.1f,%.1f,%.1f,%lld,%.1f,%lld,%lld,%.1f,%lld\n",
+                   file, benchIOModeName(mode),
+                   (double) r.prepareTime / 1000.0, (double) r.demuxTime / 1000.0,
+                   (double) fileSize / (double) total,
+                   (long long) r.packets, (double) r.jumpBytes / 1024.0 / (double) FFMAX(r.packets, (int64_t) 1),
+                   (long long) r.bytesRead, (long long) r.readSyscalls,
+                   r.stallTime >= 0 ? (double) r.stallTime / 1000.0 : -1.0, (long long) r.seekCount);
+        }
+    }
+    return 0;
+}
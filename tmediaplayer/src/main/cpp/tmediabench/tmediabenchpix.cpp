@@ -0,0 +1,424 @@
+//
+// Created by pengcheng.tan on 2024/8/30.
+//
+#include <cmath>
+#include <random>
+#include "tmediabench.h"
+#include "tmediapixconvert.h"
+
+extern "C" {
+#include "libswscale/swscale.h"
+#include "libavutil/imgutils.h"
+}
+
+// Max kernel row width of checks and benchmarks.
+#define BENCH_PIX_MAX_WIDTH 4096
+
+/**
+ * Swscale rounds and dithers high bit depth differently, and its range conversion uses its own coefficients.
+ */
+#define BENCH_PIX_SWS_MAX_DIFF 2
+
+static const int checkSizes[][2] = {
+        {1, 1}, {3, 3}, {17, 9}, {33, 15}, {63, 31}, {127, 65}, {255, 129}, {1921, 1081},
+        {34, 18}, {17, 10}, {63, 32}, {1920, 1080}
+};
+
+static const AVPixelFormat convertFormats[] = {
+        AV_PIX_FMT_YUV420P10LE,
+        AV_PIX_FMT_P010LE,
+        AV_PIX_FMT_YUVJ420P,
+        AV_PIX_FMT_YUV422P
+};
+
+static const char *levelName(tMediaPixConvertLevel level) {
+    switch (level) {
+        case PixConvertScalar:
+            return "scalar";
+        case PixConvertNeon:
+            return "neon";
+        case PixConvertSse2:
+            return "sse2";
+        case PixConvertAvx2:
+            return "avx2";
+        default:
+            return "unknown";
+    }
+}
+
+static void fillRandom(uint8_t *data, int64_t size, std::mt19937 &rand) {
+    for (int64_t i = 0; i < size; i ++) {
+        data[i] = (uint8_t) rand();
+    }
+}
+
+// region Kernels check
+typedef struct tMediaBenchPixRows {
+    uint16_t srcU16[BENCH_PIX_MAX_WIDTH * 2];
+    uint8_t a[BENCH_PIX_MAX_WIDTH * 2];
+    uint8_t b[BENCH_PIX_MAX_WIDTH * 2];
+    uint8_t expect[2][BENCH_PIX_MAX_WIDTH];
+    uint8_t actual[2][BENCH_PIX_MAX_WIDTH];
+} tMediaBenchPixRows;
+
+static int checkRow(const char *kernel, tMediaPixConvertLevel level, int width, tMediaBenchPixRows *rows, int planes) {
+    for (int p = 0; p < planes; p ++) {
+        for (int x = 0; x < width; x ++) {
+            if (rows->expect[p][x] != rows->actual[p][x]) {
+                fprintf(stderr, "%s %s width %d plane %d x %d: expect %d, actual %d\n",
+                        levelName(level), kernel, width, p, x, rows->expect[p][x], rows->actual[p][x]);
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * Every simd kernel must be bit exact with scalar kernel, widths cover simd body and scalar tail.
+ */
+static int checkKernels(std::mt19937 &rand) {
+    auto scalar = getPixConvertKernelsOfLevel(PixConvertScalar);
+    auto rows = new tMediaBenchPixRows;
+    int fails = 0;
+    std::vector<int> widths;
+    for (int w = 1; w <= 130; w ++) {
+        widths.push_back(w);
+    }
+    widths.push_back(1919);
+    widths.push_back(BENCH_PIX_MAX_WIDTH - 1);
+    for (auto level : {PixConvertNeon, PixConvertSse2, PixConvertAvx2}) {
+        auto k = getPixConvertKernelsOfLevel(level);
+        if (k == nullptr) {
+            printf("pixcheck: %s not supported, skipped\n", levelName(level));
+            continue;
+        }
+        for (auto w : widths) {
+            // Full u16 range checks saturation.
+            fillRandom((uint8_t *) rows->srcU16, sizeof(rows->srcU16), rand);
+            fillRandom(rows->a, sizeof(rows->a), rand);
+            fillRandom(rows->b, sizeof(rows->b), rand);
+            for (int shift : {2, 8}) {
+                scalar->u16ToU8(rows->srcU16, rows->expect[0], w, shift);
+                k->u16ToU8(rows->srcU16, rows->actual[0], w, shift);
+                fails += checkRow("u16ToU8", level, w, rows, 1);
+                scalar->deinterleaveU16ToU8(rows->srcU16, rows->expect[0], rows->expect[1], w, shift);
+                k->deinterleaveU16ToU8(rows->srcU16, rows->actual[0], rows->actual[1], w, shift);
+                fails += checkRow("deinterleaveU16ToU8", level, w, rows, 2);
+            }
+            scalar->fullToLimitedLuma(rows->a, rows->expect[0], w);
+            k->fullToLimitedLuma(rows->a, rows->actual[0], w);
+            fails += checkRow("fullToLimitedLuma", level, w, rows, 1);
+            scalar->fullToLimitedChroma(rows->a, rows->expect[0], w);
+            k->fullToLimitedChroma(rows->a, rows->actual[0], w);
+            fails += checkRow("fullToLimitedChroma", level, w, rows, 1);
+            scalar->averageRows(rows->a, rows->b, rows->expect[0], w);
+            k->averageRows(rows->a, rows->b, rows->actual[0], w);
+            fails += checkRow("averageRows", level, w, rows, 1);
+            scalar->boxDownscale2x(rows->a, rows->b, rows->expect[0], w);
+            k->boxDownscale2x(rows->a, rows->b, rows->actual[0], w);
+            fails += checkRow("boxDownscale2x", level, w, rows, 1);
+        }
+        printf("pixcheck: %s kernels checked\n", levelName(level));
+    }
+    delete rows;
+    return fails;
+}
+// endregion
+
+// region Conversions check
+/**
+ * Smooth pattern with small noise, swscale filters and simple kernels only differ by rounding on it.
+ */
+static AVFrame *allocTestFrame(AVPixelFormat format, int w, int h, std::mt19937 &rand) {
+    auto f = av_frame_alloc();
+    f->format = format;
+    f->width = w;
+    f->height = h;
+    if (av_frame_get_buffer(f, 0) < 0) {
+        av_frame_free(&f);
+        return nullptr;
+    }
+    auto desc = av_pix_fmt_desc_get(format);
+    bool highBitDepth = desc->comp[0].depth > 8;
+    int maxValue = (1 << desc->comp[0].depth) - 1;
+    for (int p = 0; p < 4 && f->data[p] != nullptr; p ++) {
+        bool interleaved = desc->nb_components > 2 && desc->comp[1].plane == desc->comp[2].plane && p == desc->comp[1].plane;
+        int samples = p == 0 ? w : AV_CEIL_RSHIFT(w, desc->log2_chroma_w) * (interleaved ? 2 : 1);
+        int rowsCount = p == 0 ? h : AV_CEIL_RSHIFT(h, desc->log2_chroma_h);
+        for (int y = 0; y < rowsCount; y ++) {
+            for (int x = 0; x < samples; x ++) {
+                double wave = sin((double) (x + 11 * p) / 13.0) * cos((double) (y + 7 * p) / 9.0);
+                int v = (int) ((wave * 0.45 + 0.5) * maxValue) + (int) (rand() % 5) - 2;
+                v = av_clip(v, 0, maxValue);
+                if (highBitDepth) {
+                    // P010 keeps 10 bits samples in high bits.
+                    ((uint16_t *) (f->data[p] + y * f->linesize[p]))[x] = (uint16_t) (v << desc->comp[0].shift);
+                } else {
+                    f->data[p][y * f->linesize[p] + x] = (uint8_t) v;
+                }
+            }
+        }
+    }
+    return f;
+}
+
+static int comparePlanes(const char *name, const AVFrame *src, int outW, int outH, uint8_t *const expectData[4],
+                         const int expectLineSize[4], uint8_t *const data[4], const int lineSize[4], int maxDiff) {
+    for (int p = 0; p < 3; p ++) {
+        int w = p == 0 ? outW : AV_CEIL_RSHIFT(outW, 1);
+        int h = p == 0 ? outH : AV_CEIL_RSHIFT(outH, 1);
+        for (int y = 0; y < h; y ++) {
+            for (int x = 0; x < w; x ++) {
+                int expect = expectData[p][y * expectLineSize[p] + x];
+                int actual = data[p][y * lineSize[p] + x];
+                if (FFABS(expect - actual) > maxDiff) {
+                    fprintf(stderr, "%s %dx%d plane %d (%d, %d): expect %d, actual %d\n",
+                            name, src->width, src->height, p, x, y, expect, actual);
+                    return 1;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * Compare with swscale output, return 1 if a sample is out of tolerance.
+ */
+static int compareWithSws(const char *name, const AVFrame *src, int outW, int outH, int swsFlags,
+                          uint8_t *const data[4], const int lineSize[4]) {
+    uint8_t *swsData[4] = {nullptr};
+    int swsLineSize[4] = {0};
+    if (av_image_alloc(swsData, swsLineSize, outW, outH, AV_PIX_FMT_YUV420P, 16) < 0) {
+        return 1;
+    }
+    auto sws = sws_getContext(src->width, src->height, (AVPixelFormat) src->format, outW, outH, AV_PIX_FMT_YUV420P,
+                              swsFlags | SWS_ACCURATE_RND, nullptr, nullptr, nullptr);
+    int ret = 1;
+    if (sws != nullptr && sws_scale(sws, src->data, src->linesize, 0, src->height, swsData, swsLineSize) >= 0) {
+        ret = comparePlanes(name, src, outW, outH, swsData, swsLineSize, data, lineSize, BENCH_PIX_SWS_MAX_DIFF);
+    } else {
+        fprintf(stderr, "%s %dx%d: sws fail\n", name, src->width, src->height);
+    }
+    sws_freeContext(sws);
+    av_freep(&swsData[0]);
+    return ret;
+}
+
+/**
+ * Odd height 4:2:2 has no exact 2:1 chroma ratio, swscale spreads rows over the whole plane there.
+ * Kernel averages row pairs and keeps the last row, compare with that rule exactly.
+ */
+static int compareWith422Reference(const AVFrame *src, uint8_t *const data[4], const int lineSize[4]) {
+    int w = src->width;
+    int h = src->height;
+    uint8_t *refData[4] = {nullptr};
+    int refLineSize[4] = {0};
+    if (av_image_alloc(refData, refLineSize, w, h, AV_PIX_FMT_YUV420P, 16) < 0) {
+        return 1;
+    }
+    av_image_copy_plane(refData[0], refLineSize[0], src->data[0], src->linesize[0], w, h);
+    for (int p = 1; p <= 2; p ++) {
+        for (int y = 0; y < AV_CEIL_RSHIFT(h, 1); y ++) {
+            const uint8_t *r0 = src->data[p] + (2 * y) * src->linesize[p];
+            const uint8_t *r1 = 2 * y + 1 < h ? r0 + src->linesize[p] : r0;
+            for (int x = 0; x < AV_CEIL_RSHIFT(w, 1); x ++) {
+                refData[p][y * refLineSize[p] + x] = (uint8_t) ((r0[x] + r1[x] + 1) >> 1);
+            }
+        }
+    }
+    int ret = comparePlanes("yuv422p reference", src, w, h, refData, refLineSize, data, lineSize, 0);
+    av_freep(&refData[0]);
+    return ret;
+}
+
+static int checkConversions(std::mt19937 &rand) {
+    int fails = 0;
+    for (auto format : convertFormats) {
+        auto name = av_get_pix_fmt_name(format);
+        for (auto &size : checkSizes) {
+            int w = size[0];
+            int h = size[1];
+            auto src = allocTestFrame(format, w, h, rand);
+            uint8_t *data[4] = {nullptr};
+            int lineSize[4] = {0};
+            if (src == nullptr || av_image_alloc(data, lineSize, w, h, AV_PIX_FMT_YUV420P, 16) < 0) {
+                av_frame_free(&src);
+                fails ++;
+                continue;
+            }
+            if (!pixConvertToYuv420p(src, data, lineSize, w, h)) {
+                fprintf(stderr, "%s %dx%d: not converted\n", name, w, h);
+                fails ++;
+            } else {
+                if (format == AV_PIX_FMT_YUV422P && h % 2 != 0) {
+                    fails += compareWith422Reference(src, data, lineSize);
+                } else {
+                    // 4:2:2 chroma rows are averaged, same as area filter of exact 2:1.
+                    fails += compareWithSws(name, src, w, h, format == AV_PIX_FMT_YUV422P ? SWS_AREA : SWS_POINT, data, lineSize);
+                }
+            }
+            av_freep(&data[0]);
+            av_frame_free(&src);
+        }
+        printf("pixcheck: %s conversion checked\n", name);
+    }
+    // Downscale only supports sizes aligned to 2^(shift + 1).
+    for (int shift = 1; shift <= 3; shift ++) {
+        for (auto &size : checkSizes) {
+            int w = size[0];
+            int h = size[1];
+            auto src = allocTestFrame(AV_PIX_FMT_YUV420P, w, h, rand);
+            if (src == nullptr) {
+                fails ++;
+                continue;
+            }
+            int align = 1 << (shift + 1);
+            bool aligned = w % align == 0 && h % align == 0;
+            uint8_t *data[4] = {nullptr};
+            int lineSize[4] = {0};
+            if (av_image_alloc(data, lineSize, FFMAX(w >> shift, 1), FFMAX(h >> shift, 1), AV_PIX_FMT_YUV420P, 16) >= 0) {
+                bool converted = pixDownscaleYuv420p(src, shift, data, lineSize);
+                if (converted != aligned) {
+                    fprintf(stderr, "yuv420p downscale %d %dx%d: converted %d\n", shift, w, h, converted);
+                    fails ++;
+                } else if (converted) {
+                    fails += compareWithSws("yuv420p downscale", src, w >> shift, h >> shift, SWS_AREA, data, lineSize);
+                }
+                av_freep(&data[0]);
+            } else {
+                fails ++;
+            }
+            av_frame_free(&src);
+        }
+    }
+    // Aligned sizes, odd sizes above are only checked for rejection.
+    for (int shift = 1; shift <= 3; shift ++) {
+        auto src = allocTestFrame(AV_PIX_FMT_YUV420P, 1920, 1088, rand);
+        uint8_t *data[4] = {nullptr};
+        int lineSize[4] = {0};
+        if (src == nullptr || av_image_alloc(data, lineSize, 1920 >> shift, 1088 >> shift, AV_PIX_FMT_YUV420P, 16) < 0 ||
+            !pixDownscaleYuv420p(src, shift, data, lineSize)) {
+            fprintf(stderr, "yuv420p downscale %d 1920x1088 fail\n", shift);
+            fails ++;
+        } else {
+            fails += compareWithSws("yuv420p downscale", src, 1920 >> shift, 1088 >> shift, SWS_AREA, data, lineSize);
+        }
+        av_freep(&data[0]);
+        av_frame_free(&src);
+    }
+    printf("pixcheck: yuv420p downscale checked\n");
+    return fails;
+}
+// endregion
+
+int benchPixCheck(int argc, char **argv) {
+    tMediaBenchArgs args;
+    args.parse(argc, argv);
+    std::mt19937 rand((uint32_t) args.optionInt("seed", 1));
+    int fails = checkKernels(rand);
+    fails += checkConversions(rand);
+    printf("pixcheck: %s, %d fails\n", fails == 0 ? "passed" : "failed", fails);
+    return fails == 0 ? 0 : 1;
+}
+
+// region Benchmark
+typedef void (*tMediaBenchPixKernelRun)(const tMediaPixConvertKernels *k, tMediaBenchPixRows *rows, int width);
+
+typedef struct tMediaBenchPixKernel {
+    const char *name;
+    tMediaBenchPixKernelRun run;
+} tMediaBenchPixKernel;
+
+static const tMediaBenchPixKernel benchKernels[] = {
+        {"u16ToU8", [](const tMediaPixConvertKernels *k, tMediaBenchPixRows *rows, int width) {
+            k->u16ToU8(rows->srcU16, rows->actual[0], width, 2);
+        }},
+        {"deinterleaveU16ToU8", [](const tMediaPixConvertKernels *k, tMediaBenchPixRows *rows, int width) {
+            k->deinterleaveU16ToU8(rows->srcU16, rows->actual[0], rows->actual[1], width / 2, 8);
+        }},
+        {"fullToLimitedLuma", [](const tMediaPixConvertKernels *k, tMediaBenchPixRows *rows, int width) {
+            k->fullToLimitedLuma(rows->a, rows->actual[0], width);
+        }},
+        {"fullToLimitedChroma", [](const tMediaPixConvertKernels *k, tMediaBenchPixRows *rows, int width) {
+            k->fullToLimitedChroma(rows->a, rows->actual[0], width);
+        }},
+        {"averageRows", [](const tMediaPixConvertKernels *k, tMediaBenchPixRows *rows, int width) {
+            k->averageRows(rows->a, rows->b, rows->actual[0], width);
+        }},
+        {"boxDownscale2x", [](const tMediaPixConvertKernels *k, tMediaBenchPixRows *rows, int width) {
+            k->boxDownscale2x(rows->a, rows->b, rows->actual[0], width / 2);
+        }},
+};
+
+static int64_t timeFrameConversion(AVFrame *src, uint8_t *data[4], const int lineSize[4], int iterations, SwsContext *sws) {
+    int64_t start = benchNowMicros();
+    for (int i = 0; i < iterations; i ++) {
+        if (sws != nullptr) {
+            sws_scale(sws, src->data, src->linesize, 0, src->height, data, lineSize);
+        } else {
+            pixConvertToYuv420p(src, data, lineSize, src->width, src->height);
+        }
+    }
+    return (benchNowMicros() - start) / iterations;
+}
+
+int benchPix(int argc, char **argv) {
+    tMediaBenchArgs args;
+    args.parse(argc, argv);
+    int width = (int) FFMIN(args.optionInt("width", 3840), (int64_t) BENCH_PIX_MAX_WIDTH);
+    int height = (int) args.optionInt("height", 2160);
+    int iterations = (int) FFMAX(args.optionInt("iterations", 20), (int64_t) 1);
+    std::mt19937 rand(1);
+    auto rows = new tMediaBenchPixRows;
+    fillRandom((uint8_t *) rows->srcU16, sizeof(rows->srcU16), rand);
+    fillRandom(rows->a, sizeof(rows->a), rand);
+    fillRandom(rows->b, sizeof(rows->b), rand);
+
+    // Kernels: a frame worth of rows per iteration, output pixels per second.
+    printf("kernel,level,width,nsPerRow,mpixPerSec,speedup\n");
+    for (auto &kernel : benchKernels) {
+        double scalarNs = 0.0;
+        for (auto level : {PixConvertScalar, PixConvertNeon, PixConvertSse2, PixConvertAvx2}) {
+            auto k = getPixConvertKernelsOfLevel(level);
+            if (k == nullptr) {
+                continue;
+            }
+            int64_t rowsCount = (int64_t) height * iterations;
+            int64_t start = benchNowMicros();
+            for (int64_t r = 0; r < rowsCount; r ++) {
+                kernel.run(k, rows, width);
+            }
+            double ns = (double) (benchNowMicros() - start) * 1000.0 / (double) rowsCount;
+            if (level == PixConvertScalar) {
+                scalarNs = ns;
+            }
+            printf("%s,%s,%d,%.1f,%.1f,%.2f\n", kernel.name, levelName(level), width, ns,
+                   (double) width * 1000.0 / FFMAX(ns, 0.001), scalarNs / FFMAX(ns, 0.001));
+        }
+    }
+    delete rows;
+
+    // Whole frame conversions with best kernels against swscale.
+    printf("format,size,kernelsUs,swsUs,speedup\n");
+    for (auto format : convertFormats) {
+        auto src = allocTestFrame(format, width, height, rand);
+        uint8_t *data[4] = {nullptr};
+        int lineSize[4] = {0};
+        if (src == nullptr || av_image_alloc(data, lineSize, width, height, AV_PIX_FMT_YUV420P, 16) < 0) {
+            av_frame_free(&src);
+            continue;
+        }
+        auto sws = sws_getContext(width, height, format, width, height, AV_PIX_FMT_YUV420P, SWS_BICUBIC, nullptr, nullptr, nullptr);
+        int64_t kernelsUs = timeFrameConversion(src, data, lineSize, iterations, nullptr);
+        int64_t swsUs = sws != nullptr ? timeFrameConversion(src, data, lineSize, iterations, sws) : -1;
+        printf("%s,%dx%d,%lld,%lld,%.2f\n", av_get_pix_fmt_name(format), width, height,
+               (long long) kernelsUs, (long long) swsUs, (double) swsUs / (double) FFMAX(kernelsUs, (int64_t) 1));
+        sws_freeContext(sws);
+        av_freep(&data[0]);
+        av_frame_free(&src);
+    }
+    return 0;
+}
+// endregion
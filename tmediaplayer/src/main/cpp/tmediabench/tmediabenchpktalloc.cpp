@@ -0,0 +1,51 @@
+//
+// Created by pengcheng.tan on 2024/8/30.
+//
+#include "tmediabench.h"
+
+// Stop demux after continuous read fails.
+#define BENCH_PKT_ALLOC_MAX_READ_FAILS 16
+
+int benchPktAlloc(int argc, char **argv) {
+    tMediaBenchArgs args;
+    args.parse(argc, argv);
+    if (args.positional.empty()) {
+        fprintf(stderr, "No input files.\n");
+        return 1;
+    }
+    auto mode = (tMediaIOMode) args.optionInt("io", IODefault);
+    printf("file,mode,durationSec,packets,payloadAllocs,allocsPerSec,payloadMB,largePayloads,maxPayloadKB,demuxMs\n");
+    for (auto file : args.positional) {
+        auto player = benchPreparePlayer(file, false, mode, IO_READ_AHEAD_DEFAULT_BUFFER_SIZE, DecodeThreadAuto, 0);
+        if (player == nullptr) {
+            fprintf(stderr, "Prepare %s fail.\n", file);
+            continue;
+        }
+        int fails = 0;
+        int64_t start = benchNowMicros();
+        while (fails < BENCH_PKT_ALLOC_MAX_READ_FAILS) {
+            auto result = player->readPacket();
+            if (result == ReadEof) {
+                break;
+            }
+            if (result == ReadFail) {
+                fails ++;
+                continue;
+            }
+            fails = 0;
+            av_packet_unref(player->pkt);
+        }
+        int64_t demuxTime = benchNowMicros() - start;
+        int64_t stats[PKT_ALLOC_STATS_SIZE];
+        player->pkt_alloc_stats.writeStats(stats);
+        double durationSec = (double) player->duration / 1000.0;
+        printf("%s,%s,%.1f,%lld,%lld,%.1f,%.1f,%lld,%.1f,%.1f\n",
+               file, benchIOModeName(mode), durationSec,
+               (long long) stats[0], (long long) stats[1],
+               durationSec > 0.0 ? (double) stats[1] / durationSec : 0.0,
+               (double) stats[2] / 1024.0 / 1024.0, (long long) stats[3], (double) stats[4] / 1024.0,
+               (double) demuxTime / 1000.0);
+        benchReleasePlayer(player);
+    }
+    return 0;
+}
@@ -0,0 +1,106 @@
+//
+// Created by pengcheng.tan on 2024/8/30.
+//
+#include <mutex>
+#include <thread>
+#include "tmediabench.h"
+
+// Stop a player after continuous read fails.
+#define BENCH_STRESS_MAX_READ_FAILS 16
+
+typedef struct tMediaBenchStressResult {
+    std::mutex lock;
+    std::vector<int64_t> prepareTimes;
+    int64_t prepareFails = 0;
+    int64_t decodedFrames = 0;
+    int64_t convertFails = 0;
+} tMediaBenchStressResult;
+
+/**
+ * Prepare, decode frames to buffer and release, like a player of an autoplaying tile.
+ */
+static void runPlayer(const char *file, int64_t maxFrames, tMediaVideoBuffer *buffer, tMediaBenchStressResult *result) {
+    int64_t start = benchNowMicros();
+    auto player = benchPreparePlayer(file, false, IODefault, IO_READ_AHEAD_DEFAULT_BUFFER_SIZE, DecodeThreadAuto, 0);
+    int64_t prepareTime = benchNowMicros() - start;
+    if (player == nullptr) {
+        std::lock_guard<std::mutex> guard(result->lock);
+        result->prepareFails ++;
+        return;
+    }
+    int64_t frames = 0;
+    int64_t convertFails = 0;
+    int fails = 0;
+    bool hasVideo = player->video_stream != nullptr && !player->videoIsAttachPic;
+    while (hasVideo && fails < BENCH_STRESS_MAX_READ_FAILS && frames < maxFrames) {
+        auto readResult = player->readPacket();
+        if (readResult == ReadEof) {
+            break;
+        }
+        if (readResult == ReadFail) {
+            fails ++;
+            continue;
+        }
+        fails = 0;
+        if (readResult != ReadVideoSuccess) {
+            av_packet_unref(player->pkt);
+            continue;
+        }
+        auto decodeResult = player->decodeVideo(player->pkt);
+        while (decodeResult == DecodeSuccess || decodeResult == DecodeSuccessAndSkipNextPkt) {
+            if (player->moveDecodedVideoFrameToBuffer(buffer) == OptSuccess) {
+                frames ++;
+            } else {
+                convertFails ++;
+            }
+            if (decodeResult == DecodeSuccess) {
+                break;
+            }
+            decodeResult = player->decodeVideo(nullptr);
+        }
+    }
+    buffer->unrefFrame();
+    benchReleasePlayer(player);
+    std::lock_guard<std::mutex> guard(result->lock);
+    result->prepareTimes.push_back(prepareTime);
+    result->decodedFrames += frames;
+    result->convertFails += convertFails;
+}
+
+int benchStress(int argc, char **argv) {
+    tMediaBenchArgs args;
+    args.parse(argc, argv);
+    if (args.positional.empty()) {
+        fprintf(stderr, "No input files.\n");
+        return 1;
+    }
+    int players = (int) FFMAX(args.optionInt("players", 32), (int64_t) 1);
+    int rounds = (int) FFMAX(args.optionInt("rounds", 4), (int64_t) 1);
+    int64_t maxFrames = args.optionInt("frames", 30);
+    tMediaBenchStressResult result;
+    std::vector<std::thread> threads;
+    int64_t start = benchNowMicros();
+    for (int i = 0; i < players; i ++) {
+        threads.emplace_back([&, i] {
+            auto buffer = new tMediaVideoBuffer;
+            for (int r = 0; r < rounds; r ++) {
+                // Players play different files at the same time.
+                auto file = args.positional[(size_t) (i + r) % args.positional.size()];
+                runPlayer(file, maxFrames, buffer, &result);
+            }
+            buffer->release();
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    int64_t totalTime = benchNowMicros() - start;
+    auto &times = result.prepareTimes;
+    printf("players,rounds,prepared,prepareFails,convertFails,frames,totalMs,prepareP50Ms,prepareP90Ms,prepareP99Ms,prepareMaxMs\n");
+    printf("%d,%d,%lld,%lld,%lld,%lld,%.1f,%.1f,%.1f,%.1f,%.1f\n",
+           players, rounds, (long long) times.size(), (long long) result.prepareFails, (long long) result.convertFails,
+           (long long) result.decodedFrames, (double) totalTime / 1000.0,
+           (double) benchPercentile(times, 50) / 1000.0, (double) benchPercentile(times, 90) / 1000.0,
+           (double) benchPercentile(times, 99) / 1000.0, (double) benchPercentile(times, 100) / 1000.0);
+    return result.prepareFails == 0 && result.convertFails == 0 ? 0 : 1;
+}
@@ -0,0 +1,101 @@
+//
+// Created by pengcheng.tan on 2024/8/30.
+//
+#include "tmediabench.h"
+
+extern "C" {
+#include "libavutil/imgutils.h"
+}
+
+typedef struct tMediaBenchSwsCase {
+    AVPixelFormat srcFormat;
+    // Output size is src size >> downscaleShift.
+    int downscaleShift;
+    int swsFlags;
+} tMediaBenchSwsCase;
+
+// Conversions done by sws in player: formats without simd kernels, and downscale of non yuv420p frames.
+static const tMediaBenchSwsCase swsCases[] = {
+        {AV_PIX_FMT_YUV444P, 0, SWS_BICUBIC},
+        {AV_PIX_FMT_YUV422P10LE, 0, SWS_BICUBIC},
+        {AV_PIX_FMT_BGR24, 0, SWS_BICUBIC},
+        {AV_PIX_FMT_YUV420P10LE, 1, SWS_AREA},
+};
+
+/**
+ * Average convert cost of one thread count, -1 if fail.
+ */
+static int64_t runSliced(AVFrame *src, const tMediaBenchSwsCase &c, int threadCount, int iterations, int *appliedCount) {
+    int dstW = src->width >> c.downscaleShift;
+    int dstH = src->height >> c.downscaleShift;
+    uint8_t *data[4] = {nullptr};
+    int lineSize[4] = {0};
+    if (av_image_alloc(data, lineSize, dstW, dstH, AV_PIX_FMT_YUV420P, 16) < 0) {
+        return -1;
+    }
+    tMediaSlicedSws sws;
+    sws.setThreadCount(threadCount);
+    int64_t cost = -1;
+    if (sws.ensureContext(src, dstW, dstH, AV_PIX_FMT_YUV420P, c.swsFlags)) {
+        // Warm up, first conversion inits sws's filters and threads.
+        sws.scale(src, data, lineSize);
+        int64_t start = benchNowMicros();
+        int i = 0;
+        for (; i < iterations; i ++) {
+            if (sws.scale(src, data, lineSize) < 0) {
+                break;
+            }
+        }
+        if (i == iterations) {
+            cost = (benchNowMicros() - start) / iterations;
+        }
+        *appliedCount = sws.appliedCount;
+    }
+    sws.freeContext();
+    av_freep(&data[0]);
+    return cost;
+}
+
+int benchSws(int argc, char **argv) {
+    tMediaBenchArgs args;
+    args.parse(argc, argv);
+    int width = (int) args.optionInt("width", 3840);
+    int height = (int) args.optionInt("height", 2160);
+    int iterations = (int) FFMAX(args.optionInt("iterations", 30), (int64_t) 1);
+    int maxThreads = (int) FFMIN(FFMAX(args.optionInt("max-threads", SWS_SLICE_MAX_THREAD_COUNT), (int64_t) 1), (int64_t) SWS_SLICE_MAX_THREAD_COUNT);
+    // requestThreads 0 is auto count, speedup is against 1 thread.
+    printf("srcFormat,srcSize,dstSize,requestThreads,appliedThreads,convertUs,speedup\n");
+    for (auto &c : swsCases) {
+        auto src = av_frame_alloc();
+        src->format = c.srcFormat;
+        src->width = width;
+        src->height = height;
+        if (av_frame_get_buffer(src, 0) < 0) {
+            av_frame_free(&src);
+            continue;
+        }
+        for (int p = 0; p < 4 && src->buf[p] != nullptr; p ++) {
+            memset(src->buf[p]->data, 0x40 + p * 0x20, src->buf[p]->size);
+        }
+        // 1 thread first as speedup base, auto count last.
+        std::vector<int> threadCounts;
+        for (int threads = 1; threads <= maxThreads; threads ++) {
+            threadCounts.push_back(threads);
+        }
+        threadCounts.push_back(0);
+        int64_t singleCost = -1;
+        for (int threads : threadCounts) {
+            int applied = 0;
+            int64_t cost = runSliced(src, c, threads, iterations, &applied);
+            if (threads == 1) {
+                singleCost = cost;
+            }
+            printf("%s,%dx%d,%dx%d,%d,%d,%lld,%.2f\n",
+                   av_get_pix_fmt_name(c.srcFormat), width, height, width >> c.downscaleShift, height >> c.downscaleShift,
+                   threads, applied, (long long) cost,
+                   singleCost > 0 && cost > 0 ? (double) singleCost / (double) cost : 0.0);
+        }
+        av_frame_free(&src);
+    }
+    return 0;
+}
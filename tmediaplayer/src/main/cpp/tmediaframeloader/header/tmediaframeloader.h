@@ -23,6 +23,8 @@ typedef struct tMediaFrameLoaderContext {
     AVFrame *frame = nullptr;
     bool skipPktRead = false;
     long duration = 0;
+    // Bound blocking io of a slow source.
+    tMediaInterruptContext interrupt;
 
     /**
      * Java
@@ -34,7 +36,8 @@ typedef struct tMediaFrameLoaderContext {
      */
     AVStream *video_stream = nullptr;
     const AVCodec *video_decoder = nullptr;
-    SwsContext * sws_ctx = nullptr;
+    // Convert to RGBA, large frames are converted by slice threads.
+    tMediaSlicedSws sws;
     int video_width = 0;
     int video_height = 0;
     AVCodecContext *video_decoder_ctx = nullptr;
@@ -36,6 +36,16 @@ Java_com_tans_tmediaplayer_frameloader_tMediaFrameLoader_prepareNative(
     return loader->prepare(file_path_chars);
 }
 
+extern "C" JNIEXPORT void JNICALL
+Java_com_tans_tmediaplayer_frameloader_tMediaFrameLoader_setTimeoutNative(
+        JNIEnv * env,
+        jobject j_frame_loader,
+        jlong native_loader,
+        jlong timeout_in_millis) {
+    auto *loader = reinterpret_cast<tMediaFrameLoaderContext*>(native_loader);
+    loader->interrupt.setTimeout(timeout_in_millis);
+}
+
 extern "C" JNIEXPORT jint JNICALL
 Java_com_tans_tmediaplayer_frameloader_tMediaFrameLoader_getFrameNative(
         JNIEnv * env,
@@ -8,19 +8,22 @@ tMediaOptResult tMediaFrameLoaderContext::prepare(const char *media_file_p) {
     LOGD("Prepare media file: %s", media_file_p);
     this->media_file = media_file_p;
     this->format_ctx = avformat_alloc_context();
-    int result = avformat_open_input(&format_ctx, media_file, nullptr, nullptr);
+    interrupt.attach(format_ctx);
+    interrupt.beginOp(BlockingOpOpenInput);
+    int result = interrupt.endOp(avformat_open_input(&format_ctx, media_file, nullptr, nullptr));
     if (result < 0) {
         LOGE("Avformat open file fail: %d", result);
         return OptFail;
     }
-    result = avformat_find_stream_info(format_ctx, nullptr);
+    interrupt.beginOp(BlockingOpFindStreamInfo);
+    result = interrupt.endOp(findStreamInfoWithCache(format_ctx, media_file));
     if (result < 0) {
         LOGE("Avformat find stream info fail: %d", result);
         return OptFail;
     }
 
     // Find out first video stream.
-    for (int i = 0; i < format_ctx->nb_streams; i ++) {
+    for (unsigned int i = 0; i < format_ctx->nb_streams; i ++) {
         auto s = format_ctx->streams[i];
         auto codec_type = s->codecpar->codec_type;
         switch (codec_type) {
@@ -92,7 +95,8 @@ tMediaOptResult tMediaFrameLoaderContext::getFrame(long framePosition) {
                 fixedPosition = 0L;
             }
             int64_t seekTs = fixedPosition * AV_TIME_BASE / 1000L;
-            int result = avformat_seek_file(format_ctx, -1, INT64_MIN, seekTs, INT64_MAX, AVSEEK_FLAG_BACKWARD);
+            interrupt.beginOp(BlockingOpSeek);
+            int result = interrupt.endOp(avformat_seek_file(format_ctx, -1, INT64_MIN, seekTs, INT64_MAX, AVSEEK_FLAG_BACKWARD));
             if (result < 0) {
                 LOGE("Seek file fail: %d", result);
                 return OptFail;
@@ -114,7 +118,8 @@ tMediaOptResult tMediaFrameLoaderContext::decodeForGetFrame() {
         if (!skipPktRead) {
             // If need read data to pkt from file.
             av_packet_unref(pkt);
-            result = av_read_frame(format_ctx, pkt);
+            interrupt.beginOp(BlockingOpReadFrame);
+            result = interrupt.endOp(av_read_frame(format_ctx, pkt));
             if (result < 0) {
                 // No data to read, end of file.
                 LOGE("Seek decode media end");
@@ -163,31 +168,12 @@ tMediaOptResult tMediaFrameLoaderContext::parseDecodeVideoFrameToBuffer() {
     int w = frame->width;
     int h = frame->height;
 
-    if (w != video_width ||
-        h != video_height ||
-        sws_ctx == nullptr) {
-        if (sws_ctx != nullptr) {
-            sws_freeContext(sws_ctx);
-        }
-
-        this->sws_ctx = sws_getContext(
-                w,
-                h,
-                (AVPixelFormat) frame->format,
-                w,
-                h,
-                AV_PIX_FMT_RGBA,
-                SWS_BICUBIC,
-                nullptr,
-                nullptr,
-                nullptr);
-        if (sws_ctx == nullptr) {
-            LOGE("Decode video fail, sws ctx create fail.");
-            return OptFail;
-        }
-        video_width = w;
-        video_height = h;
+    if (!sws.ensureContext(frame, w, h, AV_PIX_FMT_RGBA, SWS_BICUBIC)) {
+        LOGE("Decode video fail, sws ctx create fail.");
+        return OptFail;
     }
+    video_width = w;
+    video_height = h;
 
     videoBuffer->width = w;
     videoBuffer->height = h;
@@ -207,7 +193,7 @@ tMediaOptResult tMediaFrameLoaderContext::parseDecodeVideoFrameToBuffer() {
     uint8_t* data[AV_NUM_DATA_POINTERS] = {videoBuffer->rgbaBuffer};
     int lineSize[AV_NUM_DATA_POINTERS];
     av_image_fill_linesizes(lineSize, AV_PIX_FMT_RGBA, videoBuffer->width);
-    int result = sws_scale(sws_ctx, frame->data, frame->linesize, 0, frame->height, data, lineSize);
+    int result = sws.scale(frame, data, lineSize);
     if (result < 0) {
         // Convert fail.
         LOGE("Decode video sws scale fail: %d", result);
@@ -234,9 +220,7 @@ void tMediaFrameLoaderContext::release() {
     if (video_decoder_ctx != nullptr) {
         avcodec_free_context(&video_decoder_ctx);
     }
-    if (sws_ctx != nullptr) {
-        sws_freeContext(sws_ctx);
-    }
+    sws.freeContext();
 
     // VideoBuffer
     if (videoBuffer != nullptr) {
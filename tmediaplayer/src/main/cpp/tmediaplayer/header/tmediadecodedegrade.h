@@ -0,0 +1,78 @@
+//
+// Created by pengcheng.tan on 2024/8/23.
+//
+
+#ifndef TMEDIAPLAYER_TMEDIADECODEDEGRADE_H
+#define TMEDIAPLAYER_TMEDIADECODEDEGRADE_H
+
+#include <atomic>
+
+extern "C" {
+#include "libavcodec/avcodec.h"
+}
+
+/**
+ * Degradation levels, every level keep previous level's skips:
+ * 0: none
+ * 1: skip_loop_filter NONREF
+ * 2: skip_loop_filter ALL, skip_idct NONREF
+ * 3: skip_frame NONREF
+ * 4: skip_frame NONKEY
+ */
+#define DEGRADE_LEVEL_COUNT 5
+
+// Decoded frame later than master clock, ms.
+#define DEGRADE_ESCALATE_LAG_IN_MILLIS 80
+// Continuous late frames to escalate.
+#define DEGRADE_ESCALATE_LATE_FRAMES 3
+// Decoded frame earlier than this lag, ms.
+#define DEGRADE_RECOVER_LAG_IN_MILLIS 20
+// Keep caught up so long to back off one level, ms.
+#define DEGRADE_RECOVER_HOLD_IN_MILLIS 1000
+// Min interval of two escalations, give decoder time to take effect, ms.
+#define DEGRADE_ESCALATE_INTERVAL_IN_MILLIS 300
+
+/**
+ * Stats array layout for Java: [currentLevel, levelChanges, timeAtLevel0(ms), ..., timeAtLevel4(ms)]
+ */
+#define DEGRADE_STATS_SIZE (2 + DEGRADE_LEVEL_COUNT)
+
+/**
+ * Video decode load shedding, when decoded frames are late than master clock, skip decode work of frames which can't
+ * be showed in time. Only changed by video decoder thread, MediaCodec decoders ignore skip flags.
+ */
+typedef struct tMediaDecodeDegrader {
+    std::atomic<int> level {0};
+    // Skip flags of level are not applied to decoder ctx.
+    bool dirty = false;
+    int lateFrames = 0;
+    int64_t lastEscalateTime = 0;
+    // 0 means not caught up.
+    int64_t caughtUpSince = 0;
+    std::atomic<int64_t> levelEnterTime {0};
+
+    /**
+     * Stats
+     */
+    std::atomic<int64_t> levelChanges {0};
+    std::atomic<int64_t> timeAtLevel[DEGRADE_LEVEL_COUNT] = {};
+
+    /**
+     * Call before send packet to decoder.
+     */
+    void applyTo(AVCodecContext *ctx);
+
+    /**
+     * Decoded frame pts and master clock in ms, negative master clock means unknown.
+     */
+    void onFrameDecoded(int64_t framePtsInMillis, int64_t masterClockInMillis);
+
+    /**
+     * Seek or decoder reopen, back to level 0.
+     */
+    void reset();
+
+    void writeStats(int64_t *target);
+} tMediaDecodeDegrader;
+
+#endif //TMEDIAPLAYER_TMEDIADECODEDEGRADE_H
@@ -0,0 +1,78 @@
+//
+// Created by pengcheng.tan on 2024/8/23.
+//
+
+#ifndef TMEDIAPLAYER_TMEDIADECODETHREADS_H
+#define TMEDIAPLAYER_TMEDIADECODETHREADS_H
+
+#include <atomic>
+
+extern "C" {
+#include "libavcodec/avcodec.h"
+}
+
+enum tMediaDecodeThreadType {
+    DecodeThreadAuto,
+    DecodeThreadFrame,
+    DecodeThreadSlice
+};
+
+// FFmpeg's max auto thread count.
+#define DECODE_MAX_THREAD_COUNT 16
+
+// Auto mode measure decode cost of first frames, and retune thread count once.
+#define DECODE_RETUNE_WINDOW_FRAMES 60
+
+/**
+ * Stats array layout for Java: [threadType(-1 is single thread), threadCount, decodedFrames, avgDecodeCost(us),
+ * maxDecodeCost(us), retuneCount]
+ */
+#define DECODE_THREADS_STATS_SIZE 6
+
+/**
+ * Software video decoder threading policy.
+ * Frame threading decode several frames in parallel, it has best throughput but add (threadCount - 1) frames latency,
+ * slice threading decode slices of one frame in parallel, it depends on encoder produce multi slices.
+ * Auto mode choose thread type by codec capabilities and thread count by resolution and cpu cores, and increase thread count
+ * if measured decode cost can't keep up with frame rate.
+ */
+typedef struct tMediaDecodeThreadPolicy {
+    tMediaDecodeThreadType requestType = DecodeThreadAuto;
+    // 0 means auto.
+    int requestCount = 0;
+
+    /**
+     * Applied to decoder ctx.
+     */
+    std::atomic<int> appliedType {-1};
+    std::atomic<int> appliedCount {1};
+
+    /**
+     * Decode cost, only changed by decoder thread.
+     */
+    std::atomic<int64_t> decodedFrames {0};
+    std::atomic<int64_t> decodeCostSum {0};
+    std::atomic<int64_t> maxDecodeCost {0};
+    std::atomic<int64_t> retuneCount {0};
+    bool retuneChecked = false;
+    // Thread count of reopened decoder, 0 means no retune pending.
+    int retuneThreadCount = 0;
+
+    void setRequest(tMediaDecodeThreadType type, int count);
+
+    /**
+     * Call before avcodec_open2(), threadCount 0 means compute by policy.
+     */
+    void configure(AVCodecContext *ctx, const AVCodec *codec, bool isAttachPic, int threadCount);
+
+    /**
+     * Record decode cost of a frame, return true if decoder need reopen with retuneThreadCount.
+     */
+    bool onFrameDecoded(int64_t costInMicros, double fps);
+
+    void resetCost();
+
+    void writeStats(int64_t *target);
+} tMediaDecodeThreadPolicy;
+
+#endif //TMEDIAPLAYER_TMEDIADECODETHREADS_H
@@ -0,0 +1,117 @@
+//
+// Created by pengcheng.tan on 2024/8/29.
+//
+
+#ifndef TMEDIAPLAYER_TMEDIAFRAMESTEP_H
+#define TMEDIAPLAYER_TMEDIAFRAMESTEP_H
+
+#include <atomic>
+
+extern "C" {
+#include "libavcodec/avcodec.h"
+}
+
+// Memory of recently delivered frames kept for backward steps.
+#define FRAME_STEP_DEFAULT_CACHE_SIZE (32 * 1024 * 1024)
+// Frames in java frame queue are cached too, keep larger than queue size.
+#define FRAME_STEP_MAX_CACHED_FRAMES 32
+
+/**
+ * Stats array layout for Java: [cachedFrames, cachedBytes, cacheHits, cacheMisses, redecodedFrames, replayedFrames]
+ */
+#define FRAME_STEP_STATS_SIZE 6
+
+typedef struct tMediaFrameStepStats {
+    std::atomic<int64_t> cachedFrames {0};
+    std::atomic<int64_t> cachedBytes {0};
+    std::atomic<int64_t> cacheHits {0};
+    std::atomic<int64_t> cacheMisses {0};
+    // Frames decoded from key frame for missed backward steps.
+    std::atomic<int64_t> redecodedFrames {0};
+    std::atomic<int64_t> replayedFrames {0};
+} tMediaFrameStepStats;
+
+/**
+ * Ring of frames recently delivered by video decoder in output order, only accessed by video decoder thread.
+ * Live frames are cached only while enabled (player paused or stepping), normal playback doesn't pin frames.
+ * A backward step hit replays cached frames from the frame before the showing one, java frame queue is flushed and
+ * refilled by replayed frames, live decoder is not touched and continues after replay.
+ * A miss seeks to the key frame before the showing frame, frames before it are decoded into ring without delivering.
+ */
+typedef struct tMediaFrameStepCache {
+    AVFrame *frames[FRAME_STEP_MAX_CACHED_FRAMES] = {nullptr};
+    int64_t frameBytes[FRAME_STEP_MAX_CACHED_FRAMES] = {0};
+    // Oldest frame index.
+    int head = 0;
+    int count = 0;
+    int64_t bytes = 0;
+    int64_t maxBytes = FRAME_STEP_DEFAULT_CACHE_SIZE;
+    // Set by Java, cached frames are dropped by decoder thread after disabled.
+    std::atomic<bool> enabled {false};
+    // Ring position (0 is oldest) of next frame to replay, -1 means not replaying.
+    int replayPos = -1;
+    // Live decoder reached eof, replay ends with eof.
+    bool liveEof = false;
+
+    /**
+     * Pts in stream time base of last key frame delivered by live decoder, backward steps out of cache
+     * decode from it.
+     */
+    int64_t lastKeyPts = AV_NOPTS_VALUE;
+
+    /**
+     * Set before seek of a missed backward step, armed by first packet of new serial.
+     */
+    int64_t pendingRedecodeUntilPts = AV_NOPTS_VALUE;
+    // Frames before it are cached but not delivered, then replay from the newest one before it.
+    int64_t redecodeUntilPts = AV_NOPTS_VALUE;
+
+    tMediaFrameStepStats stats;
+
+    /**
+     * Ref frame to ring, oldest frames are dropped when frames count or bytes over limit.
+     */
+    void push(AVFrame *src);
+
+    /**
+     * Frame delivered by live decoder, cached only if enabled, key frame is always tracked.
+     */
+    void onLiveFrame(AVFrame *src);
+
+    /**
+     * Drop cached frames if disabled and no backward step is in progress.
+     */
+    void trimIfDisabled();
+
+    /**
+     * Replay from newest cached frame with pts before beforePts, return false if no such frame.
+     */
+    bool beginReplay(int64_t beforePts);
+
+    bool isReplaying() const;
+
+    /**
+     * Ref next replay frame to target, return false when replay done.
+     */
+    bool popReplay(AVFrame *target);
+
+    bool isRedecoding() const;
+
+    /**
+     * Handle a frame decoded after missed backward step's seek, return true if replay begins.
+     */
+    bool onRedecodedFrame(AVFrame *src);
+
+    /**
+     * Serial changed, cached frames are from old position. Arms pending re-decode.
+     */
+    void onSerialChanged();
+
+    void clear();
+
+    void dropFrames();
+
+    void writeStats(int64_t *target);
+} tMediaFrameStepCache;
+
+#endif //TMEDIAPLAYER_TMEDIAFRAMESTEP_H
@@ -0,0 +1,86 @@
+//
+// Created by pengcheng.tan on 2024/8/20.
+//
+
+#ifndef TMEDIAPLAYER_TMEDIAINTERRUPT_H
+#define TMEDIAPLAYER_TMEDIAINTERRUPT_H
+
+#include <atomic>
+
+extern "C" {
+#include "libavformat/avformat.h"
+}
+
+enum tMediaBlockingOp {
+    BlockingOpNone,
+    BlockingOpOpenInput,
+    BlockingOpFindStreamInfo,
+    BlockingOpReadFrame,
+    BlockingOpSeek
+};
+
+/**
+ * Stats array layout for Java: [interruptCount, lastInterruptedOp, lastInterruptedCost(us), maxInterruptedCost(us), maxBlockingCost(us)]
+ */
+#define INTERRUPT_STATS_SIZE 5
+
+/**
+ * AVFormatContext::interrupt_callback opaque, FFmpeg check it in every blocking io loop.
+ * abort() is sticky, use for release; cancel() only interrupt blocking calls started before it;
+ * timeout interrupt a blocking call which cost longer than timeoutInMicros.
+ */
+typedef struct tMediaInterruptContext {
+    std::atomic<bool> abortRequest {false};
+    std::atomic<int> cancelGeneration {0};
+    // 0 means no timeout.
+    std::atomic<int64_t> timeoutInMicros {0};
+
+    /**
+     * Current blocking call, only changed by the thread which do the call.
+     */
+    std::atomic<int> currentOp {BlockingOpNone};
+    std::atomic<int> opGeneration {0};
+    std::atomic<int64_t> opStartTime {0};
+    std::atomic<int64_t> opDeadline {0};
+    // Current or last blocking call was interrupted, kept until next beginOp().
+    std::atomic<bool> opInterrupted {false};
+
+    /**
+     * Stats
+     */
+    std::atomic<int64_t> interruptCount {0};
+    std::atomic<int> lastInterruptedOp {BlockingOpNone};
+    std::atomic<int64_t> lastInterruptedCostInMicros {0};
+    std::atomic<int64_t> maxInterruptedCostInMicros {0};
+    std::atomic<int64_t> maxBlockingCostInMicros {0};
+
+    void attach(AVFormatContext *format_ctx);
+
+    void beginOp(tMediaBlockingOp op);
+
+    /**
+     * Record blocking call cost, return ret.
+     */
+    int endOp(int ret);
+
+    bool isInterrupted();
+
+    /**
+     * Last blocking call returned by interrupt, its result is not a real error or eof.
+     */
+    bool isLastOpInterrupted();
+
+    void abort();
+
+    void cancel();
+
+    void setTimeout(int64_t timeoutInMillis);
+
+    void writeStats(int64_t *target);
+
+    void release();
+} tMediaInterruptContext;
+
+int interruptCallback(void *opaque);
+
+#endif //TMEDIAPLAYER_TMEDIAINTERRUPT_H
@@ -0,0 +1,167 @@
+//
+// Created by pengcheng.tan on 2024/8/14.
+//
+
+#ifndef TMEDIAPLAYER_TMEDIAIO_H
+#define TMEDIAPLAYER_TMEDIAIO_H
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "tmediaiouring.h"
+
+extern "C" {
+#include "libavformat/avformat.h"
+}
+
+// AVIOContext buffer size, default file protocol use 32kb.
+#define IO_AVIO_BUFFER_SIZE (256 * 1024)
+// Max size of one pread() call of read ahead thread.
+#define IO_READ_AHEAD_CHUNK_SIZE (512 * 1024)
+#define IO_READ_AHEAD_MIN_BUFFER_SIZE (1024 * 1024)
+#define IO_READ_AHEAD_DEFAULT_BUFFER_SIZE (8 * 1024 * 1024)
+// mmap mode advise kernel to load next window.
+#define IO_MMAP_WILLNEED_WINDOW_SIZE (4 * 1024 * 1024)
+// Async read mode cache file with blocks.
+#define IO_ASYNC_BLOCK_SIZE (256 * 1024)
+#define IO_ASYNC_MIN_BLOCK_COUNT 8
+#define IO_ASYNC_WORKER_COUNT 4
+// Blocks requested after current read block.
+#define IO_ASYNC_PREFETCH_BLOCK_COUNT 4
+// Waiting data check demuxer interrupt callback with this interval.
+#define IO_INTERRUPT_CHECK_INTERVAL_IN_MILLIS 10
+
+enum tMediaIOMode {
+    IODefault,
+    IOMmap,
+    IOReadAhead,
+    IOAsyncRead,
+    IOUringRead
+};
+
+enum tMediaIOBlockState {
+    IOBlockEmpty,
+    IOBlockPending,
+    IOBlockReading,
+    IOBlockReady,
+    IOBlockFail
+};
+
+typedef struct tMediaIOBlock {
+    // File offset is index * IO_ASYNC_BLOCK_SIZE.
+    int64_t index = -1;
+    tMediaIOBlockState state = IOBlockEmpty;
+    int64_t size = 0;
+    uint8_t *data = nullptr;
+    // Pending blocks with smaller value read first, ready blocks with smaller value evicted first.
+    int64_t lastUsed = 0;
+} tMediaIOBlock;
+
+/**
+ * Stats array layout for Java: [bytesRead, readSyscalls, stallTime(us), seekCount]
+ */
+#define IO_STATS_SIZE 4
+
+typedef struct tMediaIOStats {
+    // Bytes returned to demuxer.
+    std::atomic<int64_t> bytesRead {0};
+    // pread() calls of read ahead mode, mmap() and madvise() calls of mmap mode, io_uring_enter() calls of io_uring mode.
+    std::atomic<int64_t> readSyscalls {0};
+    // Time of demuxer waiting for data.
+    std::atomic<int64_t> stallTimeInMicros {0};
+    std::atomic<int64_t> seekCount {0};
+} tMediaIOStats;
+
+/**
+ * Custom AVIOContext for local files.
+ * IOMmap: map whole file, read is memcpy, next window advised with MADV_WILLNEED.
+ * IOReadAhead: a background thread fills a ring buffer with pread(), demuxer only waits when buffer is empty.
+ * IOAsyncRead: a pread() thread pool keeps current block and next blocks reading in parallel, blocks are LRU cached,
+ * so interleaved files which jump between far audio and video chunks don't wait every jump.
+ * IOUringRead: same blocks cache as IOAsyncRead, one thread keeps block reads in flight with io_uring instead of pread()
+ * threads, fallback to IOAsyncRead if io_uring unavailable.
+ */
+typedef struct tMediaIOContext {
+    tMediaIOMode mode = IODefault;
+    int fd = -1;
+    int64_t fileSize = 0;
+    // Demuxer read position.
+    int64_t position = 0;
+
+    AVIOContext *avio_ctx = nullptr;
+    // Demuxer's interrupt callback, read waiting data return AVERROR_EXIT when interrupted.
+    AVIOInterruptCB *interrupt_cb = nullptr;
+
+    /**
+     * Mmap
+     */
+    uint8_t *mappedData = nullptr;
+    int64_t willNeedEnd = 0;
+
+    /**
+     * Read ahead, ring buffer contains file data [windowStart, windowStart + windowSize).
+     */
+    uint8_t *ringBuffer = nullptr;
+    int64_t ringCapacity = 0;
+    int64_t ringHead = 0;
+    int64_t windowStart = 0;
+    int64_t windowSize = 0;
+    // Increased when window moved by seek, stale pread() result is dropped.
+    int windowGeneration = 0;
+    bool readAheadEof = false;
+    bool readAheadError = false;
+    bool stopReadAhead = false;
+    std::thread *readAheadThread = nullptr;
+    std::mutex readAheadLock;
+    std::condition_variable readAheadCond;
+
+    /**
+     * Async read, blocks and workers share readAheadLock and readAheadCond.
+     */
+    tMediaIOBlock *blocks = nullptr;
+    int blockCount = 0;
+    int64_t blockUseCounter = 0;
+    std::thread **asyncWorkers = nullptr;
+    int asyncWorkerCount = 0;
+    // Only accessed by the io_uring thread after prepare.
+    tMediaIOUring *uring = nullptr;
+
+    tMediaIOStats stats;
+
+    /**
+     * Fail if file can't open, mmap fail fallback to read ahead.
+     * readAheadBufferSize is ring buffer size of IOReadAhead and blocks cache size of IOAsyncRead.
+     */
+    bool prepare(const char *file, tMediaIOMode ioMode, int64_t readAheadBufferSize);
+
+    int read(uint8_t *buf, int bufSize);
+
+    int64_t seek(int64_t offset, int whence);
+
+    void readAheadLoop();
+
+    bool isInterrupted();
+
+    /**
+     * Need readAheadLock, return null if all blocks are reading, keep block never evicted.
+     */
+    tMediaIOBlock *requestBlock(int64_t blockIndex, tMediaIOBlock *keep);
+
+    int readAsync(uint8_t *buf, int bufSize);
+
+    void asyncWorkerLoop();
+
+    void uringLoop();
+
+    void writeStats(int64_t *target);
+
+    void release();
+} tMediaIOContext;
+
+/**
+ * Only local file path use custom io.
+ */
+bool isLocalFilePath(const char *file);
+
+#endif //TMEDIAPLAYER_TMEDIAIO_H
@@ -0,0 +1,74 @@
+//
+// Created by pengcheng.tan on 2024/8/30.
+//
+
+#ifndef TMEDIAPLAYER_TMEDIAIOURING_H
+#define TMEDIAPLAYER_TMEDIAIOURING_H
+
+#include <cstdint>
+#include <cstddef>
+
+// Max reads in flight of io_uring async read.
+#define IO_URING_QUEUE_DEPTH 16
+// Retry interval after io_uring_enter fail.
+#define IO_URING_RETRY_INTERVAL_IN_MILLIS 10
+
+/**
+ * Minimal io_uring with raw syscalls (no liburing), only submit reads and reap completions.
+ * Only used by one thread.
+ */
+typedef struct tMediaIOUring {
+    int ringFd = -1;
+    uint32_t sqEntries = 0;
+
+    void *sqRing = nullptr;
+    size_t sqRingSize = 0;
+    uint32_t *sqHead = nullptr;
+    uint32_t *sqTail = nullptr;
+    uint32_t *sqMask = nullptr;
+    uint32_t *sqArray = nullptr;
+    // struct io_uring_sqe array.
+    void *sqes = nullptr;
+    size_t sqesSize = 0;
+
+    void *cqRing = nullptr;
+    size_t cqRingSize = 0;
+    uint32_t *cqHead = nullptr;
+    uint32_t *cqTail = nullptr;
+    uint32_t *cqMask = nullptr;
+    // struct io_uring_cqe array.
+    void *cqes = nullptr;
+
+    // Queued but not submitted to kernel.
+    uint32_t toSubmit = 0;
+
+    /**
+     * Return false if io_uring is unavailable or doesn't support read op.
+     */
+    bool setup(uint32_t entries);
+
+    /**
+     * Queue a read, return false if submission queue is full.
+     */
+    bool queueRead(int fd, uint8_t *buf, uint32_t size, int64_t offset, uint64_t userData);
+
+    /**
+     * Submit queued reads and wait at least minComplete completions, return < 0 if fail.
+     */
+    int submitAndWait(uint32_t minComplete);
+
+    /**
+     * Pop a completion, return false if no completion. res is read size or -errno.
+     */
+    bool popCompletion(uint64_t *userData, int *res);
+
+    void release();
+} tMediaIOUring;
+
+/**
+ * Runtime probe, checked once per process. Android app seccomp policy kills process on io_uring syscalls, always
+ * false on Android.
+ */
+bool isIOUringSupported();
+
+#endif //TMEDIAPLAYER_TMEDIAIOURING_H
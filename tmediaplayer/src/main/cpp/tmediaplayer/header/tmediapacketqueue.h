@@ -0,0 +1,76 @@
+//
+// Created by pengcheng.tan on 2024/8/12.
+//
+
+#ifndef TMEDIAPLAYER_TMEDIAPACKETQUEUE_H
+#define TMEDIAPLAYER_TMEDIAPACKETQUEUE_H
+
+#include <atomic>
+
+extern "C" {
+#include "libavcodec/avcodec.h"
+}
+
+typedef struct tMediaPacketQueueSlot {
+    AVPacket *pkt = nullptr;
+    int serial = 0;
+    bool isEof = false;
+    int size = 0;
+    // millis
+    int64_t duration = 0L;
+    // Size and duration are in queue's counters, removed once by pop() or flush().
+    std::atomic<bool> isCounted {false};
+} tMediaPacketQueueSlot;
+
+enum tMediaPacketQueuePopResult {
+    PopPktSuccess,
+    PopPktEof,
+    PopPktEmpty
+};
+
+/**
+ * Bounded single producer single consumer packet ring buffer.
+ * Producer (packet reader thread): push(), pushEof(), flush().
+ * Consumer (decoder thread): pop().
+ * clear() and release() need producer and consumer both stopped.
+ */
+typedef struct tMediaPacketQueue {
+    uint32_t capacity = 0;
+    uint32_t mask = 0;
+    tMediaPacketQueueSlot *slots = nullptr;
+
+    std::atomic<uint32_t> head {0};
+    std::atomic<uint32_t> tail {0};
+    std::atomic<int> serial {0};
+    std::atomic<int64_t> sizeInBytes {0};
+    std::atomic<int64_t> duration {0};
+
+    bool prepare(uint32_t minCapacity);
+
+    int count();
+
+    bool isFull();
+
+    /**
+     * Move src's ref to queue.
+     */
+    bool push(AVPacket *src, int64_t durationInMillis);
+
+    bool pushEof();
+
+    /**
+     * Increase serial, old serial packets are dropped by pop() and removed from size and duration at once.
+     */
+    void flush();
+
+    /**
+     * Move packet ref to target, skip packets which serial changed.
+     */
+    tMediaPacketQueuePopResult pop(AVPacket *target, int *pktSerial);
+
+    void clear();
+
+    void release();
+} tMediaPacketQueue;
+
+#endif //TMEDIAPLAYER_TMEDIAPACKETQUEUE_H
@@ -0,0 +1,40 @@
+//
+// Created by pengcheng.tan on 2024/8/22.
+//
+
+#ifndef TMEDIAPLAYER_TMEDIAPACKETSTATS_H
+#define TMEDIAPLAYER_TMEDIAPACKETSTATS_H
+
+#include <atomic>
+
+extern "C" {
+#include "libavcodec/avcodec.h"
+}
+
+// Payloads not smaller than it are counted as large, allocators usually serve them with mmap() and free them with munmap().
+#define PKT_STATS_LARGE_PAYLOAD_SIZE (128 * 1024)
+
+/**
+ * Stats array layout for Java: [packets, payloadAllocations, payloadBytes, largePayloads, maxPayloadSize]
+ */
+#define PKT_ALLOC_STATS_SIZE 5
+
+/**
+ * Payload allocation stats of demuxed audio and video packets, only written by packet reader thread.
+ * FFmpeg has no hook for demuxer's payload allocation, payloads are allocated by av_read_frame() and freed when
+ * decoders unref packets, they are counted without copy.
+ */
+typedef struct tMediaPacketAllocStats {
+    std::atomic<int64_t> packets {0};
+    // Payload buffer only referenced by the packet, demuxer allocated it for this packet.
+    std::atomic<int64_t> payloadAllocations {0};
+    std::atomic<int64_t> payloadBytes {0};
+    std::atomic<int64_t> largePayloads {0};
+    std::atomic<int64_t> maxPayloadSize {0};
+
+    void onPacketRead(const AVPacket *pkt);
+
+    void writeStats(int64_t *target);
+} tMediaPacketAllocStats;
+
+#endif //TMEDIAPLAYER_TMEDIAPACKETSTATS_H
@@ -0,0 +1,77 @@
+//
+// Created by pengcheng.tan on 2024/8/24.
+//
+
+#ifndef TMEDIAPLAYER_TMEDIAPIXCONVERT_H
+#define TMEDIAPLAYER_TMEDIAPIXCONVERT_H
+
+#include <cstdint>
+
+extern "C" {
+#include "libavutil/frame.h"
+}
+
+enum tMediaPixConvertLevel {
+    PixConvertScalar,
+    PixConvertNeon,
+    PixConvertSse2,
+    PixConvertAvx2
+};
+
+#define PIX_CONVERT_LEVEL_COUNT 4
+
+/**
+ * Row kernels, chosen by cpu features at first use, all levels produce the same output.
+ */
+typedef struct tMediaPixConvertKernels {
+    tMediaPixConvertLevel level = PixConvertScalar;
+
+    // dst = min((src + (1 << (shift - 1))) >> shift, 255)
+    void (*u16ToU8)(const uint16_t *src, uint8_t *dst, int width, int shift) = nullptr;
+
+    // Interleaved uv u16 pairs to u and v planes, same rounding as u16ToU8, width is pairs count.
+    void (*deinterleaveU16ToU8)(const uint16_t *src, uint8_t *dstU, uint8_t *dstV, int width, int shift) = nullptr;
+
+    // Full range (jpeg) luma to limited range.
+    void (*fullToLimitedLuma)(const uint8_t *src, uint8_t *dst, int width) = nullptr;
+
+    // Full range (jpeg) chroma to limited range.
+    void (*fullToLimitedChroma)(const uint8_t *src, uint8_t *dst, int width) = nullptr;
+
+    // dst = (a + b + 1) >> 1
+    void (*averageRows)(const uint8_t *a, const uint8_t *b, uint8_t *dst, int width) = nullptr;
+
+    // dst = (r0[2x] + r0[2x + 1] + r1[2x] + r1[2x + 1] + 2) >> 2, dst may be r0 for in place downscale.
+    void (*boxDownscale2x)(const uint8_t *r0, const uint8_t *r1, uint8_t *dst, int dstWidth) = nullptr;
+} tMediaPixConvertKernels;
+
+const tMediaPixConvertKernels *getPixConvertKernels();
+
+/**
+ * Kernels of a level for checks and benchmarks, null if level is not built for this abi or not supported by cpu.
+ */
+const tMediaPixConvertKernels *getPixConvertKernelsOfLevel(tMediaPixConvertLevel level);
+
+/**
+ * Same size conversion to yuv420p without swscale, for yuv420p10le, yuvj420p, yuv422p and p010le.
+ * dstWidth/dstHeight are luma size of dst planes, return false if frame's format is not supported.
+ */
+bool pixConvertToYuv420p(const AVFrame *src, uint8_t *dstData[3], const int dstLineSize[3], int dstWidth, int dstHeight);
+
+/**
+ * Yuv420p box filter downscale by 2^shift without swscale, dst planes are (width >> shift) x (height >> shift) luma size,
+ * return false if frame's format or size is not supported.
+ */
+bool pixDownscaleYuv420p(const AVFrame *src, int shift, uint8_t *dstData[3], const int dstLineSize[3]);
+
+/**
+ * Power of 2 downscale of w x h, max maxShift, output keeps larger than target size, 0 if target not limited.
+ */
+int pixDownscaleShift(int w, int h, int targetWidth, int targetHeight, int maxShift);
+
+/**
+ * Size of buffers referenced by frame, memory held by a cached frame.
+ */
+int64_t pixFrameBufferBytes(const AVFrame *f);
+
+#endif //TMEDIAPLAYER_TMEDIAPIXCONVERT_H
@@ -7,6 +7,16 @@
 
 #include <android/log.h>
 #include <jni.h>
+#include "tmediapacketqueue.h"
+#include "tmediaio.h"
+#include "tmediaprobecache.h"
+#include "tmediainterrupt.h"
+#include "tmediapacketstats.h"
+#include "tmediadecodethreads.h"
+#include "tmediadecodedegrade.h"
+#include "tmediaswsslice.h"
+#include "tmediareverse.h"
+#include "tmediaframestep.h"
 
 extern "C" {
 #include "libavformat/avformat.h"
@@ -22,11 +32,26 @@ extern "C" {
 
 #define YUV_ALIGN_SIZE 8
 
+// Max downscale of decoded frames to target output size, 2^3.
+#define VIDEO_DOWNSCALE_MAX_SHIFT 3
+
+// Max packets count of one readPacketsToQueues() call.
+#define READ_PKT_MAX_BATCH_SIZE 64
+
+enum tMediaOptResult {
+    OptSuccess,
+    OptFail
+};
+
 enum ImageRawType {
     Yuv420p,
     Nv12,
     Nv21,
     Rgba,
+    // 16 bits per sample, 10 bits valid in low bits.
+    Yuv420p10,
+    // 16 bits per sample, 10 bits valid in high bits, interleaved UV.
+    P010,
     UnknownImgType
 };
 
@@ -51,6 +76,28 @@ typedef struct tMediaVideoBuffer {
     uint8_t  *uvBuffer = nullptr;
     long pts = 0L;
     long duration = 0L;
+
+    /**
+     * Yuv420p, Nv12, Nv21, Rgba, Yuv420p10 and P010 frames are referenced without copy, planes point to frame's data,
+     * keep the reference until buffer recycled. Other formats converted to owned yuv buffers.
+     */
+    AVFrame *frame = nullptr;
+    bool isFrameRef = false;
+    // Y/U/V, Y/UV or RGBA.
+    uint8_t *planes[3] = {nullptr};
+    int lineSizes[3] = {0};
+    // Real content bytes of each row and rows of each plane, width is aligned but planes are not.
+    int planeRowBytes[3] = {0};
+    int planeRows[3] = {0};
+
+    tMediaOptResult refFrame(AVFrame *src);
+
+    /**
+     * Return decoder's frame buffer, call when buffer is recycled.
+     */
+    void unrefFrame();
+
+    void release();
 } tMediaVideoBuffer;
 
 typedef struct tMediaAudioBuffer {
@@ -67,6 +114,8 @@ enum tMediaDecodeResult {
     DecodeFail,
     DecodeFailAndNeedMorePkt,
     DecodeEnd,
+    DecodeNoPkt,
+    DecodePktEof
 };
 
 enum tMediaReadPktResult {
@@ -79,11 +128,72 @@ enum tMediaReadPktResult {
     UnknownPkt
 };
 
-enum tMediaOptResult {
-    OptSuccess,
-    OptFail
+enum tMediaReadPktsToQueueResult {
+    ReadToQueueContinue,
+    ReadToQueueFull,
+    ReadToQueueAttachment,
+    ReadToQueueSubtitle,
+    ReadToQueueEof,
+    ReadToQueueFail
+};
+
+// Max decode attempts of one decodeVideoToBuffers() / decodeAudioToBuffers() call, let decoder thread handle seek and release.
+#define DECODE_MAX_BATCH_SIZE 64
+
+/**
+ * decodeVideoToBuffers() and decodeAudioToBuffers() write a packed int64 array:
+ * [publishedFrameCount, frame descriptors...]
+ * Video frame descriptor: [pts(ms), duration(ms), serial, imageType, width, height, deliverCost(ns)]
+ * Audio frame descriptor: [pts(ms), duration(ms), serial]
+ */
+#define DECODE_BATCH_HEADER_SIZE 1
+#define VIDEO_FRAME_DESCRIPTOR_SIZE 7
+#define AUDIO_FRAME_DESCRIPTOR_SIZE 3
+
+enum DecodeFrameDescriptorField {
+    FrameDescPts,
+    FrameDescDuration,
+    FrameDescSerial,
+    FrameDescImageType,
+    FrameDescWidth,
+    FrameDescHeight,
+    FrameDescDeliverCost
+};
+
+enum tMediaDecodeToBuffersResult {
+    // Batch limit reached, call again.
+    DecodeToBuffersContinue,
+    // All buffers published.
+    DecodeToBuffersFull,
+    DecodeToBuffersNoPkt,
+    DecodeToBuffersEof
 };
 
+// Trick play speed limits of fast forward and rewind.
+#define TRICK_PLAY_MIN_SPEED 4
+#define TRICK_PLAY_MAX_SPEED 32
+// Wall time between two key frames shown by trick play, ms.
+#define TRICK_PLAY_FRAME_INTERVAL_IN_MILLIS 100
+// Key frames buffered in video packet queue when trick play.
+#define TRICK_PLAY_MAX_QUEUED_KEY_FRAMES 4
+// Rewind seek landed on shown key frame, seek again with double step at most so many times.
+#define TRICK_PLAY_MAX_STEP_SCALE 64
+
+// Min slots count of audio and video packet queue.
+#define PKT_QUEUE_CAPACITY 1024
+
+// Fast start prepare probing limits.
+#define FAST_START_PROBE_SIZE (512 * 1024)
+// us
+#define FAST_START_MAX_ANALYZE_DURATION (500 * 1000)
+
+// Decoded video frame late than master clock more than max(frame duration, this), drop it before conversion, ms.
+#define LATE_FRAME_DROP_MIN_LAG_IN_MILLIS 40
+// Clock too far from frame, not sync.
+#define LATE_FRAME_NOSYNC_IN_MILLIS 10000
+// Keep a frame to render after so many continuous drops.
+#define LATE_FRAME_MAX_CONTINUOUS_DROPS 8
+
 typedef struct Metadata {
     int metadataCount = 0;
     char ** metadata = nullptr;
@@ -94,13 +204,55 @@ typedef struct SubtitleStream {
     Metadata streamMetadata;
 } SubtitleStream;
 
+typedef struct AudioStream {
+    AVStream *stream = nullptr;
+    Metadata streamMetadata;
+} AudioStream;
+
+/**
+ * One context per player, prepare, decode and release of different contexts run concurrently. Shared native state:
+ * - Probe cache and sws context cache, guarded by probeCacheLock (tmediaprobecache.cpp) and swsCacheLock (tmediaswscache.cpp).
+ * - Pixel convert kernels and io_uring support, immutable function statics initialized once (thread safe since C++11).
+ * - FFmpeg's java vm set by av_jni_set_java_vm(), FFmpeg guards it with its own lock and all players set the same vm.
+ * Hardware pixel format negotiation is per context, get_format reads video_hw_pix_fmt through AVCodecContext::opaque.
+ * Hardware decoders need the JVM, tmediabench stress only covers software decoding.
+ */
 typedef struct tMediaPlayerContext {
     const char *media_file = nullptr;
 
     AVFormatContext *format_ctx = nullptr;
+    // Custom io for local file, null when use default file protocol.
+    tMediaIOContext *io_ctx = nullptr;
     AVPacket *pkt = nullptr;
+    // Payload allocations of read audio and video packets.
+    tMediaPacketAllocStats pkt_alloc_stats;
     long duration = 0;
 
+    /**
+     * Packet queues, owned by Java player.
+     */
+    tMediaPacketQueue *video_pkt_queue = nullptr;
+    tMediaPacketQueue *audio_pkt_queue = nullptr;
+
+    // Blocking io interrupt, owned by Java player.
+    tMediaInterruptContext *interrupt_ctx = nullptr;
+
+    /**
+     * Fast start, streams not found by bounded probing are discovered by readPacket().
+     */
+    bool fastStart = false;
+    int knownStreamCount = 0;
+    std::atomic<bool> newStreamsDiscovered {false};
+
+    /**
+     * Streams discard, set by Java and applied by packet reader thread.
+     */
+    std::atomic<int> selected_subtitle_stream_index {-1};
+    std::atomic<bool> video_discarded {false};
+    std::atomic<bool> discard_dirty {true};
+    // Video re-enabled, drop video packets until key frame.
+    bool video_wait_key_frame = false;
+
     Metadata fileMetadata;
 
     char *containerName = nullptr;
@@ -117,9 +269,12 @@ typedef struct tMediaPlayerContext {
      */
     AVStream *video_stream = nullptr;
     AVBufferRef *hardware_ctx = nullptr;
+    // Hw surface format picked for this player's decoder, read back by get_format.
+    AVPixelFormat video_hw_pix_fmt = AV_PIX_FMT_NONE;
     const AVCodec *video_decoder = nullptr;
     char *videoDecoderName = nullptr;
-    SwsContext * video_sws_ctx = nullptr;
+    // Conversion of formats not supported by renderer.
+    tMediaSlicedSws video_sws;
     int video_width = 0;
     int video_height = 0;
     int video_bits_per_raw_sample = 0;
@@ -130,8 +285,40 @@ typedef struct tMediaPlayerContext {
     bool videoIsAttachPic = false;
     AVCodecID video_codec_id = AV_CODEC_ID_NONE;
     AVCodecContext *video_decoder_ctx = nullptr;
+    // Software decoder threading.
+    tMediaDecodeThreadPolicy video_decode_threads;
+    // Skip decode work when video late than master clock.
+    tMediaDecodeDegrader video_degrade;
+    /**
+     * Late frames policy, set by Java.
+     */
+    bool video_degrade_enabled = true;
+    bool video_drop_late_frames = true;
+    int video_continuous_drops = 0;
+    std::atomic<int64_t> video_late_dropped_frames {0};
+    /**
+     * Output 10 bits frames without converting to 8 bits, set by Java.
+     */
+    bool video_high_bit_depth_passthrough = false;
+    /**
+     * Output size hint from Java (view's surface size), 0 means not limited.
+     * Frames at least 2x larger than target are downscaled by power of 2, codecs support lowres decode smaller frames.
+     */
+    std::atomic<int> video_target_width {0};
+    std::atomic<int> video_target_height {0};
+    // Lowres level computed for target size, recomputed only when target size changed.
+    int video_lowres = 0;
+    int video_lowres_target_width = -1;
+    int video_lowres_target_height = -1;
     AVFrame *video_frame = nullptr;
     AVPacket *video_pkt = nullptr;
+    int video_pkt_serial = -1;
+    // Last packet not sent to decoder by decodeVideoToBuffers(), send it again before popping queue.
+    bool video_skip_next_pkt_read = false;
+    /**
+     * Recently delivered frames for backward frame steps, only accessed by video decoder thread.
+     */
+    tMediaFrameStepCache video_frame_step;
     Metadata *videoMetaData = nullptr;
 
     /**
@@ -156,7 +343,41 @@ typedef struct tMediaPlayerContext {
     AVCodecID audio_codec_id = AV_CODEC_ID_NONE;
     AVFrame *audio_frame = nullptr;
     AVPacket *audio_pkt = nullptr;
+    int audio_pkt_serial = -1;
+    // Last packet not sent to decoder by decodeAudioToBuffers(), send it again before popping queue.
+    bool audio_skip_next_pkt_read = false;
     Metadata *audioMetadata = nullptr;
+    // All audio streams, audio_stream is one of them.
+    int audioStreamCount = 0;
+    AudioStream **audioStreams = nullptr;
+
+    /**
+     * Audio stream switched, reader seek back to switch position, skip video and subtitle packets already read
+     * and audio packets before switch position.
+     */
+    std::atomic<int64_t> audio_resync_pos_in_millis {-1};
+    int64_t audio_skip_until_pts = AV_NOPTS_VALUE;
+    int64_t video_skip_until_dts = AV_NOPTS_VALUE;
+    int64_t subtitle_skip_until_millis = -1;
+    /**
+     * Key frame only trick play, set by Java. 0 is normal play, positive is fast forward speed and negative is rewind speed.
+     * Reader jumps key frame to key frame, audio and subtitle packets are discarded, decoder skips non key frames.
+     */
+    std::atomic<int> trick_play_speed {0};
+    // Dts (pts if no dts) of last key frame pushed by trick play, video stream time base.
+    int64_t trick_play_last_key_ts = AV_NOPTS_VALUE;
+    int trick_play_step_scale = 1;
+    bool video_trick_play_applied = false;
+    /**
+     * Reverse playback, set by Java. Video frames come from reverse decoder, packet reader only pushes audio eof.
+     * Reverse decoder is created by first enable and kept until release.
+     */
+    std::atomic<bool> reverse_playback {false};
+    tMediaReverseDecoder *video_reverse = nullptr;
+    bool reverse_audio_eof_pushed = false;
+    int64_t last_video_pkt_dts = AV_NOPTS_VALUE;
+    int64_t last_read_pkt_millis = -1;
+    bool video_eof_pushed = false;
 
     /**
      * Subtitle
@@ -169,10 +390,82 @@ typedef struct tMediaPlayerContext {
             bool is_request_hw,
             int target_audio_channels,
             int target_audio_sample_rate,
-            int target_audio_sample_bit_depth);
+            int target_audio_sample_bit_depth,
+            tMediaIOMode io_mode,
+            int64_t read_ahead_buffer_size,
+            bool fast_start,
+            tMediaDecodeThreadType video_decode_thread_type,
+            int video_decode_thread_count);
 
     tMediaReadPktResult readPacket();
 
+    void beginBlockingOp(tMediaBlockingOp op);
+
+    int endBlockingOp(int ret);
+
+    /**
+     * Create decoder and swr context of stream, old decoder and swr context are replaced only when success.
+     */
+    tMediaOptResult openAudioStream(AVStream *stream);
+
+    /**
+     * Java need stop packet reader and audio decoder, only audio decoder and swr context are changed.
+     * Audio queue is flushed later by packet reader thread, new audio stream play from positionInMillis.
+     */
+    tMediaOptResult switchAudioStream(int streamIndex, int64_t positionInMillis);
+
+    /**
+     * Call by packet reader thread after audio stream switched.
+     */
+    void resyncAudioStream();
+
+    void setSelectedSubtitleStream(int streamIndex);
+
+    /**
+     * Only discard video when audio stream exist, audio clock keep playing.
+     */
+    void setVideoDiscarded(bool discarded);
+
+    /**
+     * Call by packet reader thread, unselected streams are never demuxed.
+     */
+    void applyStreamsDiscard();
+
+    /**
+     * Register stream which not found by prepare, return true if it's a new subtitle stream.
+     */
+    bool discoverStream(int streamIndex);
+
+    bool isPktQueuesFull(int64_t maxBytes, int64_t maxDurationInMillis);
+
+    /**
+     * Read packets and push to video_pkt_queue and audio_pkt_queue until queues full, eof, fail
+     * or subtitle packet (keep in pkt, need movePacketRef()).
+     */
+    tMediaReadPktsToQueueResult readPacketsToQueues(int64_t maxBytes, int64_t maxDurationInMillis, bool requestAttachment);
+
+    /**
+     * Trick play version of readPacketsToQueues(), only key frames of video stream are pushed to video_pkt_queue.
+     */
+    tMediaReadPktsToQueueResult readTrickPlayPacketsToQueue(int64_t maxBytes);
+
+    /**
+     * Seek to key frame about speed * TRICK_PLAY_FRAME_INTERVAL_IN_MILLIS away from last pushed key frame.
+     * @return false if no more key frame in the direction.
+     */
+    bool seekToNextTrickPlayKeyFrame(int speed);
+
+    /**
+     * Reverse version of readPacketsToQueues(), audio is muted.
+     */
+    tMediaReadPktsToQueueResult readReversePacketsToQueue();
+
+    /**
+     * Call by Java, reverse decoder is prepared when first enabled, cached frames are dropped when disabled.
+     * Java need seek to current position after changed.
+     */
+    tMediaOptResult setReversePlayback(bool enabled, int64_t cacheSizeInBytes);
+
     tMediaOptResult pauseReadPacket();
 
     tMediaOptResult resumeReadPacket();
@@ -183,15 +476,66 @@ typedef struct tMediaPlayerContext {
 
     tMediaDecodeResult decodeVideo(AVPacket *targetPkt);
 
+    /**
+     * Decode video_pkt and measure decode cost, software decoder is reopened on key frame when auto threading need more threads.
+     * Negative masterClockInMillis means unknown, degrade level not changed.
+     */
+    tMediaDecodeResult decodeVideoPkt(int64_t masterClockInMillis);
+
+    /**
+     * Replace software decoder ctx with new thread count, frames buffered by old decoder are dropped.
+     */
+    tMediaOptResult reopenVideoDecoder(int threadCount);
+
+    /**
+     * Lowres level of software decoder for target output size, 0 if codec not support.
+     * Cached in video_lowres until target size changes.
+     */
+    int videoLowres();
+
+    /**
+     * Power of 2 downscale of decoded frame, output keeps larger than target output size.
+     */
+    int videoDownscaleShift(int w, int h);
+
+    /**
+     * Frame decoded is late than master clock, unref it without conversion and copy.
+     */
+    bool isLateVideoFrame(int64_t framePtsInMillis, int64_t masterClockInMillis);
+
+    /**
+     * Pop packet from video_pkt_queue and decode, flush decoder when packet serial changed.
+     */
+    tMediaDecodeResult decodeVideoFromQueue(bool skipPktRead, int64_t masterClockInMillis);
+
     tMediaOptResult moveDecodedVideoFrameToBuffer(tMediaVideoBuffer* buffer);
 
-    void flushVideoCodecBuffer();
+    /**
+     * Decode packets from video_pkt_queue and move frames to buffers until all buffers published, packet queue empty,
+     * eof or batch limit reached. Decoder state is kept between calls, eof frame is not written to buffers.
+     */
+    tMediaDecodeToBuffersResult decodeVideoToBuffers(tMediaVideoBuffer **buffers, int count, int64_t masterClockInMillis, int64_t *descriptors);
+
+    /**
+     * Reverse version of decodeVideoToBuffers(), frames are taken from reverse decoder's cache.
+     */
+    tMediaDecodeToBuffersResult decodeReverseVideoToBuffers(tMediaVideoBuffer **buffers, int count, int64_t *descriptors);
 
-    tMediaDecodeResult decodeAudio(AVPacket *targetPkt);
+    /**
+     * Call by Java when video decoder is idle, step to the frame before showing frame.
+     * Return -1 if cached frames replay from it, next decodeVideoToBuffers() delivers it. Otherwise return the position
+     * Java need seek to, frames after seek are decoded until showing frame and replay from the frame before it.
+     */
+    int64_t stepVideoFrameBackward(int64_t showingPtsInMillis);
+
+    tMediaDecodeResult decodeAudioFromQueue(bool skipPktRead);
 
     tMediaOptResult moveDecodedAudioFrameToBuffer(tMediaAudioBuffer* buffer);
 
-    void flushAudioCodecBuffer();
+    /**
+     * Same as decodeVideoToBuffers().
+     */
+    tMediaDecodeToBuffersResult decodeAudioToBuffers(tMediaAudioBuffer **buffers, int count, int64_t *descriptors);
 
     void release();
 } tMediaPlayerContext;
@@ -0,0 +1,70 @@
+//
+// Created by pengcheng.tan on 2024/8/16.
+//
+
+#ifndef TMEDIAPLAYER_TMEDIAPROBECACHE_H
+#define TMEDIAPLAYER_TMEDIAPROBECACHE_H
+
+#include <atomic>
+
+extern "C" {
+#include "libavformat/avformat.h"
+}
+
+#define PROBE_CACHE_MAX_ENTRY_COUNT 32
+
+/**
+ * Stats array layout for Java: [hits, misses, hitsProbeTime(us), missesProbeTime(us)]
+ */
+#define PROBE_CACHE_STATS_SIZE 4
+
+typedef struct tMediaProbeStream {
+    AVMediaType codecType = AVMEDIA_TYPE_UNKNOWN;
+    int id = 0;
+    AVCodecParameters *codecpar = nullptr;
+    AVRational avgFrameRate {0, 1};
+    AVRational rFrameRate {0, 1};
+    AVRational sampleAspectRatio {0, 1};
+    int64_t startTime = AV_NOPTS_VALUE;
+    int64_t duration = AV_NOPTS_VALUE;
+    int64_t nbFrames = 0;
+} tMediaProbeStream;
+
+/**
+ * avformat_find_stream_info() result of a local file, key is path, size and mtime.
+ */
+typedef struct tMediaProbeCacheEntry {
+    char *path = nullptr;
+    int64_t fileSize = 0;
+    int64_t mtimeInNanos = 0;
+    const AVInputFormat *iformat = nullptr;
+    unsigned int streamCount = 0;
+    tMediaProbeStream *streams = nullptr;
+    int64_t startTime = AV_NOPTS_VALUE;
+    int64_t duration = AV_NOPTS_VALUE;
+    int64_t bitRate = 0;
+    int64_t lastUsed = 0;
+
+    void release();
+} tMediaProbeCacheEntry;
+
+typedef struct tMediaProbeCacheStats {
+    std::atomic<int64_t> hits {0};
+    std::atomic<int64_t> misses {0};
+    std::atomic<int64_t> hitsProbeTimeInMicros {0};
+    std::atomic<int64_t> missesProbeTimeInMicros {0};
+} tMediaProbeCacheStats;
+
+/**
+ * Replace avformat_find_stream_info(), shared by player and frame loader.
+ * Cache hit copy codec parameters, frame rates and durations to opened streams and skip probing,
+ * cache miss (or streams opened by demuxer not match cache) probe and update cache.
+ * @return avformat_find_stream_info() result, 0 if cache hit.
+ */
+int findStreamInfoWithCache(AVFormatContext *format_ctx, const char *file);
+
+void getProbeCacheStats(int64_t *target);
+
+void clearProbeCache();
+
+#endif //TMEDIAPLAYER_TMEDIAPROBECACHE_H
@@ -0,0 +1,168 @@
+//
+// Created by pengcheng.tan on 2024/8/28.
+//
+
+#ifndef TMEDIAPLAYER_TMEDIAREVERSE_H
+#define TMEDIAPLAYER_TMEDIAREVERSE_H
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "tmediainterrupt.h"
+#include "tmediadecodethreads.h"
+#include "tmediaswsslice.h"
+
+extern "C" {
+#include "libavformat/avformat.h"
+#include "libavcodec/avcodec.h"
+}
+
+// Frame cache budget of reverse playback, shared by emitting, prefetched and decoding GOPs.
+#define REVERSE_DEFAULT_CACHE_SIZE (64 * 1024 * 1024)
+#define REVERSE_MIN_CACHE_SIZE (8 * 1024 * 1024)
+// Emitting, prefetched and decoding.
+#define REVERSE_CACHED_GOP_COUNT 3
+// GOPs longer than this or larger than budget are emitted in several parts, each part decodes from the key frame.
+#define REVERSE_MAX_GOP_FRAMES 256
+// Consumer waits prefetched GOP at most so long, let decoder thread handle seek and release, ms.
+#define REVERSE_WAIT_GOP_IN_MILLIS 20
+// Seek before GOP end landed on a later key frame, double the step back at most so many times.
+#define REVERSE_MAX_SEEK_RETRIES 8
+// First step back of seek retry, ms.
+#define REVERSE_SEEK_RETRY_STEP_IN_MILLIS 1000
+
+/**
+ * Stats array layout for Java: [cachedBytes, peakCachedBytes, cachedFrames, decodedGops, decodedFrames, gopDecodeTime(us),
+ * emittedFrames, stallTime(us)]
+ */
+#define REVERSE_STATS_SIZE 8
+
+enum tMediaReversePopResult {
+    ReversePopSuccess,
+    // Previous GOP is decoding, call again.
+    ReversePopWaiting,
+    // First frame emitted.
+    ReversePopEnd
+};
+
+/**
+ * Decoded frames of one GOP (or the tail part of a long GOP) sorted by pts, pts in [startTs, endTs) of stream time base.
+ * Frames are emitted from the last one.
+ */
+typedef struct tMediaReverseGop {
+    AVFrame *frames[REVERSE_MAX_GOP_FRAMES] = {nullptr};
+    int count = 0;
+    int64_t bytes = 0;
+    int64_t startTs = AV_NOPTS_VALUE;
+    int64_t endTs = AV_NOPTS_VALUE;
+    // Oldest frames dropped by limit, next part ends at first frame.
+    bool truncated = false;
+
+    /**
+     * Insert by pts, oldest frames are dropped when frames count or bytes over limit, frame is freed if it's dropped.
+     */
+    void insert(AVFrame *frame, int64_t frameBytes, int64_t maxBytes);
+
+    void clear();
+} tMediaReverseGop;
+
+typedef struct tMediaReverseStats {
+    std::atomic<int64_t> cachedBytes {0};
+    std::atomic<int64_t> peakCachedBytes {0};
+    std::atomic<int64_t> cachedFrames {0};
+    std::atomic<int64_t> decodedGops {0};
+    std::atomic<int64_t> decodedFrames {0};
+    std::atomic<int64_t> gopDecodeTimeInMicros {0};
+    std::atomic<int64_t> emittedFrames {0};
+    // Time of consumer waiting prefetched GOP.
+    std::atomic<int64_t> stallTimeInMicros {0};
+} tMediaReverseStats;
+
+/**
+ * Reverse playback, a worker thread with its own demuxer and software decoder decodes the GOP before emitted frames
+ * forward into a bounded frame cache, consumer takes frames from the newest one.
+ * When one GOP is emitting, the previous GOP is prefetched. Frames much larger than target output size are cached
+ * downscaled to yuv420p, so the cache holds more frames.
+ */
+typedef struct tMediaReverseDecoder {
+    AVFormatContext *format_ctx = nullptr;
+    AVStream *video_stream = nullptr;
+    const AVCodec *video_decoder = nullptr;
+    AVCodecContext *video_decoder_ctx = nullptr;
+    tMediaDecodeThreadPolicy video_decode_threads;
+    AVPacket *pkt = nullptr;
+    AVFrame *frame = nullptr;
+    // Downscale of formats not supported by simd kernels.
+    tMediaSlicedSws sws;
+    tMediaInterruptContext interrupt;
+    int64_t maxCacheBytes = REVERSE_DEFAULT_CACHE_SIZE;
+
+    /**
+     * Output size hint, updated by consumer, 0 means not limited.
+     */
+    std::atomic<int> targetWidth {0};
+    std::atomic<int> targetHeight {0};
+
+    /**
+     * Guarded by lock, decoding GOP only accessed by worker thread.
+     */
+    tMediaReverseGop gops[REVERSE_CACHED_GOP_COUNT];
+    tMediaReverseGop *emitting = &gops[0];
+    tMediaReverseGop *prefetched = &gops[1];
+    tMediaReverseGop *decoding = &gops[2];
+    bool prefetchReady = false;
+    bool started = false;
+    // No GOP before nextEndTs.
+    bool reachedStart = false;
+    int64_t nextEndTs = AV_NOPTS_VALUE;
+    // Increased by start() and stop(), GOP decoded for old generation is dropped.
+    std::atomic<int> generation {0};
+    bool stopWorker = false;
+    std::thread *worker = nullptr;
+    std::mutex lock;
+    std::condition_variable cond;
+
+    tMediaReverseStats stats;
+
+    /**
+     * Open media file and software decoder of stream, start worker thread.
+     */
+    bool prepare(const char *file, int streamIndex, int64_t cacheSizeInBytes, tMediaDecodeThreadType threadType, int threadCount);
+
+    /**
+     * Drop cached frames, emit frames from positionInMillis (not included) backward.
+     */
+    void start(int64_t positionInMillis);
+
+    /**
+     * Drop cached frames and stop decoding.
+     */
+    void stop();
+
+    /**
+     * Move newest not emitted frame ref to target.
+     */
+    tMediaReversePopResult popFrame(AVFrame *target);
+
+    void workerLoop();
+
+    /**
+     * Seek to the key frame before endTs, decode frames with pts in [key frame, endTs) to gop.
+     * Return false if no key frame before endTs, decode fail or generation changed.
+     */
+    bool decodeGop(int64_t endTs, tMediaReverseGop *gop, int gen);
+
+    /**
+     * Move decoded frame to gop, downscaled if much larger than target output size.
+     */
+    void cacheFrame(AVFrame *src, tMediaReverseGop *gop, int64_t keyTs);
+
+    void updateCachedStats(int64_t bytesDelta, int framesDelta);
+
+    void writeStats(int64_t *target);
+
+    void release();
+} tMediaReverseDecoder;
+
+#endif //TMEDIAPLAYER_TMEDIAREVERSE_H
@@ -0,0 +1,64 @@
+//
+// Created by pengcheng.tan on 2024/8/25.
+//
+
+#ifndef TMEDIAPLAYER_TMEDIASWSCACHE_H
+#define TMEDIAPLAYER_TMEDIASWSCACHE_H
+
+#include <atomic>
+
+extern "C" {
+#include "libswscale/swscale.h"
+}
+
+// Idle contexts keep their slice threads, keep cache small.
+#define SWS_CACHE_MAX_ENTRY_COUNT 4
+
+/**
+ * Stats array layout for Java: [hits, misses, evictions, idleContexts]
+ */
+#define SWS_CACHE_STATS_SIZE 4
+
+typedef struct tMediaSwsKey {
+    int srcWidth = 0;
+    int srcHeight = 0;
+    AVPixelFormat srcFormat = AV_PIX_FMT_NONE;
+    bool srcFullRange = false;
+    int dstWidth = 0;
+    int dstHeight = 0;
+    AVPixelFormat dstFormat = AV_PIX_FMT_NONE;
+    int flags = 0;
+    int threadCount = 1;
+
+    bool equals(const tMediaSwsKey &other) const;
+} tMediaSwsKey;
+
+typedef struct tMediaSwsCacheEntry {
+    tMediaSwsKey key;
+    SwsContext *ctx = nullptr;
+    int64_t lastUsed = 0;
+} tMediaSwsCacheEntry;
+
+typedef struct tMediaSwsCacheStats {
+    std::atomic<int64_t> hits {0};
+    std::atomic<int64_t> misses {0};
+    std::atomic<int64_t> evictions {0};
+} tMediaSwsCacheStats;
+
+/**
+ * Idle sws contexts shared by player and frame loader, a context can't be used by two threads,
+ * so it's removed from cache when acquired and put back when the user done with it.
+ * @return cached context or new created context, nullptr if create fail.
+ */
+SwsContext *acquireSwsContext(const tMediaSwsKey &key);
+
+/**
+ * Put context back to cache, least recently used context is freed if cache is full.
+ */
+void recycleSwsContext(const tMediaSwsKey &key, SwsContext *ctx);
+
+void getSwsCacheStats(int64_t *target);
+
+void clearSwsCache();
+
+#endif //TMEDIAPLAYER_TMEDIASWSCACHE_H
@@ -0,0 +1,65 @@
+//
+// Created by pengcheng.tan on 2024/8/25.
+//
+
+#ifndef TMEDIAPLAYER_TMEDIASWSSLICE_H
+#define TMEDIAPLAYER_TMEDIASWSSLICE_H
+
+#include <atomic>
+#include "tmediaswscache.h"
+
+extern "C" {
+#include "libswscale/swscale.h"
+#include "libavutil/frame.h"
+}
+
+#define SWS_SLICE_MAX_THREAD_COUNT 8
+
+// Frames smaller than this convert on caller's thread, dispatch cost is larger than saved time.
+#define SWS_SLICE_MIN_PIXELS (1280 * 720)
+
+/**
+ * Stats array layout for Java: [sliceThreadCount, convertedFrames, avgConvertCost(us), maxConvertCost(us)]
+ */
+#define SWS_SLICE_STATS_SIZE 4
+
+/**
+ * Sws conversion split into horizontal slices, slices are converted by swscale's slice threads.
+ * Thread count 0 means compute by resolution and cpu cores.
+ * Contexts are taken from shared cache and put back when params changed or freed.
+ */
+typedef struct tMediaSlicedSws {
+    std::atomic<int> requestCount {0};
+
+    SwsContext *ctx = nullptr;
+    tMediaSwsKey key;
+    // Wrap caller's buffers, threaded api only accept frames.
+    AVFrame *dstFrame = nullptr;
+
+    std::atomic<int> appliedCount {0};
+    std::atomic<int64_t> convertedFrames {0};
+    std::atomic<int64_t> convertCostSum {0};
+    std::atomic<int64_t> maxConvertCost {0};
+
+    void setThreadCount(int count);
+
+    /**
+     * Reuse context if src frame's format, size and color range and target params not changed,
+     * return false if context create fail.
+     */
+    bool ensureContext(const AVFrame *src, int dstW, int dstH, AVPixelFormat dstFmt, int swsFlags);
+
+    /**
+     * Convert whole src frame, return negative value if fail.
+     */
+    int scale(const AVFrame *src, uint8_t *const dstData[], const int dstLineSize[]);
+
+    void writeStats(int64_t *target);
+
+    /**
+     * Put context back to cache.
+     */
+    void freeContext();
+} tMediaSlicedSws;
+
+#endif //TMEDIAPLAYER_TMEDIASWSSLICE_H
@@ -30,132 +30,470 @@ Java_com_tans_tmediaplayer_player_tMediaPlayer_prepareNative(
         jboolean requestHw,
         jint targetAudioChannels,
         jint targetAudioSampleRate,
-        jint targetAudioSampleBitDepth) {
+        jint targetAudioSampleBitDepth,
+        jint ioMode,
+        jlong readAheadBufferSize,
+        jboolean fastStart,
+        jint videoDecodeThreadType,
+        jint videoDecodeThreadCount) {
     auto *player = reinterpret_cast<tMediaPlayerContext *>(native_player);
     if (player == nullptr) {
         return OptFail;
     }
     av_jni_set_java_vm(player->jvm, nullptr);
     const char * file_path_chars = env->GetStringUTFChars(file_path, JNI_FALSE);
-    return player->prepare(file_path_chars, requestHw, targetAudioChannels, targetAudioSampleRate, targetAudioSampleBitDepth);
+    return player->prepare(file_path_chars, requestHw, targetAudioChannels, targetAudioSampleRate, targetAudioSampleBitDepth,
+                           static_cast<tMediaIOMode>(ioMode), readAheadBufferSize, fastStart,
+                           static_cast<tMediaDecodeThreadType>(videoDecodeThreadType), videoDecodeThreadCount);
 }
 
-extern "C" JNIEXPORT jint JNICALL
-Java_com_tans_tmediaplayer_player_tMediaPlayer_readPacketNative(
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_takeNewStreamsDiscoveredNative(
         JNIEnv * env,
         jobject j_player,
         jlong native_player) {
     auto *player = reinterpret_cast<tMediaPlayerContext *>(native_player);
-    return player->readPacket();
+    return player->newStreamsDiscovered.exchange(false);
 }
 
-extern "C" JNIEXPORT jint JNICALL
-Java_com_tans_tmediaplayer_player_tMediaPlayer_pauseReadPacketNative(
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_getFileIOStatsNative(
         JNIEnv * env,
         jobject j_player,
-        jlong native_player) {
+        jlong native_player,
+        jlongArray j_stats) {
     auto *player = reinterpret_cast<tMediaPlayerContext *>(native_player);
-    return player->pauseReadPacket();
+    if (player->io_ctx == nullptr || env->GetArrayLength(j_stats) < IO_STATS_SIZE) {
+        return false;
+    }
+    int64_t stats[IO_STATS_SIZE];
+    player->io_ctx->writeStats(stats);
+    env->SetLongArrayRegion(j_stats, 0, IO_STATS_SIZE, stats);
+    return true;
 }
 
-extern "C" JNIEXPORT jint JNICALL
-Java_com_tans_tmediaplayer_player_tMediaPlayer_playReadPacketNative(
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_getPacketAllocStatsNative(
+        JNIEnv * env,
+        jobject j_player,
+        jlong native_player,
+        jlongArray j_stats) {
+    auto *player = reinterpret_cast<tMediaPlayerContext *>(native_player);
+    if (env->GetArrayLength(j_stats) < PKT_ALLOC_STATS_SIZE) {
+        return false;
+    }
+    int64_t stats[PKT_ALLOC_STATS_SIZE];
+    player->pkt_alloc_stats.writeStats(stats);
+    env->SetLongArrayRegion(j_stats, 0, PKT_ALLOC_STATS_SIZE, stats);
+    return true;
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_getVideoDecodeThreadsStatsNative(
+        JNIEnv * env,
+        jobject j_player,
+        jlong native_player,
+        jlongArray j_stats) {
+    auto *player = reinterpret_cast<tMediaPlayerContext *>(native_player);
+    if (player->video_decoder_ctx == nullptr || env->GetArrayLength(j_stats) < DECODE_THREADS_STATS_SIZE) {
+        return false;
+    }
+    int64_t stats[DECODE_THREADS_STATS_SIZE];
+    player->video_decode_threads.writeStats(stats);
+    env->SetLongArrayRegion(j_stats, 0, DECODE_THREADS_STATS_SIZE, stats);
+    return true;
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_getVideoConvertStatsNative(
+        JNIEnv * env,
+        jobject j_player,
+        jlong native_player,
+        jlongArray j_stats) {
+    auto *player = reinterpret_cast<tMediaPlayerContext *>(native_player);
+    if (player->video_decoder_ctx == nullptr || env->GetArrayLength(j_stats) < SWS_SLICE_STATS_SIZE) {
+        return false;
+    }
+    int64_t stats[SWS_SLICE_STATS_SIZE];
+    player->video_sws.writeStats(stats);
+    env->SetLongArrayRegion(j_stats, 0, SWS_SLICE_STATS_SIZE, stats);
+    return true;
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_getReversePlaybackStatsNative(
+        JNIEnv * env,
+        jobject j_player,
+        jlong native_player,
+        jlongArray j_stats) {
+    auto *player = reinterpret_cast<tMediaPlayerContext *>(native_player);
+    if (player->video_reverse == nullptr || env->GetArrayLength(j_stats) < REVERSE_STATS_SIZE) {
+        return false;
+    }
+    int64_t stats[REVERSE_STATS_SIZE];
+    player->video_reverse->writeStats(stats);
+    env->SetLongArrayRegion(j_stats, 0, REVERSE_STATS_SIZE, stats);
+    return true;
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_getFrameStepStatsNative(
+        JNIEnv * env,
+        jobject j_player,
+        jlong native_player,
+        jlongArray j_stats) {
+    auto *player = reinterpret_cast<tMediaPlayerContext *>(native_player);
+    if (env->GetArrayLength(j_stats) < FRAME_STEP_STATS_SIZE) {
+        return false;
+    }
+    int64_t stats[FRAME_STEP_STATS_SIZE];
+    player->video_frame_step.writeStats(stats);
+    env->SetLongArrayRegion(j_stats, 0, FRAME_STEP_STATS_SIZE, stats);
+    return true;
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_getVideoDecodeDegradeStatsNative(
+        JNIEnv * env,
+        jobject j_player,
+        jlong native_player,
+        jlongArray j_stats) {
+    auto *player = reinterpret_cast<tMediaPlayerContext *>(native_player);
+    if (player->video_decoder_ctx == nullptr || env->GetArrayLength(j_stats) < DEGRADE_STATS_SIZE) {
+        return false;
+    }
+    int64_t stats[DEGRADE_STATS_SIZE];
+    player->video_degrade.writeStats(stats);
+    env->SetLongArrayRegion(j_stats, 0, DEGRADE_STATS_SIZE, stats);
+    return true;
+}
+
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_getLateVideoFrameDropsNative(
         JNIEnv * env,
         jobject j_player,
         jlong native_player) {
     auto *player = reinterpret_cast<tMediaPlayerContext *>(native_player);
-    return player->resumeReadPacket();
+    return player->video_late_dropped_frames;
 }
 
 extern "C" JNIEXPORT void JNICALL
-Java_com_tans_tmediaplayer_player_tMediaPlayer_movePacketRefNative(
+Java_com_tans_tmediaplayer_player_tMediaPlayer_getProbeCacheStatsNative(
+        JNIEnv * env,
+        jobject j_player,
+        jlongArray j_stats) {
+    if (env->GetArrayLength(j_stats) < PROBE_CACHE_STATS_SIZE) {
+        return;
+    }
+    int64_t stats[PROBE_CACHE_STATS_SIZE];
+    getProbeCacheStats(stats);
+    env->SetLongArrayRegion(j_stats, 0, PROBE_CACHE_STATS_SIZE, stats);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_clearProbeCacheNative(
+        JNIEnv * env,
+        jobject j_player) {
+    clearProbeCache();
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_getVideoConvertCacheStatsNative(
+        JNIEnv * env,
+        jobject j_player,
+        jlongArray j_stats) {
+    if (env->GetArrayLength(j_stats) < SWS_CACHE_STATS_SIZE) {
+        return;
+    }
+    int64_t stats[SWS_CACHE_STATS_SIZE];
+    getSwsCacheStats(stats);
+    env->SetLongArrayRegion(j_stats, 0, SWS_CACHE_STATS_SIZE, stats);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_clearVideoConvertCacheNative(
+        JNIEnv * env,
+        jobject j_player) {
+    clearSwsCache();
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_attachPacketQueuesNative(
         JNIEnv * env,
         jobject j_player,
         jlong native_player,
-        jlong native_packet) {
+        jlong native_video_queue,
+        jlong native_audio_queue) {
     auto *player = reinterpret_cast<tMediaPlayerContext *>(native_player);
-    auto *pkt = reinterpret_cast<AVPacket *>(native_packet);
-    player->movePacketRef(pkt);
+    player->video_pkt_queue = reinterpret_cast<tMediaPacketQueue *>(native_video_queue);
+    player->audio_pkt_queue = reinterpret_cast<tMediaPacketQueue *>(native_audio_queue);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_attachInterruptNative(
+        JNIEnv * env,
+        jobject j_player,
+        jlong native_player,
+        jlong native_interrupt) {
+    auto *player = reinterpret_cast<tMediaPlayerContext *>(native_player);
+    player->interrupt_ctx = reinterpret_cast<tMediaInterruptContext *>(native_interrupt);
 }
 
 extern "C" JNIEXPORT jint JNICALL
-Java_com_tans_tmediaplayer_player_tMediaPlayer_seekToNative(
+Java_com_tans_tmediaplayer_player_tMediaPlayer_readPacketsToQueuesNative(
         JNIEnv * env,
         jobject j_player,
         jlong native_player,
-        jlong target_pos_in_millis) {
+        jlong max_bytes,
+        jlong max_duration,
+        jboolean request_attachment) {
     auto *player = reinterpret_cast<tMediaPlayerContext *>(native_player);
-    return player->seekTo(target_pos_in_millis);
+    return player->readPacketsToQueues(max_bytes, max_duration, request_attachment);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_setSelectedSubtitleStreamNative(
+        JNIEnv * env,
+        jobject j_player,
+        jlong native_player,
+        jint stream_index) {
+    auto *player = reinterpret_cast<tMediaPlayerContext *>(native_player);
+    player->setSelectedSubtitleStream(stream_index);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_setVideoDiscardedNative(
+        JNIEnv * env,
+        jobject j_player,
+        jlong native_player,
+        jboolean discarded) {
+    auto *player = reinterpret_cast<tMediaPlayerContext *>(native_player);
+    player->setVideoDiscarded(discarded);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_setVideoLateFramePolicyNative(
+        JNIEnv * env,
+        jobject j_player,
+        jlong native_player,
+        jboolean degrade,
+        jboolean drop_late_frames) {
+    auto *player = reinterpret_cast<tMediaPlayerContext *>(native_player);
+    player->video_degrade_enabled = degrade;
+    player->video_drop_late_frames = drop_late_frames;
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_setVideoHighBitDepthPassthroughNative(
+        JNIEnv * env,
+        jobject j_player,
+        jlong native_player,
+        jboolean passthrough) {
+    auto *player = reinterpret_cast<tMediaPlayerContext *>(native_player);
+    player->video_high_bit_depth_passthrough = passthrough;
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_setVideoTargetOutputSizeNative(
+        JNIEnv * env,
+        jobject j_player,
+        jlong native_player,
+        jint width,
+        jint height) {
+    auto *player = reinterpret_cast<tMediaPlayerContext *>(native_player);
+    player->video_target_width = width;
+    player->video_target_height = height;
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_setTrickPlaySpeedNative(
+        JNIEnv * env,
+        jobject j_player,
+        jlong native_player,
+        jint speed) {
+    auto *player = reinterpret_cast<tMediaPlayerContext *>(native_player);
+    player->trick_play_speed = speed;
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_setFrameStepCacheSizeNative(
+        JNIEnv * env,
+        jobject j_player,
+        jlong native_player,
+        jlong cache_size) {
+    auto *player = reinterpret_cast<tMediaPlayerContext *>(native_player);
+    player->video_frame_step.maxBytes = cache_size;
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_setFrameStepCacheEnabledNative(
+        JNIEnv * env,
+        jobject j_player,
+        jlong native_player,
+        jboolean enabled) {
+    auto *player = reinterpret_cast<tMediaPlayerContext *>(native_player);
+    player->video_frame_step.enabled = enabled;
+}
+
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_stepVideoFrameBackwardNative(
+        JNIEnv * env,
+        jobject j_player,
+        jlong native_player,
+        jlong showing_pts_in_millis) {
+    auto *player = reinterpret_cast<tMediaPlayerContext *>(native_player);
+    return player->stepVideoFrameBackward(showing_pts_in_millis);
 }
 
 extern "C" JNIEXPORT jint JNICALL
-Java_com_tans_tmediaplayer_player_tMediaPlayer_decodeVideoNative(
+Java_com_tans_tmediaplayer_player_tMediaPlayer_setReversePlaybackNative(
         JNIEnv * env,
         jobject j_player,
         jlong native_player,
-        jlong native_buffer) {
+        jboolean enabled,
+        jlong cache_size) {
     auto *player = reinterpret_cast<tMediaPlayerContext *>(native_player);
-    if (native_buffer != 0L) {
-        auto *pkt = reinterpret_cast<AVPacket *>(native_buffer);
-        return player->decodeVideo(pkt);
-    } else {
-        return player->decodeVideo(nullptr);
-    }
+    return player->setReversePlayback(enabled, cache_size);
 }
 
 extern "C" JNIEXPORT void JNICALL
-Java_com_tans_tmediaplayer_player_tMediaPlayer_flushVideoCodecBufferNative(
+Java_com_tans_tmediaplayer_player_tMediaPlayer_setVideoConvertThreadCountNative(
+        JNIEnv * env,
+        jobject j_player,
+        jlong native_player,
+        jint thread_count) {
+    auto *player = reinterpret_cast<tMediaPlayerContext *>(native_player);
+    player->video_sws.setThreadCount(thread_count);
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_pauseReadPacketNative(
         JNIEnv * env,
         jobject j_player,
         jlong native_player) {
     auto *player = reinterpret_cast<tMediaPlayerContext *>(native_player);
-    player->flushVideoCodecBuffer();
+    return player->pauseReadPacket();
 }
 
 extern "C" JNIEXPORT jint JNICALL
-Java_com_tans_tmediaplayer_player_tMediaPlayer_moveDecodedVideoFrameToBufferNative(
+Java_com_tans_tmediaplayer_player_tMediaPlayer_playReadPacketNative(
+        JNIEnv * env,
+        jobject j_player,
+        jlong native_player) {
+    auto *player = reinterpret_cast<tMediaPlayerContext *>(native_player);
+    return player->resumeReadPacket();
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_movePacketRefNative(
         JNIEnv * env,
         jobject j_player,
         jlong native_player,
-        jlong native_buffer) {
+        jlong native_packet) {
     auto *player = reinterpret_cast<tMediaPlayerContext *>(native_player);
-    auto *videoBuffer = reinterpret_cast<tMediaVideoBuffer *>(native_buffer);
-    return player->moveDecodedVideoFrameToBuffer(videoBuffer);
+    auto *pkt = reinterpret_cast<AVPacket *>(native_packet);
+    player->movePacketRef(pkt);
 }
 
 extern "C" JNIEXPORT jint JNICALL
-Java_com_tans_tmediaplayer_player_tMediaPlayer_decodeAudioNative(
+Java_com_tans_tmediaplayer_player_tMediaPlayer_seekToNative(
         JNIEnv * env,
         jobject j_player,
         jlong native_player,
-        jlong native_buffer) {
+        jlong target_pos_in_millis) {
     auto *player = reinterpret_cast<tMediaPlayerContext *>(native_player);
-    if (native_buffer != 0) {
-        auto *pkt = reinterpret_cast<AVPacket *>(native_buffer);
-        return player->decodeAudio(pkt);
-    } else {
-        return player->decodeAudio(nullptr);
+    return player->seekTo(target_pos_in_millis);
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_videoPacketSerialNative(
+        JNIEnv * env,
+        jobject j_player,
+        jlong native_player) {
+    auto *player = reinterpret_cast<tMediaPlayerContext *>(native_player);
+    return player->video_pkt_serial;
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_decodeVideoToBuffersNative(
+        JNIEnv * env,
+        jobject j_player,
+        jlong native_player,
+        jlongArray native_buffers,
+        jint buffer_count,
+        jlong master_clock_in_millis,
+        jlongArray j_descriptors) {
+    auto *player = reinterpret_cast<tMediaPlayerContext *>(native_player);
+    int count = buffer_count;
+    int slotCount = env->GetArrayLength(native_buffers);
+    int descriptorCount = (env->GetArrayLength(j_descriptors) - DECODE_BATCH_HEADER_SIZE) / VIDEO_FRAME_DESCRIPTOR_SIZE;
+    if (count > slotCount) {
+        count = slotCount;
+    }
+    if (count > descriptorCount) {
+        count = descriptorCount;
+    }
+    if (count > DECODE_MAX_BATCH_SIZE) {
+        count = DECODE_MAX_BATCH_SIZE;
+    }
+    if (count < 0) {
+        count = 0;
     }
+    jlong nativeBuffersLocal[DECODE_MAX_BATCH_SIZE];
+    tMediaVideoBuffer *buffers[DECODE_MAX_BATCH_SIZE];
+    env->GetLongArrayRegion(native_buffers, 0, count, nativeBuffersLocal);
+    for (int i = 0; i < count; i ++) {
+        buffers[i] = reinterpret_cast<tMediaVideoBuffer *>(nativeBuffersLocal[i]);
+    }
+    int64_t descriptors[DECODE_BATCH_HEADER_SIZE + DECODE_MAX_BATCH_SIZE * VIDEO_FRAME_DESCRIPTOR_SIZE];
+    auto result = player->decodeVideoToBuffers(buffers, count, master_clock_in_millis, descriptors);
+    env->SetLongArrayRegion(j_descriptors, 0, DECODE_BATCH_HEADER_SIZE + descriptors[0] * VIDEO_FRAME_DESCRIPTOR_SIZE, descriptors);
+    return result;
 }
 
-extern "C" JNIEXPORT void JNICALL
-Java_com_tans_tmediaplayer_player_tMediaPlayer_flushAudioCodecBufferNative(
+extern "C" JNIEXPORT jint JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_audioPacketSerialNative(
         JNIEnv * env,
         jobject j_player,
         jlong native_player) {
     auto *player = reinterpret_cast<tMediaPlayerContext *>(native_player);
-    player->flushAudioCodecBuffer();
+    return player->audio_pkt_serial;
 }
 
 extern "C" JNIEXPORT jint JNICALL
-Java_com_tans_tmediaplayer_player_tMediaPlayer_moveDecodedAudioFrameToBufferNative(
+Java_com_tans_tmediaplayer_player_tMediaPlayer_decodeAudioToBuffersNative(
         JNIEnv * env,
         jobject j_player,
         jlong native_player,
-        jlong native_buffer) {
+        jlongArray native_buffers,
+        jint buffer_count,
+        jlongArray j_descriptors) {
     auto *player = reinterpret_cast<tMediaPlayerContext *>(native_player);
-    auto *audioBuffer = reinterpret_cast<tMediaAudioBuffer *>(native_buffer);
-    return player->moveDecodedAudioFrameToBuffer(audioBuffer);
+    int count = buffer_count;
+    int slotCount = env->GetArrayLength(native_buffers);
+    int descriptorCount = (env->GetArrayLength(j_descriptors) - DECODE_BATCH_HEADER_SIZE) / AUDIO_FRAME_DESCRIPTOR_SIZE;
+    if (count > slotCount) {
+        count = slotCount;
+    }
+    if (count > descriptorCount) {
+        count = descriptorCount;
+    }
+    if (count > DECODE_MAX_BATCH_SIZE) {
+        count = DECODE_MAX_BATCH_SIZE;
+    }
+    if (count < 0) {
+        count = 0;
+    }
+    jlong nativeBuffersLocal[DECODE_MAX_BATCH_SIZE];
+    tMediaAudioBuffer *buffers[DECODE_MAX_BATCH_SIZE];
+    env->GetLongArrayRegion(native_buffers, 0, count, nativeBuffersLocal);
+    for (int i = 0; i < count; i ++) {
+        buffers[i] = reinterpret_cast<tMediaAudioBuffer *>(nativeBuffersLocal[i]);
+    }
+    int64_t descriptors[DECODE_BATCH_HEADER_SIZE + DECODE_MAX_BATCH_SIZE * AUDIO_FRAME_DESCRIPTOR_SIZE];
+    auto result = player->decodeAudioToBuffers(buffers, count, descriptors);
+    env->SetLongArrayRegion(j_descriptors, 0, DECODE_BATCH_HEADER_SIZE + descriptors[0] * AUDIO_FRAME_DESCRIPTOR_SIZE, descriptors);
+    return result;
 }
 
 extern "C" JNIEXPORT void JNICALL
@@ -429,6 +767,87 @@ Java_com_tans_tmediaplayer_player_tMediaPlayer_audioStreamMetadataNative(
 }
 // endregion
 
+// region Audio streams info
+extern "C" JNIEXPORT jint JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_audioStreamIdNative(
+        JNIEnv * env,
+        jobject j_player,
+        jlong native_player) {
+    auto *player = reinterpret_cast<tMediaPlayerContext *>(native_player);
+    return player->audio_stream == nullptr ? -1 : player->audio_stream->index;
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_audioStreamCountNative(
+        JNIEnv * env,
+        jobject j_player,
+        jlong native_player) {
+    auto *player = reinterpret_cast<tMediaPlayerContext *>(native_player);
+    return player->audioStreamCount;
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_audioStreamIdAtNative(
+        JNIEnv * env,
+        jobject j_player,
+        jlong native_player,
+        jint index) {
+    auto *player = reinterpret_cast<tMediaPlayerContext *>(native_player);
+    return player->audioStreams[index]->stream->index;
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_audioStreamCodecIdAtNative(
+        JNIEnv * env,
+        jobject j_player,
+        jlong native_player,
+        jint index) {
+    auto *player = reinterpret_cast<tMediaPlayerContext *>(native_player);
+    return player->audioStreams[index]->stream->codecpar->codec_id;
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_audioStreamChannelsAtNative(
+        JNIEnv * env,
+        jobject j_player,
+        jlong native_player,
+        jint index) {
+    auto *player = reinterpret_cast<tMediaPlayerContext *>(native_player);
+    return player->audioStreams[index]->stream->codecpar->ch_layout.nb_channels;
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_audioStreamSampleRateAtNative(
+        JNIEnv * env,
+        jobject j_player,
+        jlong native_player,
+        jint index) {
+    auto *player = reinterpret_cast<tMediaPlayerContext *>(native_player);
+    return player->audioStreams[index]->stream->codecpar->sample_rate;
+}
+
+extern "C" JNIEXPORT jobjectArray JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_audioStreamMetadataAtNative(
+        JNIEnv * env,
+        jobject j_player,
+        jlong native_player,
+        jint index) {
+    auto *player = reinterpret_cast<tMediaPlayerContext *>(native_player);
+    return readMetadata(env, &player->audioStreams[index]->streamMetadata);
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_switchAudioStreamNative(
+        JNIEnv * env,
+        jobject j_player,
+        jlong native_player,
+        jint stream_index,
+        jlong position_in_millis) {
+    auto *player = reinterpret_cast<tMediaPlayerContext *>(native_player);
+    return player->switchAudioStream(stream_index, position_in_millis);
+}
+// endregion
+
 // region Subtitle streams info
 extern "C" JNIEXPORT jint JNICALL
 Java_com_tans_tmediaplayer_player_tMediaPlayer_subtitleStreamCountNative(
@@ -528,7 +947,118 @@ Java_com_tans_tmediaplayer_player_tMediaPlayer_releasePacketNative(
 }
 // endregion
 
+// region Packet queue
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "MemoryLeak"
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_allocPacketQueueNative(
+        JNIEnv * env,
+        jobject j_player) {
+    auto queue = new tMediaPacketQueue;
+    if (!queue->prepare(PKT_QUEUE_CAPACITY)) {
+        queue->release();
+        return 0L;
+    }
+    return reinterpret_cast<jlong>(queue);
+}
+#pragma clang diagnostic pop
+
+extern "C" JNIEXPORT jint JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_getPacketQueueCountNative(
+        JNIEnv * env,
+        jobject j_player,
+        jlong native_queue) {
+    auto queue = reinterpret_cast<tMediaPacketQueue *>(native_queue);
+    return queue->count();
+}
+
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_getPacketQueueSizeInBytesNative(
+        JNIEnv * env,
+        jobject j_player,
+        jlong native_queue) {
+    auto queue = reinterpret_cast<tMediaPacketQueue *>(native_queue);
+    return queue->sizeInBytes.load();
+}
+
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_getPacketQueueDurationNative(
+        JNIEnv * env,
+        jobject j_player,
+        jlong native_queue) {
+    auto queue = reinterpret_cast<tMediaPacketQueue *>(native_queue);
+    return queue->duration.load();
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_getPacketQueueSerialNative(
+        JNIEnv * env,
+        jobject j_player,
+        jlong native_queue) {
+    auto queue = reinterpret_cast<tMediaPacketQueue *>(native_queue);
+    return queue->serial.load();
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_flushPacketQueueNative(
+        JNIEnv * env,
+        jobject j_player,
+        jlong native_queue) {
+    auto queue = reinterpret_cast<tMediaPacketQueue *>(native_queue);
+    queue->flush();
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_clearPacketQueueNative(
+        JNIEnv * env,
+        jobject j_player,
+        jlong native_queue) {
+    auto queue = reinterpret_cast<tMediaPacketQueue *>(native_queue);
+    queue->clear();
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_releasePacketQueueNative(
+        JNIEnv * env,
+        jobject j_player,
+        jlong native_queue) {
+    auto queue = reinterpret_cast<tMediaPacketQueue *>(native_queue);
+    queue->release();
+}
+// endregion
+
 // region VideoBuffer
+/**
+ * Copy plane to Java array with packed layout, only copy rows one by one when plane has stride padding.
+ */
+static void copyVideoPlaneToJava(
+        JNIEnv * env,
+        jbyteArray j_bytes,
+        tMediaVideoBuffer *buffer,
+        int plane,
+        int packedLineSize,
+        int rows,
+        int contentSize) {
+    uint8_t *src = buffer->planes[plane];
+    int srcLineSize = buffer->lineSizes[plane];
+    if (src == nullptr || packedLineSize <= 0 || env->GetArrayLength(j_bytes) < contentSize) {
+        return;
+    }
+    // Packed line size is aligned, never read over real row end or last row of plane.
+    int copyRows = FFMIN(FFMIN(rows, buffer->planeRows[plane]), contentSize / packedLineSize);
+    int copyRowBytes = FFMIN(packedLineSize, buffer->planeRowBytes[plane]);
+    if (srcLineSize == packedLineSize && copyRowBytes == packedLineSize) {
+        env->SetByteArrayRegion(j_bytes, 0, packedLineSize * copyRows, reinterpret_cast<const jbyte *>(src));
+        return;
+    }
+    auto dst = static_cast<uint8_t *>(env->GetPrimitiveArrayCritical(j_bytes, nullptr));
+    if (dst == nullptr) {
+        return;
+    }
+    av_image_copy_plane(dst, packedLineSize, src, srcLineSize, FFMIN(copyRowBytes, srcLineSize), copyRows);
+    env->ReleasePrimitiveArrayCritical(j_bytes, dst, 0);
+}
+
 #pragma clang diagnostic push
 #pragma ide diagnostic ignored "MemoryLeak"
 extern "C" JNIEXPORT jlong JNICALL
@@ -606,8 +1136,7 @@ Java_com_tans_tmediaplayer_player_tMediaPlayer_getVideoFrameRgbaBytesNative(
         jbyteArray j_bytes) {
     auto buffer = reinterpret_cast<tMediaVideoBuffer *>(buffer_l);
     if (buffer->type == Rgba) {
-        env->SetByteArrayRegion(j_bytes, 0, buffer->rgbaContentSize,
-                                reinterpret_cast<const jbyte *>(buffer->rgbaBuffer));
+        copyVideoPlaneToJava(env, j_bytes, buffer, 0, buffer->width * 4, buffer->height, buffer->rgbaContentSize);
     }
 }
 
@@ -617,7 +1146,7 @@ Java_com_tans_tmediaplayer_player_tMediaPlayer_getVideoFrameYSizeNative(
         jobject j_player,
         jlong buffer_l) {
     auto buffer = reinterpret_cast<tMediaVideoBuffer *>(buffer_l);
-    if (buffer->type == Nv12 || buffer->type == Nv21 || buffer->type == Yuv420p) {
+    if (buffer->type == Nv12 || buffer->type == Nv21 || buffer->type == Yuv420p || buffer->type == Yuv420p10 || buffer->type == P010) {
         return buffer->yContentSize;
     } else {
         return 0;
@@ -632,8 +1161,9 @@ Java_com_tans_tmediaplayer_player_tMediaPlayer_getVideoFrameYBytesNative(
         jbyteArray j_bytes) {
     auto buffer = reinterpret_cast<tMediaVideoBuffer *>(buffer_l);
     if (buffer->type == Nv12 || buffer->type == Nv21 || buffer->type == Yuv420p) {
-        env->SetByteArrayRegion(j_bytes, 0, buffer->yContentSize,
-                                reinterpret_cast<const jbyte *>(buffer->yBuffer));
+        copyVideoPlaneToJava(env, j_bytes, buffer, 0, buffer->width, buffer->height, buffer->yContentSize);
+    } else if (buffer->type == Yuv420p10 || buffer->type == P010) {
+        copyVideoPlaneToJava(env, j_bytes, buffer, 0, buffer->width * 2, buffer->height, buffer->yContentSize);
     }
 }
 
@@ -643,7 +1173,7 @@ Java_com_tans_tmediaplayer_player_tMediaPlayer_getVideoFrameUSizeNative(
         jobject j_player,
         jlong buffer_l) {
     auto buffer = reinterpret_cast<tMediaVideoBuffer *>(buffer_l);
-    if (buffer->type == Yuv420p) {
+    if (buffer->type == Yuv420p || buffer->type == Yuv420p10) {
         return buffer->uContentSize;
     } else {
         return 0;
@@ -658,8 +1188,9 @@ Java_com_tans_tmediaplayer_player_tMediaPlayer_getVideoFrameUBytesNative(
         jbyteArray j_bytes) {
     auto buffer = reinterpret_cast<tMediaVideoBuffer *>(buffer_l);
     if (buffer->type == Yuv420p) {
-        env->SetByteArrayRegion(j_bytes, 0, buffer->uContentSize,
-                                reinterpret_cast<const jbyte *>(buffer->uBuffer));
+        copyVideoPlaneToJava(env, j_bytes, buffer, 1, buffer->width / 2, buffer->height / 2, buffer->uContentSize);
+    } else if (buffer->type == Yuv420p10) {
+        copyVideoPlaneToJava(env, j_bytes, buffer, 1, buffer->width, buffer->height / 2, buffer->uContentSize);
     }
 }
 
@@ -669,7 +1200,7 @@ Java_com_tans_tmediaplayer_player_tMediaPlayer_getVideoFrameVSizeNative(
         jobject j_player,
         jlong buffer_l) {
     auto buffer = reinterpret_cast<tMediaVideoBuffer *>(buffer_l);
-    if (buffer->type == Yuv420p) {
+    if (buffer->type == Yuv420p || buffer->type == Yuv420p10) {
         return buffer->vContentSize;
     } else {
         return 0;
@@ -684,8 +1215,9 @@ Java_com_tans_tmediaplayer_player_tMediaPlayer_getVideoFrameVBytesNative(
         jbyteArray j_bytes) {
     auto buffer = reinterpret_cast<tMediaVideoBuffer *>(buffer_l);
     if (buffer->type == Yuv420p) {
-        env->SetByteArrayRegion(j_bytes, 0, buffer->vContentSize,
-                                reinterpret_cast<const jbyte *>(buffer->vBuffer));
+        copyVideoPlaneToJava(env, j_bytes, buffer, 2, buffer->width / 2, buffer->height / 2, buffer->vContentSize);
+    } else if (buffer->type == Yuv420p10) {
+        copyVideoPlaneToJava(env, j_bytes, buffer, 2, buffer->width, buffer->height / 2, buffer->vContentSize);
     }
 }
 
@@ -695,7 +1227,7 @@ Java_com_tans_tmediaplayer_player_tMediaPlayer_getVideoFrameUVSizeNative(
         jobject j_player,
         jlong buffer_l) {
     auto buffer = reinterpret_cast<tMediaVideoBuffer *>(buffer_l);
-    if (buffer->type == Nv12 || buffer->type == Nv21) {
+    if (buffer->type == Nv12 || buffer->type == Nv21 || buffer->type == P010) {
         return buffer->uvContentSize;
     } else {
         return 0;
@@ -710,8 +1242,9 @@ Java_com_tans_tmediaplayer_player_tMediaPlayer_getVideoFrameUVBytesNative(
         jbyteArray j_bytes) {
     auto buffer = reinterpret_cast<tMediaVideoBuffer *>(buffer_l);
     if (buffer->type == Nv12 || buffer->type == Nv21) {
-        env->SetByteArrayRegion(j_bytes, 0, buffer->uvContentSize,
-                                reinterpret_cast<const jbyte *>(buffer->uvBuffer));
+        copyVideoPlaneToJava(env, j_bytes, buffer, 1, buffer->width, buffer->height / 2, buffer->uvContentSize);
+    } else if (buffer->type == P010) {
+        copyVideoPlaneToJava(env, j_bytes, buffer, 1, buffer->width * 2, buffer->height / 2, buffer->uvContentSize);
     }
 }
 
@@ -721,22 +1254,89 @@ Java_com_tans_tmediaplayer_player_tMediaPlayer_releaseVideoBufferNative(
         jobject j_player,
         jlong native_buffer) {
     auto buffer = reinterpret_cast<tMediaVideoBuffer *>(native_buffer);
-    if (buffer->rgbaBuffer != nullptr) {
-        free(buffer->rgbaBuffer);
-    }
-    if (buffer->yBuffer != nullptr) {
-        free(buffer->yBuffer);
+    buffer->release();
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_unrefVideoBufferNative(
+        JNIEnv * env,
+        jobject j_player,
+        jlong native_buffer) {
+    auto buffer = reinterpret_cast<tMediaVideoBuffer *>(native_buffer);
+    buffer->unrefFrame();
+}
+
+extern "C" JNIEXPORT jobject JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_getVideoFramePlaneNative(
+        JNIEnv * env,
+        jobject j_player,
+        jlong native_buffer,
+        jint plane) {
+    auto buffer = reinterpret_cast<tMediaVideoBuffer *>(native_buffer);
+    int rows;
+    int packedLineSize;
+    switch (buffer->type) {
+        case Yuv420p:
+            if (plane > 2) {
+                return nullptr;
+            }
+            rows = plane == 0 ? buffer->height : buffer->height / 2;
+            packedLineSize = plane == 0 ? buffer->width : buffer->width / 2;
+            break;
+        case Nv12:
+        case Nv21:
+            if (plane > 1) {
+                return nullptr;
+            }
+            rows = plane == 0 ? buffer->height : buffer->height / 2;
+            packedLineSize = buffer->width;
+            break;
+        case Rgba:
+            if (plane > 0) {
+                return nullptr;
+            }
+            rows = buffer->height;
+            packedLineSize = buffer->width * 4;
+            break;
+        case Yuv420p10:
+            if (plane > 2) {
+                return nullptr;
+            }
+            rows = plane == 0 ? buffer->height : buffer->height / 2;
+            packedLineSize = plane == 0 ? buffer->width * 2 : buffer->width;
+            break;
+        case P010:
+            if (plane > 1) {
+                return nullptr;
+            }
+            rows = plane == 0 ? buffer->height : buffer->height / 2;
+            packedLineSize = buffer->width * 2;
+            break;
+        default:
+            return nullptr;
     }
-    if (buffer->uBuffer != nullptr) {
-        free(buffer->uBuffer);
+    if (plane < 0 || buffer->planes[plane] == nullptr || rows <= 0) {
+        return nullptr;
     }
-    if (buffer->vBuffer != nullptr) {
-        free(buffer->vBuffer);
+    int lineSize = buffer->lineSizes[plane];
+    // Row of texture is longer than plane stride, need packed copy.
+    if (lineSize < packedLineSize) {
+        return nullptr;
     }
-    if (buffer->uvBuffer != nullptr) {
-        free(buffer->uvBuffer);
+    return env->NewDirectByteBuffer(buffer->planes[plane], (jlong) lineSize * rows);
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_getVideoFrameLineSizeNative(
+        JNIEnv * env,
+        jobject j_player,
+        jlong native_buffer,
+        jint plane) {
+    auto buffer = reinterpret_cast<tMediaVideoBuffer *>(native_buffer);
+    if (plane < 0 || plane >= 3) {
+        return 0;
     }
-    free(buffer);
+    return buffer->lineSizes[plane];
 }
 
 // endregion
@@ -803,3 +1403,65 @@ Java_com_tans_tmediaplayer_player_tMediaPlayer_releaseAudioBufferNative(
     free(buffer);
 }
 //endregion
+
+// region Interrupt
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "MemoryLeak"
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_allocInterruptNative(
+        JNIEnv * env,
+        jobject j_player) {
+    auto interrupt = new tMediaInterruptContext;
+    return reinterpret_cast<jlong>(interrupt);
+}
+#pragma clang diagnostic pop
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_abortInterruptNative(
+        JNIEnv * env,
+        jobject j_player,
+        jlong native_interrupt) {
+    auto interrupt = reinterpret_cast<tMediaInterruptContext *>(native_interrupt);
+    interrupt->abort();
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_cancelInterruptNative(
+        JNIEnv * env,
+        jobject j_player,
+        jlong native_interrupt) {
+    auto interrupt = reinterpret_cast<tMediaInterruptContext *>(native_interrupt);
+    interrupt->cancel();
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_setInterruptTimeoutNative(
+        JNIEnv * env,
+        jobject j_player,
+        jlong native_interrupt,
+        jlong timeout_in_millis) {
+    auto interrupt = reinterpret_cast<tMediaInterruptContext *>(native_interrupt);
+    interrupt->setTimeout(timeout_in_millis);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_getInterruptStatsNative(
+        JNIEnv * env,
+        jobject j_player,
+        jlong native_interrupt,
+        jlongArray j_stats) {
+    auto interrupt = reinterpret_cast<tMediaInterruptContext *>(native_interrupt);
+    int64_t stats[INTERRUPT_STATS_SIZE];
+    interrupt->writeStats(stats);
+    env->SetLongArrayRegion(j_stats, 0, INTERRUPT_STATS_SIZE, stats);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_tans_tmediaplayer_player_tMediaPlayer_releaseInterruptNative(
+        JNIEnv * env,
+        jobject j_player,
+        jlong native_interrupt) {
+    auto interrupt = reinterpret_cast<tMediaInterruptContext *>(native_interrupt);
+    interrupt->release();
+}
+// endregion
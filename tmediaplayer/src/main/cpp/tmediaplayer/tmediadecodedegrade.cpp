@@ -0,0 +1,95 @@
+//
+// Created by pengcheng.tan on 2024/8/23.
+//
+#include "tmediadecodedegrade.h"
+#include "tmediaplayer.h"
+
+extern "C" {
+#include "libavutil/time.h"
+}
+
+static int64_t nowInMillis() {
+    return av_gettime_relative() / 1000;
+}
+
+static void changeLevel(tMediaDecodeDegrader *degrader, int newLevel, int64_t now) {
+    int oldLevel = degrader->level;
+    if (degrader->levelEnterTime > 0) {
+        degrader->timeAtLevel[oldLevel] += now - degrader->levelEnterTime;
+    }
+    degrader->levelEnterTime = now;
+    if (oldLevel != newLevel) {
+        degrader->level = newLevel;
+        degrader->dirty = true;
+        degrader->levelChanges ++;
+        LOGD("Video decode degrade level: %d -> %d", oldLevel, newLevel);
+    }
+}
+
+void tMediaDecodeDegrader::applyTo(AVCodecContext *ctx) {
+    if (!dirty || ctx == nullptr) {
+        return;
+    }
+    dirty = false;
+    int l = level;
+    ctx->skip_loop_filter = l >= 2 ? AVDISCARD_ALL : (l >= 1 ? AVDISCARD_NONREF : AVDISCARD_DEFAULT);
+    ctx->skip_idct = l >= 2 ? AVDISCARD_NONREF : AVDISCARD_DEFAULT;
+    ctx->skip_frame = l >= 4 ? AVDISCARD_NONKEY : (l >= 3 ? AVDISCARD_NONREF : AVDISCARD_DEFAULT);
+}
+
+void tMediaDecodeDegrader::onFrameDecoded(int64_t framePtsInMillis, int64_t masterClockInMillis) {
+    int64_t now = nowInMillis();
+    if (levelEnterTime <= 0) {
+        levelEnterTime = now;
+    }
+    if (masterClockInMillis < 0) {
+        return;
+    }
+    int64_t lag = masterClockInMillis - framePtsInMillis;
+    int l = level;
+    if (lag > DEGRADE_ESCALATE_LAG_IN_MILLIS) {
+        caughtUpSince = 0;
+        lateFrames ++;
+        if (lateFrames >= DEGRADE_ESCALATE_LATE_FRAMES && l < DEGRADE_LEVEL_COUNT - 1 &&
+            now - lastEscalateTime >= DEGRADE_ESCALATE_INTERVAL_IN_MILLIS) {
+            lateFrames = 0;
+            lastEscalateTime = now;
+            changeLevel(this, l + 1, now);
+        }
+    } else {
+        lateFrames = 0;
+        if (lag < DEGRADE_RECOVER_LAG_IN_MILLIS && l > 0) {
+            if (caughtUpSince <= 0) {
+                caughtUpSince = now;
+            } else if (now - caughtUpSince >= DEGRADE_RECOVER_HOLD_IN_MILLIS) {
+                caughtUpSince = now;
+                changeLevel(this, l - 1, now);
+            }
+        } else {
+            caughtUpSince = 0;
+        }
+    }
+}
+
+void tMediaDecodeDegrader::reset() {
+    changeLevel(this, 0, nowInMillis());
+    // Decoder ctx may be new one.
+    dirty = true;
+    lateFrames = 0;
+    caughtUpSince = 0;
+    lastEscalateTime = 0;
+}
+
+void tMediaDecodeDegrader::writeStats(int64_t *target) {
+    int l = level;
+    target[0] = l;
+    target[1] = levelChanges;
+    for (int i = 0; i < DEGRADE_LEVEL_COUNT; i ++) {
+        target[2 + i] = timeAtLevel[i];
+    }
+    // Current level's time not yet accumulated.
+    int64_t enterTime = levelEnterTime;
+    if (enterTime > 0) {
+        target[2 + l] += nowInMillis() - enterTime;
+    }
+}
@@ -0,0 +1,128 @@
+//
+// Created by pengcheng.tan on 2024/8/23.
+//
+#include <thread>
+#include "tmediadecodethreads.h"
+#include "tmediaplayer.h"
+
+static int cpuCores() {
+    int cores = (int) std::thread::hardware_concurrency();
+    if (cores <= 0) {
+        cores = 1;
+    }
+    if (cores > DECODE_MAX_THREAD_COUNT) {
+        cores = DECODE_MAX_THREAD_COUNT;
+    }
+    return cores;
+}
+
+static int autoThreadCount(int width, int height) {
+    int pixels = width * height;
+    int count;
+    if (pixels <= 640 * 480) {
+        count = 2;
+    } else if (pixels <= 1280 * 720) {
+        count = 4;
+    } else {
+        count = DECODE_MAX_THREAD_COUNT;
+    }
+    int cores = cpuCores();
+    return count > cores ? cores : count;
+}
+
+void tMediaDecodeThreadPolicy::setRequest(tMediaDecodeThreadType type, int count) {
+    this->requestType = type;
+    if (count < 0) {
+        count = 0;
+    }
+    if (count > DECODE_MAX_THREAD_COUNT) {
+        count = DECODE_MAX_THREAD_COUNT;
+    }
+    this->requestCount = count;
+}
+
+void tMediaDecodeThreadPolicy::configure(AVCodecContext *ctx, const AVCodec *codec, bool isAttachPic, int threadCount) {
+    int type;
+    switch (requestType) {
+        case DecodeThreadFrame:
+            type = FF_THREAD_FRAME;
+            break;
+        case DecodeThreadSlice:
+            type = FF_THREAD_SLICE;
+            break;
+        default:
+            if (codec->capabilities & AV_CODEC_CAP_FRAME_THREADS) {
+                type = FF_THREAD_FRAME;
+            } else if (codec->capabilities & AV_CODEC_CAP_SLICE_THREADS) {
+                type = FF_THREAD_SLICE;
+            } else {
+                type = 0;
+            }
+            break;
+    }
+    int count = threadCount;
+    if (count <= 0) {
+        count = requestCount;
+    }
+    if (count <= 0) {
+        count = autoThreadCount(ctx->width, ctx->height);
+    }
+    // Attached picture only has one frame.
+    if (isAttachPic || type == 0) {
+        count = 1;
+    }
+    ctx->thread_type = type;
+    ctx->thread_count = count;
+    if (count > 1) {
+        appliedType = type == FF_THREAD_FRAME ? DecodeThreadFrame : DecodeThreadSlice;
+    } else {
+        appliedType = -1;
+    }
+    appliedCount = count;
+    LOGD("Video decoder threads: type=%d, count=%d", type, count);
+}
+
+bool tMediaDecodeThreadPolicy::onFrameDecoded(int64_t costInMicros, double fps) {
+    decodedFrames ++;
+    decodeCostSum += costInMicros;
+    if (costInMicros > maxDecodeCost) {
+        maxDecodeCost = costInMicros;
+    }
+    if (retuneChecked || requestType != DecodeThreadAuto || requestCount > 0 || appliedType < 0) {
+        return false;
+    }
+    int64_t frames = decodedFrames;
+    if (frames < DECODE_RETUNE_WINDOW_FRAMES) {
+        return false;
+    }
+    retuneChecked = true;
+    if (fps <= 0.0) {
+        fps = 30.0;
+    }
+    int64_t avgCost = decodeCostSum / frames;
+    auto frameBudget = (int64_t) (1000000.0 / fps);
+    int cores = cpuCores();
+    // Keep a quarter of frame interval for conversion and rendering.
+    if (avgCost > frameBudget * 3 / 4 && appliedCount < cores) {
+        LOGD("Video decode cost %lld us, frame budget %lld us, retune thread count %d -> %d", (long long) avgCost, (long long) frameBudget, appliedCount.load(), cores);
+        retuneThreadCount = cores;
+        return true;
+    }
+    return false;
+}
+
+void tMediaDecodeThreadPolicy::resetCost() {
+    decodedFrames = 0;
+    decodeCostSum = 0;
+    maxDecodeCost = 0;
+}
+
+void tMediaDecodeThreadPolicy::writeStats(int64_t *target) {
+    int64_t frames = decodedFrames;
+    target[0] = appliedType;
+    target[1] = appliedCount;
+    target[2] = frames;
+    target[3] = frames > 0 ? decodeCostSum / frames : 0;
+    target[4] = maxDecodeCost;
+    target[5] = retuneCount;
+}
@@ -0,0 +1,143 @@
+//
+// Created by pengcheng.tan on 2024/8/29.
+//
+#include "tmediaframestep.h"
+#include "tmediaplayer.h"
+#include "tmediapixconvert.h"
+
+void tMediaFrameStepCache::push(AVFrame *src) {
+    if (src->flags & AV_FRAME_FLAG_KEY) {
+        lastKeyPts = src->pts;
+    }
+    int64_t srcBytes = pixFrameBufferBytes(src);
+    // Drop oldest frames, keep at least the previous frame, so a re-decode always has the frame before the showing one.
+    while (count >= FRAME_STEP_MAX_CACHED_FRAMES || (count > 1 && bytes + srcBytes > maxBytes)) {
+        bytes -= frameBytes[head];
+        frameBytes[head] = 0;
+        av_frame_free(&frames[head]);
+        head = (head + 1) % FRAME_STEP_MAX_CACHED_FRAMES;
+        count --;
+    }
+    auto cached = av_frame_alloc();
+    if (cached == nullptr) {
+        LOGE("Alloc frame step cache frame fail.");
+        return;
+    }
+    if (av_frame_ref(cached, src) < 0) {
+        LOGE("Ref frame step cache frame fail.");
+        av_frame_free(&cached);
+        return;
+    }
+    int pos = (head + count) % FRAME_STEP_MAX_CACHED_FRAMES;
+    frames[pos] = cached;
+    frameBytes[pos] = srcBytes;
+    count ++;
+    bytes += srcBytes;
+    stats.cachedFrames = count;
+    stats.cachedBytes = bytes;
+}
+
+void tMediaFrameStepCache::onLiveFrame(AVFrame *src) {
+    if (enabled) {
+        push(src);
+    } else if (src->flags & AV_FRAME_FLAG_KEY) {
+        lastKeyPts = src->pts;
+    }
+}
+
+void tMediaFrameStepCache::trimIfDisabled() {
+    if (enabled || count <= 0 || isReplaying() || isRedecoding() || pendingRedecodeUntilPts != AV_NOPTS_VALUE) {
+        return;
+    }
+    dropFrames();
+}
+
+bool tMediaFrameStepCache::beginReplay(int64_t beforePts) {
+    for (int i = count - 1; i >= 0; i --) {
+        auto f = frames[(head + i) % FRAME_STEP_MAX_CACHED_FRAMES];
+        if (f->pts < beforePts) {
+            replayPos = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool tMediaFrameStepCache::isReplaying() const {
+    return replayPos >= 0;
+}
+
+bool tMediaFrameStepCache::popReplay(AVFrame *target) {
+    if (replayPos < 0) {
+        return false;
+    }
+    if (replayPos >= count) {
+        replayPos = -1;
+        return false;
+    }
+    av_frame_unref(target);
+    int ret = av_frame_ref(target, frames[(head + replayPos) % FRAME_STEP_MAX_CACHED_FRAMES]);
+    replayPos ++;
+    if (ret < 0) {
+        LOGE("Ref frame step replay frame fail: %d", ret);
+        replayPos = -1;
+        return false;
+    }
+    stats.replayedFrames ++;
+    return true;
+}
+
+bool tMediaFrameStepCache::isRedecoding() const {
+    return redecodeUntilPts != AV_NOPTS_VALUE;
+}
+
+bool tMediaFrameStepCache::onRedecodedFrame(AVFrame *src) {
+    push(src);
+    stats.redecodedFrames ++;
+    if (src->pts == AV_NOPTS_VALUE || src->pts < redecodeUntilPts) {
+        return false;
+    }
+    int64_t untilPts = redecodeUntilPts;
+    redecodeUntilPts = AV_NOPTS_VALUE;
+    if (!beginReplay(untilPts)) {
+        // No frame before showing frame, show it again.
+        replayPos = count - 1;
+    }
+    return true;
+}
+
+void tMediaFrameStepCache::onSerialChanged() {
+    clear();
+    redecodeUntilPts = pendingRedecodeUntilPts;
+    pendingRedecodeUntilPts = AV_NOPTS_VALUE;
+}
+
+void tMediaFrameStepCache::clear() {
+    dropFrames();
+    replayPos = -1;
+    liveEof = false;
+    lastKeyPts = AV_NOPTS_VALUE;
+    redecodeUntilPts = AV_NOPTS_VALUE;
+}
+
+void tMediaFrameStepCache::dropFrames() {
+    for (int i = 0; i < count; i ++) {
+        int pos = (head + i) % FRAME_STEP_MAX_CACHED_FRAMES;
+        av_frame_free(&frames[pos]);
+        frameBytes[pos] = 0;
+    }
+    head = 0;
+    count = 0;
+    bytes = 0;
+    stats.cachedFrames = 0;
+    stats.cachedBytes = 0;
+}
+
+void tMediaFrameStepCache::writeStats(int64_t *target) {
+    target[0] = stats.cachedFrames.load();
+    target[1] = stats.cachedBytes.load();
+    target[2] = stats.cacheHits.load();
+    target[3] = stats.cacheMisses.load();
+    target[4] = stats.redecodedFrames.load();
+    target[5] = stats.replayedFrames.load();
+}
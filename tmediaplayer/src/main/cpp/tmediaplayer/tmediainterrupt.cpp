@@ -0,0 +1,112 @@
+//
+// Created by pengcheng.tan on 2024/8/20.
+//
+#include "tmediainterrupt.h"
+#include "tmediaplayer.h"
+
+extern "C" {
+#include "libavutil/time.h"
+}
+
+static const char *blockingOpName(int op) {
+    switch (op) {
+        case BlockingOpOpenInput:
+            return "open_input";
+        case BlockingOpFindStreamInfo:
+            return "find_stream_info";
+        case BlockingOpReadFrame:
+            return "read_frame";
+        case BlockingOpSeek:
+            return "seek";
+        default:
+            return "none";
+    }
+}
+
+static void updateMax(std::atomic<int64_t> &target, int64_t value) {
+    int64_t old = target.load();
+    while (value > old && !target.compare_exchange_weak(old, value)) {}
+}
+
+int interruptCallback(void *opaque) {
+    auto interrupt = static_cast<tMediaInterruptContext *>(opaque);
+    return interrupt->isInterrupted() ? 1 : 0;
+}
+
+void tMediaInterruptContext::attach(AVFormatContext *format_ctx) {
+    format_ctx->interrupt_callback.callback = interruptCallback;
+    format_ctx->interrupt_callback.opaque = this;
+}
+
+void tMediaInterruptContext::beginOp(tMediaBlockingOp op) {
+    int64_t now = av_gettime_relative();
+    int64_t timeout = timeoutInMicros;
+    opStartTime = now;
+    opDeadline = timeout > 0 ? now + timeout : 0;
+    opGeneration = cancelGeneration.load();
+    opInterrupted = false;
+    currentOp = op;
+}
+
+int tMediaInterruptContext::endOp(int ret) {
+    int op = currentOp.exchange(BlockingOpNone);
+    if (op == BlockingOpNone) {
+        return ret;
+    }
+    int64_t cost = av_gettime_relative() - opStartTime;
+    updateMax(maxBlockingCostInMicros, cost);
+    if (ret == AVERROR_EXIT) {
+        interruptCount ++;
+        lastInterruptedOp = op;
+        lastInterruptedCostInMicros = cost;
+        updateMax(maxInterruptedCostInMicros, cost);
+        LOGE("Blocking %s interrupted after %lldus", blockingOpName(op), (long long) cost);
+    }
+    return ret;
+}
+
+bool tMediaInterruptContext::isInterrupted() {
+    bool interrupted;
+    if (abortRequest) {
+        interrupted = true;
+    } else if (currentOp == BlockingOpNone) {
+        return false;
+    } else if (opGeneration != cancelGeneration) {
+        interrupted = true;
+    } else {
+        int64_t deadline = opDeadline;
+        interrupted = deadline > 0 && av_gettime_relative() > deadline;
+    }
+    if (interrupted && currentOp != BlockingOpNone) {
+        opInterrupted = true;
+    }
+    return interrupted;
+}
+
+bool tMediaInterruptContext::isLastOpInterrupted() {
+    return opInterrupted;
+}
+
+void tMediaInterruptContext::abort() {
+    abortRequest = true;
+}
+
+void tMediaInterruptContext::cancel() {
+    cancelGeneration ++;
+}
+
+void tMediaInterruptContext::setTimeout(int64_t timeoutInMillis) {
+    timeoutInMicros = timeoutInMillis > 0 ? timeoutInMillis * 1000L : 0L;
+}
+
+void tMediaInterruptContext::writeStats(int64_t *target) {
+    target[0] = interruptCount.load();
+    target[1] = lastInterruptedOp.load();
+    target[2] = lastInterruptedCostInMicros.load();
+    target[3] = maxInterruptedCostInMicros.load();
+    target[4] = maxBlockingCostInMicros.load();
+}
+
+void tMediaInterruptContext::release() {
+    delete this;
+}
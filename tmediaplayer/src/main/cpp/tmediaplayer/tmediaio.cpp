@@ -0,0 +1,555 @@
+//
+// Created by pengcheng.tan on 2024/8/14.
+//
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <cerrno>
+#include "tmediaio.h"
+#include "tmediaplayer.h"
+
+extern "C" {
+#include "libavutil/time.h"
+}
+
+static int ioReadPacket(void *opaque, uint8_t *buf, int bufSize) {
+    auto io = static_cast<tMediaIOContext *>(opaque);
+    return io->read(buf, bufSize);
+}
+
+static int64_t ioSeek(void *opaque, int64_t offset, int whence) {
+    auto io = static_cast<tMediaIOContext *>(opaque);
+    return io->seek(offset, whence);
+}
+
+bool isLocalFilePath(const char *file) {
+    if (file == nullptr) {
+        return false;
+    }
+    if (strncmp(file, "file://", 7) == 0) {
+        return true;
+    }
+    return strstr(file, "://") == nullptr;
+}
+
+bool tMediaIOContext::prepare(const char *file, tMediaIOMode ioMode, int64_t readAheadBufferSize) {
+    const char *path = file;
+    if (strncmp(path, "file://", 7) == 0) {
+        path = path + 7;
+    }
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        LOGE("Custom io open file fail: %d", errno);
+        return false;
+    }
+    struct stat st {};
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        LOGE("Custom io get file size fail: %d", errno);
+        return false;
+    }
+    this->fileSize = st.st_size;
+    this->mode = ioMode;
+
+    if (mode == IOMmap) {
+        // 32 bits process may not have enough address space for big file.
+        if ((uint64_t) fileSize <= (uint64_t) SIZE_MAX) {
+            void *data = mmap(nullptr, (size_t) fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+            stats.readSyscalls ++;
+            if (data != MAP_FAILED) {
+                mappedData = static_cast<uint8_t *>(data);
+                madvise(mappedData, (size_t) fileSize, MADV_SEQUENTIAL);
+                stats.readSyscalls ++;
+            }
+        }
+        if (mappedData == nullptr) {
+            LOGE("Mmap file fail: %d, fallback to read ahead.", errno);
+            mode = IOReadAhead;
+        }
+    }
+
+    if (mode == IOReadAhead) {
+        ringCapacity = readAheadBufferSize;
+        if (ringCapacity < IO_READ_AHEAD_MIN_BUFFER_SIZE) {
+            ringCapacity = IO_READ_AHEAD_MIN_BUFFER_SIZE;
+        }
+        ringBuffer = static_cast<uint8_t *>(malloc(ringCapacity));
+        if (ringBuffer == nullptr) {
+            LOGE("Alloc read ahead buffer fail.");
+            return false;
+        }
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        readAheadThread = new std::thread(&tMediaIOContext::readAheadLoop, this);
+    }
+
+    if (mode == IOUringRead) {
+        uring = new tMediaIOUring;
+        if (!isIOUringSupported() || !uring->setup(IO_URING_QUEUE_DEPTH)) {
+            LOGE("io_uring unavailable, fallback to async read.");
+            delete uring;
+            uring = nullptr;
+            mode = IOAsyncRead;
+        }
+    }
+
+    if (mode == IOAsyncRead || mode == IOUringRead) {
+        blockCount = (int) (readAheadBufferSize / IO_ASYNC_BLOCK_SIZE);
+        if (blockCount < IO_ASYNC_MIN_BLOCK_COUNT) {
+            blockCount = IO_ASYNC_MIN_BLOCK_COUNT;
+        }
+        blocks = new tMediaIOBlock[blockCount];
+        for (int i = 0; i < blockCount; i ++) {
+            blocks[i].data = static_cast<uint8_t *>(malloc(IO_ASYNC_BLOCK_SIZE));
+            if (blocks[i].data == nullptr) {
+                LOGE("Alloc async read block fail.");
+                return false;
+            }
+        }
+        // Random access, kernel read ahead is useless.
+        posix_fadvise(fd, 0, 0, POSIX_FADV_RANDOM);
+        if (mode == IOUringRead) {
+            asyncWorkers = new std::thread*[1];
+            asyncWorkers[0] = new std::thread(&tMediaIOContext::uringLoop, this);
+            asyncWorkerCount = 1;
+        } else {
+            asyncWorkers = new std::thread*[IO_ASYNC_WORKER_COUNT];
+            for (int i = 0; i < IO_ASYNC_WORKER_COUNT; i ++) {
+                asyncWorkers[i] = new std::thread(&tMediaIOContext::asyncWorkerLoop, this);
+                asyncWorkerCount ++;
+            }
+        }
+    }
+
+    auto avioBuffer = static_cast<uint8_t *>(av_malloc(IO_AVIO_BUFFER_SIZE));
+    if (avioBuffer == nullptr) {
+        LOGE("Alloc avio buffer fail.");
+        return false;
+    }
+    avio_ctx = avio_alloc_context(avioBuffer, IO_AVIO_BUFFER_SIZE, 0, this, ioReadPacket, nullptr, ioSeek);
+    if (avio_ctx == nullptr) {
+        av_free(avioBuffer);
+        LOGE("Alloc avio context fail.");
+        return false;
+    }
+    LOGD("Prepare custom io success, mode=%d, fileSize=%lld, readAheadBufferSize=%lld, blockCount=%d", mode, (long long) fileSize, (long long) ringCapacity, blockCount);
+    return true;
+}
+
+int tMediaIOContext::read(uint8_t *buf, int bufSize) {
+    if (position >= fileSize) {
+        return AVERROR_EOF;
+    }
+    if (mode == IOMmap) {
+        int64_t size = fileSize - position;
+        if (size > bufSize) {
+            size = bufSize;
+        }
+        if (position + size > willNeedEnd || position < willNeedEnd - 2 * IO_MMAP_WILLNEED_WINDOW_SIZE) {
+            // Align to page size.
+            int64_t adviseStart = position & ~((int64_t) getpagesize() - 1);
+            int64_t adviseSize = IO_MMAP_WILLNEED_WINDOW_SIZE;
+            if (adviseStart + adviseSize > fileSize) {
+                adviseSize = fileSize - adviseStart;
+            }
+            madvise(mappedData + adviseStart, (size_t) adviseSize, MADV_WILLNEED);
+            stats.readSyscalls ++;
+            willNeedEnd = adviseStart + adviseSize;
+        }
+        // Page fault stall the copy.
+        int64_t start = av_gettime_relative();
+        memcpy(buf, mappedData + position, (size_t) size);
+        stats.stallTimeInMicros += av_gettime_relative() - start;
+        position += size;
+        stats.bytesRead += size;
+        return (int) size;
+    }
+    if (mode == IOAsyncRead || mode == IOUringRead) {
+        return readAsync(buf, bufSize);
+    }
+
+    std::unique_lock<std::mutex> lk(readAheadLock);
+    if (position < windowStart || position > windowStart + windowSize) {
+        // Window moved, read ahead thread restart from new position.
+        windowStart = position;
+        windowSize = 0;
+        windowGeneration ++;
+        readAheadEof = false;
+        readAheadError = false;
+        readAheadCond.notify_all();
+    }
+    int64_t stallStart = -1;
+    while (true) {
+        // Drop consumed data.
+        int64_t skip = position - windowStart;
+        if (skip > 0) {
+            ringHead = (ringHead + skip) % ringCapacity;
+            windowStart += skip;
+            windowSize -= skip;
+        }
+        if (windowSize > 0) {
+            break;
+        }
+        if (readAheadError) {
+            LOGE("Read ahead fail.");
+            return AVERROR(EIO);
+        }
+        if (readAheadEof) {
+            return AVERROR_EOF;
+        }
+        if (isInterrupted()) {
+            if (stallStart >= 0) {
+                stats.stallTimeInMicros += av_gettime_relative() - stallStart;
+            }
+            return AVERROR_EXIT;
+        }
+        if (stallStart < 0) {
+            stallStart = av_gettime_relative();
+        }
+        readAheadCond.wait_for(lk, std::chrono::milliseconds(IO_INTERRUPT_CHECK_INTERVAL_IN_MILLIS));
+    }
+    if (stallStart >= 0) {
+        stats.stallTimeInMicros += av_gettime_relative() - stallStart;
+    }
+    int64_t size = windowSize;
+    if (size > bufSize) {
+        size = bufSize;
+    }
+    int64_t firstPart = ringCapacity - ringHead;
+    if (firstPart > size) {
+        firstPart = size;
+    }
+    memcpy(buf, ringBuffer + ringHead, (size_t) firstPart);
+    if (size > firstPart) {
+        memcpy(buf + firstPart, ringBuffer, (size_t) (size - firstPart));
+    }
+    ringHead = (ringHead + size) % ringCapacity;
+    windowStart += size;
+    windowSize -= size;
+    position += size;
+    stats.bytesRead += size;
+    // Space freed.
+    readAheadCond.notify_all();
+    return (int) size;
+}
+
+int64_t tMediaIOContext::seek(int64_t offset, int whence) {
+    if (whence & AVSEEK_SIZE) {
+        return fileSize;
+    }
+    int64_t target;
+    switch (whence & ~AVSEEK_FORCE) {
+        case SEEK_SET:
+            target = offset;
+            break;
+        case SEEK_CUR:
+            target = position + offset;
+            break;
+        case SEEK_END:
+            target = fileSize + offset;
+            break;
+        default:
+            return AVERROR(EINVAL);
+    }
+    if (target < 0) {
+        return AVERROR(EINVAL);
+    }
+    if (target != position) {
+        stats.seekCount ++;
+    }
+    // Read ahead window is updated by next read().
+    position = target;
+    return position;
+}
+
+bool tMediaIOContext::isInterrupted() {
+    return interrupt_cb != nullptr && interrupt_cb->callback != nullptr && interrupt_cb->callback(interrupt_cb->opaque);
+}
+
+void tMediaIOContext::readAheadLoop() {
+    std::unique_lock<std::mutex> lk(readAheadLock);
+    while (!stopReadAhead) {
+        int64_t fillPos = windowStart + windowSize;
+        int64_t freeSize = ringCapacity - windowSize;
+        if (freeSize <= 0 || readAheadEof || readAheadError || fillPos >= fileSize) {
+            if (fillPos >= fileSize) {
+                readAheadEof = true;
+                readAheadCond.notify_all();
+            }
+            readAheadCond.wait(lk);
+            continue;
+        }
+        int64_t index = (ringHead + windowSize) % ringCapacity;
+        int64_t size = ringCapacity - index;
+        if (size > freeSize) {
+            size = freeSize;
+        }
+        if (size > IO_READ_AHEAD_CHUNK_SIZE) {
+            size = IO_READ_AHEAD_CHUNK_SIZE;
+        }
+        int generation = windowGeneration;
+        lk.unlock();
+        // Only this thread writes free part of ring buffer, no lock needed.
+        // pread64() for big files on 32 bits abi.
+        ssize_t ret = pread64(fd, ringBuffer + index, (size_t) size, fillPos);
+        stats.readSyscalls ++;
+        lk.lock();
+        if (generation != windowGeneration) {
+            continue;
+        }
+        if (ret > 0) {
+            windowSize += ret;
+        } else if (ret == 0) {
+            readAheadEof = true;
+        } else if (errno != EINTR) {
+            readAheadError = true;
+        }
+        readAheadCond.notify_all();
+    }
+}
+
+tMediaIOBlock *tMediaIOContext::requestBlock(int64_t blockIndex, tMediaIOBlock *keep) {
+    tMediaIOBlock *victim = nullptr;
+    for (int i = 0; i < blockCount; i ++) {
+        auto b = blocks + i;
+        if (b->index == blockIndex && b->state != IOBlockEmpty) {
+            if (b->state == IOBlockFail) {
+                // Retry.
+                b->state = IOBlockPending;
+                readAheadCond.notify_all();
+            }
+            b->lastUsed = ++ blockUseCounter;
+            return b;
+        }
+        if (b->state == IOBlockEmpty) {
+            if (victim == nullptr || victim->state != IOBlockEmpty) {
+                victim = b;
+            }
+        } else if (b != keep && (b->state == IOBlockReady || b->state == IOBlockFail) &&
+                   (victim == nullptr || (victim->state != IOBlockEmpty && b->lastUsed < victim->lastUsed))) {
+            victim = b;
+        }
+    }
+    if (victim != nullptr) {
+        victim->index = blockIndex;
+        victim->state = IOBlockPending;
+        victim->size = 0;
+        victim->lastUsed = ++ blockUseCounter;
+        readAheadCond.notify_all();
+    }
+    return victim;
+}
+
+int tMediaIOContext::readAsync(uint8_t *buf, int bufSize) {
+    std::unique_lock<std::mutex> lk(readAheadLock);
+    int64_t blockIndex = position / IO_ASYNC_BLOCK_SIZE;
+    int64_t stallStart = -1;
+    tMediaIOBlock *block = nullptr;
+    while (true) {
+        if (block == nullptr || block->index != blockIndex) {
+            block = requestBlock(blockIndex, nullptr);
+            if (block != nullptr) {
+                // Keep next blocks in flight, demuxer read them soon.
+                int64_t lastBlockIndex = (fileSize - 1) / IO_ASYNC_BLOCK_SIZE;
+                for (int i = 1; i <= IO_ASYNC_PREFETCH_BLOCK_COUNT && blockIndex + i <= lastBlockIndex; i ++) {
+                    if (requestBlock(blockIndex + i, block) == nullptr) {
+                        break;
+                    }
+                }
+            }
+        }
+        if (block != nullptr && block->index == blockIndex) {
+            if (block->state == IOBlockReady) {
+                break;
+            }
+            if (block->state == IOBlockFail) {
+                block->state = IOBlockEmpty;
+                LOGE("Async read block fail: %lld", (long long) blockIndex);
+                return AVERROR(EIO);
+            }
+        }
+        if (isInterrupted()) {
+            if (stallStart >= 0) {
+                stats.stallTimeInMicros += av_gettime_relative() - stallStart;
+            }
+            return AVERROR_EXIT;
+        }
+        if (stallStart < 0) {
+            stallStart = av_gettime_relative();
+        }
+        readAheadCond.wait_for(lk, std::chrono::milliseconds(IO_INTERRUPT_CHECK_INTERVAL_IN_MILLIS));
+    }
+    if (stallStart >= 0) {
+        stats.stallTimeInMicros += av_gettime_relative() - stallStart;
+    }
+    int64_t offset = position - blockIndex * IO_ASYNC_BLOCK_SIZE;
+    int64_t size = block->size - offset;
+    if (size <= 0) {
+        return AVERROR_EOF;
+    }
+    if (size > bufSize) {
+        size = bufSize;
+    }
+    memcpy(buf, block->data + offset, (size_t) size);
+    position += size;
+    stats.bytesRead += size;
+    return (int) size;
+}
+
+void tMediaIOContext::asyncWorkerLoop() {
+    std::unique_lock<std::mutex> lk(readAheadLock);
+    while (!stopReadAhead) {
+        tMediaIOBlock *block = nullptr;
+        for (int i = 0; i < blockCount; i ++) {
+            auto b = blocks + i;
+            if (b->state == IOBlockPending && (block == nullptr || b->lastUsed < block->lastUsed)) {
+                block = b;
+            }
+        }
+        if (block == nullptr) {
+            readAheadCond.wait(lk);
+            continue;
+        }
+        block->state = IOBlockReading;
+        int64_t offset = block->index * IO_ASYNC_BLOCK_SIZE;
+        lk.unlock();
+        // Reading block is never evicted, no lock needed.
+        ssize_t ret;
+        do {
+            ret = pread64(fd, block->data, IO_ASYNC_BLOCK_SIZE, offset);
+        } while (ret < 0 && errno == EINTR);
+        stats.readSyscalls ++;
+        lk.lock();
+        if (ret >= 0) {
+            block->size = ret;
+            block->state = IOBlockReady;
+        } else {
+            block->size = 0;
+            block->state = IOBlockFail;
+        }
+        readAheadCond.notify_all();
+    }
+}
+
+void tMediaIOContext::uringLoop() {
+    std::unique_lock<std::mutex> lk(readAheadLock);
+    int inFlight = 0;
+    // In flight reads write to blocks, wait them done before stop.
+    while (!stopReadAhead || inFlight > 0) {
+        while (!stopReadAhead) {
+            tMediaIOBlock *block = nullptr;
+            for (int i = 0; i < blockCount; i ++) {
+                auto b = blocks + i;
+                if (b->state == IOBlockPending && (block == nullptr || b->lastUsed < block->lastUsed)) {
+                    block = b;
+                }
+            }
+            if (block == nullptr || !uring->queueRead(fd, block->data, IO_ASYNC_BLOCK_SIZE, block->index * IO_ASYNC_BLOCK_SIZE, (uint64_t) (block - blocks))) {
+                break;
+            }
+            block->state = IOBlockReading;
+            inFlight ++;
+        }
+        if (inFlight <= 0) {
+            readAheadCond.wait(lk);
+            continue;
+        }
+        lk.unlock();
+        // Reading blocks are never evicted, no lock needed. New pending blocks are queued after a read done.
+        int ret = uring->submitAndWait(1);
+        stats.readSyscalls ++;
+        lk.lock();
+        if (ret < 0) {
+            LOGE("io_uring enter fail: %d", ret);
+        }
+        uint64_t index;
+        int res;
+        int reaped = 0;
+        while (uring->popCompletion(&index, &res)) {
+            auto block = blocks + index;
+            if (res >= 0) {
+                block->size = res;
+                block->state = IOBlockReady;
+            } else if (res == -EINTR || res == -EAGAIN) {
+                block->state = IOBlockPending;
+            } else {
+                block->size = 0;
+                block->state = IOBlockFail;
+            }
+            inFlight --;
+            reaped ++;
+        }
+        if (reaped > 0) {
+            readAheadCond.notify_all();
+        } else if (ret < 0) {
+            readAheadCond.wait_for(lk, std::chrono::milliseconds(IO_URING_RETRY_INTERVAL_IN_MILLIS));
+        }
+    }
+}
+
+void tMediaIOContext::writeStats(int64_t *target) {
+    target[0] = stats.bytesRead.load();
+    target[1] = stats.readSyscalls.load();
+    target[2] = stats.stallTimeInMicros.load();
+    target[3] = stats.seekCount.load();
+}
+
+void tMediaIOContext::release() {
+    if (readAheadThread != nullptr) {
+        {
+            std::lock_guard<std::mutex> lk(readAheadLock);
+            stopReadAhead = true;
+            readAheadCond.notify_all();
+        }
+        readAheadThread->join();
+        delete readAheadThread;
+        readAheadThread = nullptr;
+    }
+    if (asyncWorkers != nullptr) {
+        {
+            std::lock_guard<std::mutex> lk(readAheadLock);
+            stopReadAhead = true;
+            readAheadCond.notify_all();
+        }
+        for (int i = 0; i < asyncWorkerCount; i ++) {
+            asyncWorkers[i]->join();
+            delete asyncWorkers[i];
+        }
+        delete[] asyncWorkers;
+        asyncWorkers = nullptr;
+    }
+    if (uring != nullptr) {
+        uring->release();
+        delete uring;
+        uring = nullptr;
+    }
+    if (blocks != nullptr) {
+        for (int i = 0; i < blockCount; i ++) {
+            if (blocks[i].data != nullptr) {
+                free(blocks[i].data);
+            }
+        }
+        delete[] blocks;
+        blocks = nullptr;
+    }
+    if (avio_ctx != nullptr) {
+        av_freep(&avio_ctx->buffer);
+        avio_context_free(&avio_ctx);
+        avio_ctx = nullptr;
+    }
+    if (mappedData != nullptr) {
+        munmap(mappedData, (size_t) fileSize);
+        mappedData = nullptr;
+    }
+    if (ringBuffer != nullptr) {
+        free(ringBuffer);
+        ringBuffer = nullptr;
+    }
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+    LOGD("Custom io released, bytesRead=%lld, readSyscalls=%lld, stallTime=%lldus, seekCount=%lld",
+         (long long) stats.bytesRead.load(), (long long) stats.readSyscalls.load(),
+         (long long) stats.stallTimeInMicros.load(), (long long) stats.seekCount.load());
+    delete this;
+}
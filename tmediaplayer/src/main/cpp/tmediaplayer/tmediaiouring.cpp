@@ -0,0 +1,194 @@
+//
+// Created by pengcheng.tan on 2024/8/30.
+//
+#include "tmediaiouring.h"
+#include "tmediaplayer.h"
+
+#if defined(__linux__) && !defined(__ANDROID__)
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#include <cerrno>
+#include <cstring>
+
+static int ioUringSetup(uint32_t entries, struct io_uring_params *p) {
+    return (int) syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int ioUringEnter(int fd, uint32_t toSubmit, uint32_t minComplete, uint32_t flags) {
+    return (int) syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0);
+}
+
+static int ioUringRegister(int fd, uint32_t opcode, void *arg, uint32_t nrArgs) {
+    return (int) syscall(__NR_io_uring_register, fd, opcode, arg, nrArgs);
+}
+
+bool tMediaIOUring::setup(uint32_t entries) {
+    struct io_uring_params p {};
+    ringFd = ioUringSetup(entries, &p);
+    if (ringFd < 0) {
+        LOGE("io_uring setup fail: %d", errno);
+        return false;
+    }
+    // IORING_OP_READ needs kernel 5.6.
+    size_t probeSize = sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op);
+    auto probe = static_cast<struct io_uring_probe *>(calloc(1, probeSize));
+    bool readSupported = probe != nullptr && ioUringRegister(ringFd, IORING_REGISTER_PROBE, probe, 256) == 0 &&
+            probe->last_op >= IORING_OP_READ && (probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED);
+    free(probe);
+    if (!readSupported) {
+        LOGE("io_uring doesn't support read op.");
+        release();
+        return false;
+    }
+    sqEntries = p.sq_entries;
+    sqRingSize = p.sq_off.array + p.sq_entries * sizeof(uint32_t);
+    cqRingSize = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    bool singleMmap = p.features & IORING_FEAT_SINGLE_MMAP;
+    if (singleMmap) {
+        sqRingSize = cqRingSize = sqRingSize > cqRingSize ? sqRingSize : cqRingSize;
+    }
+    sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+    if (sqRing == MAP_FAILED) {
+        sqRing = nullptr;
+        LOGE("io_uring map sq ring fail: %d", errno);
+        release();
+        return false;
+    }
+    if (singleMmap) {
+        cqRing = sqRing;
+    } else {
+        cqRing = mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+        if (cqRing == MAP_FAILED) {
+            cqRing = nullptr;
+            LOGE("io_uring map cq ring fail: %d", errno);
+            release();
+            return false;
+        }
+    }
+    sqesSize = p.sq_entries * sizeof(struct io_uring_sqe);
+    sqes = mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        sqes = nullptr;
+        LOGE("io_uring map sqes fail: %d", errno);
+        release();
+        return false;
+    }
+    auto sq = static_cast<uint8_t *>(sqRing);
+    sqHead = reinterpret_cast<uint32_t *>(sq + p.sq_off.head);
+    sqTail = reinterpret_cast<uint32_t *>(sq + p.sq_off.tail);
+    sqMask = reinterpret_cast<uint32_t *>(sq + p.sq_off.ring_mask);
+    sqArray = reinterpret_cast<uint32_t *>(sq + p.sq_off.array);
+    auto cq = static_cast<uint8_t *>(cqRing);
+    cqHead = reinterpret_cast<uint32_t *>(cq + p.cq_off.head);
+    cqTail = reinterpret_cast<uint32_t *>(cq + p.cq_off.tail);
+    cqMask = reinterpret_cast<uint32_t *>(cq + p.cq_off.ring_mask);
+    cqes = cq + p.cq_off.cqes;
+    return true;
+}
+
+bool tMediaIOUring::queueRead(int fd, uint8_t *buf, uint32_t size, int64_t offset, uint64_t userData) {
+    uint32_t tail = *sqTail;
+    uint32_t head = __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+    if (tail - head >= sqEntries) {
+        return false;
+    }
+    uint32_t index = tail & *sqMask;
+    auto sqe = static_cast<struct io_uring_sqe *>(sqes) + index;
+    memset(sqe, 0, sizeof(struct io_uring_sqe));
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = fd;
+    sqe->addr = (uint64_t) (uintptr_t) buf;
+    sqe->len = size;
+    sqe->off = (uint64_t) offset;
+    sqe->user_data = userData;
+    sqArray[index] = index;
+    // Kernel sees sqe after tail updated.
+    __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+    toSubmit ++;
+    return true;
+}
+
+int tMediaIOUring::submitAndWait(uint32_t minComplete) {
+    while (true) {
+        int ret = ioUringEnter(ringFd, toSubmit, minComplete, minComplete > 0 ? IORING_ENTER_GETEVENTS : 0);
+        if (ret >= 0) {
+            toSubmit -= (uint32_t) ret > toSubmit ? toSubmit : (uint32_t) ret;
+            return ret;
+        }
+        if (errno != EINTR) {
+            return -errno;
+        }
+    }
+}
+
+bool tMediaIOUring::popCompletion(uint64_t *userData, int *res) {
+    uint32_t head = *cqHead;
+    if (head == __atomic_load_n(cqTail, __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+    auto cqe = static_cast<struct io_uring_cqe *>(cqes) + (head & *cqMask);
+    *userData = cqe->user_data;
+    *res = cqe->res;
+    __atomic_store_n(cqHead, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+void tMediaIOUring::release() {
+    if (sqes != nullptr) {
+        munmap(sqes, sqesSize);
+        sqes = nullptr;
+    }
+    if (cqRing != nullptr && cqRing != sqRing) {
+        munmap(cqRing, cqRingSize);
+    }
+    cqRing = nullptr;
+    if (sqRing != nullptr) {
+        munmap(sqRing, sqRingSize);
+        sqRing = nullptr;
+    }
+    if (ringFd >= 0) {
+        close(ringFd);
+        ringFd = -1;
+    }
+}
+
+bool isIOUringSupported() {
+    // Thread safe static init, containers may disable io_uring with seccomp or sysctl.
+    static const bool supported = [] {
+        tMediaIOUring ring;
+        bool ret = ring.setup(1);
+        ring.release();
+        return ret;
+    }();
+    return supported;
+}
+
+#else
+
+bool tMediaIOUring::setup(uint32_t) {
+    return false;
+}
+
+bool tMediaIOUring::queueRead(int, uint8_t *, uint32_t, int64_t, uint64_t) {
+    return false;
+}
+
+int tMediaIOUring::submitAndWait(uint32_t) {
+    return -1;
+}
+
+bool tMediaIOUring::popCompletion(uint64_t *, int *) {
+    return false;
+}
+
+void tMediaIOUring::release() {
+
+}
+
+bool isIOUringSupported() {
+    return false;
+}
+
+#endif
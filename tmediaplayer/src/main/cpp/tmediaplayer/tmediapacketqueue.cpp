@@ -0,0 +1,149 @@
+//
+// Created by pengcheng.tan on 2024/8/12.
+//
+#include "tmediapacketqueue.h"
+#include "tmediaplayer.h"
+
+bool tMediaPacketQueue::prepare(uint32_t minCapacity) {
+    uint32_t c = 1;
+    while (c < minCapacity) {
+        c = c << 1;
+    }
+    this->capacity = c;
+    this->mask = c - 1;
+    this->slots = new tMediaPacketQueueSlot[c];
+    for (uint32_t i = 0; i < c; i ++) {
+        auto p = av_packet_alloc();
+        if (p == nullptr) {
+            LOGE("Alloc packet queue slot fail.");
+            return false;
+        }
+        slots[i].pkt = p;
+    }
+    LOGD("Prepare packet queue, capacity=%d", c);
+    return true;
+}
+
+int tMediaPacketQueue::count() {
+    return (int) (tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire));
+}
+
+bool tMediaPacketQueue::isFull() {
+    uint32_t queued = tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    return queued >= capacity;
+}
+
+bool tMediaPacketQueue::push(AVPacket *src, int64_t durationInMillis) {
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    uint32_t h = head.load(std::memory_order_acquire);
+    if (t - h >= capacity) {
+        return false;
+    }
+    auto slot = &slots[t & mask];
+    av_packet_unref(slot->pkt);
+    av_packet_move_ref(slot->pkt, src);
+    slot->serial = serial.load(std::memory_order_relaxed);
+    slot->isEof = false;
+    slot->size = slot->pkt->size;
+    slot->duration = durationInMillis;
+    sizeInBytes.fetch_add(slot->size, std::memory_order_relaxed);
+    duration.fetch_add(durationInMillis, std::memory_order_relaxed);
+    slot->isCounted.store(true, std::memory_order_relaxed);
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+}
+
+bool tMediaPacketQueue::pushEof() {
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    uint32_t h = head.load(std::memory_order_acquire);
+    if (t - h >= capacity) {
+        return false;
+    }
+    auto slot = &slots[t & mask];
+    av_packet_unref(slot->pkt);
+    slot->serial = serial.load(std::memory_order_relaxed);
+    slot->isEof = true;
+    slot->size = 0;
+    slot->duration = 0L;
+    slot->isCounted.store(false, std::memory_order_relaxed);
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+}
+
+void tMediaPacketQueue::flush() {
+    serial.fetch_add(1, std::memory_order_acq_rel);
+    // Only producer writes slots, queued slots stay valid while consumer pops them.
+    uint32_t h = head.load(std::memory_order_acquire);
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    while (h != t) {
+        auto slot = &slots[h & mask];
+        if (slot->isCounted.exchange(false, std::memory_order_acq_rel)) {
+            sizeInBytes.fetch_sub(slot->size, std::memory_order_relaxed);
+            duration.fetch_sub(slot->duration, std::memory_order_relaxed);
+        }
+        h ++;
+    }
+}
+
+tMediaPacketQueuePopResult tMediaPacketQueue::pop(AVPacket *target, int *pktSerial) {
+    while (true) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        uint32_t t = tail.load(std::memory_order_acquire);
+        if (h == t) {
+            return PopPktEmpty;
+        }
+        auto slot = &slots[h & mask];
+        bool isOldSerial = slot->serial != serial.load(std::memory_order_acquire);
+        bool isEof = slot->isEof;
+        int slotSerial = slot->serial;
+        if (isOldSerial || isEof) {
+            av_packet_unref(slot->pkt);
+        } else {
+            av_packet_unref(target);
+            av_packet_move_ref(target, slot->pkt);
+        }
+        if (slot->isCounted.exchange(false, std::memory_order_acq_rel)) {
+            sizeInBytes.fetch_sub(slot->size, std::memory_order_relaxed);
+            duration.fetch_sub(slot->duration, std::memory_order_relaxed);
+        }
+        head.store(h + 1, std::memory_order_release);
+        if (isOldSerial) {
+            continue;
+        }
+        *pktSerial = slotSerial;
+        return isEof ? PopPktEof : PopPktSuccess;
+    }
+}
+
+void tMediaPacketQueue::clear() {
+    uint32_t h = head.load(std::memory_order_acquire);
+    uint32_t t = tail.load(std::memory_order_acquire);
+    while (h != t) {
+        av_packet_unref(slots[h & mask].pkt);
+        slots[h & mask].isCounted = false;
+        h ++;
+    }
+    head.store(t, std::memory_order_release);
+    sizeInBytes.store(0L);
+    duration.store(0L);
+    serial.fetch_add(1, std::memory_order_acq_rel);
+}
+
+void tMediaPacketQueue::release() {
+    if (slots != nullptr) {
+        for (uint32_t i = 0; i < capacity; i ++) {
+            auto p = slots[i].pkt;
+            if (p != nullptr) {
+                av_packet_unref(p);
+                av_packet_free(&p);
+                slots[i].pkt = nullptr;
+            }
+        }
+        delete[] slots;
+        slots = nullptr;
+    }
+    capacity = 0;
+    mask = 0;
+    delete this;
+    LOGD("Release packet queue.");
+}
@@ -0,0 +1,27 @@
+//
+// Created by pengcheng.tan on 2024/8/22.
+//
+#include "tmediapacketstats.h"
+
+void tMediaPacketAllocStats::onPacketRead(const AVPacket *pkt) {
+    packets ++;
+    if (pkt->buf == nullptr || pkt->size <= 0 || !av_buffer_is_writable(pkt->buf)) {
+        return;
+    }
+    payloadAllocations ++;
+    payloadBytes += pkt->buf->size;
+    if (pkt->buf->size >= PKT_STATS_LARGE_PAYLOAD_SIZE) {
+        largePayloads ++;
+    }
+    if ((int64_t) pkt->buf->size > maxPayloadSize) {
+        maxPayloadSize = (int64_t) pkt->buf->size;
+    }
+}
+
+void tMediaPacketAllocStats::writeStats(int64_t *target) {
+    target[0] = packets.load();
+    target[1] = payloadAllocations.load();
+    target[2] = payloadBytes.load();
+    target[3] = largePayloads.load();
+    target[4] = maxPayloadSize.load();
+}
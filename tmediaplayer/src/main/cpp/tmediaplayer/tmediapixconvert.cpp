@@ -0,0 +1,538 @@
+//
+// Created by pengcheng.tan on 2024/8/24.
+//
+#include "tmediapixconvert.h"
+#include "tmediaplayer.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define PIX_CONVERT_NEON 1
+#include <arm_neon.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#define PIX_CONVERT_X86 1
+#include <immintrin.h>
+#endif
+
+// Full range to limited range, 8.8 fixed point: luma 219 / 255, chroma 224 / 255.
+#define LUMA_RANGE_SCALE 220
+#define CHROMA_RANGE_SCALE 225
+
+// region Scalar
+static void u16ToU8Scalar(const uint16_t *src, uint8_t *dst, int width, int shift) {
+    int round = 1 << (shift - 1);
+    for (int x = 0; x < width; x ++) {
+        int v = (src[x] + round) >> shift;
+        dst[x] = v > 255 ? 255 : (uint8_t) v;
+    }
+}
+
+static void deinterleaveU16ToU8Scalar(const uint16_t *src, uint8_t *dstU, uint8_t *dstV, int width, int shift) {
+    int round = 1 << (shift - 1);
+    for (int x = 0; x < width; x ++) {
+        int u = (src[2 * x] + round) >> shift;
+        int v = (src[2 * x + 1] + round) >> shift;
+        dstU[x] = u > 255 ? 255 : (uint8_t) u;
+        dstV[x] = v > 255 ? 255 : (uint8_t) v;
+    }
+}
+
+static void fullToLimitedLumaScalar(const uint8_t *src, uint8_t *dst, int width) {
+    for (int x = 0; x < width; x ++) {
+        dst[x] = (uint8_t) (((src[x] * LUMA_RANGE_SCALE + 128) >> 8) + 16);
+    }
+}
+
+static void fullToLimitedChromaScalar(const uint8_t *src, uint8_t *dst, int width) {
+    for (int x = 0; x < width; x ++) {
+        int c = (((src[x] - 128) * CHROMA_RANGE_SCALE + 128) >> 8) + 128;
+        dst[x] = (uint8_t) (c < 0 ? 0 : (c > 255 ? 255 : c));
+    }
+}
+
+static void averageRowsScalar(const uint8_t *a, const uint8_t *b, uint8_t *dst, int width) {
+    for (int x = 0; x < width; x ++) {
+        dst[x] = (uint8_t) ((a[x] + b[x] + 1) >> 1);
+    }
+}
+
+static void boxDownscale2xScalar(const uint8_t *r0, const uint8_t *r1, uint8_t *dst, int dstWidth) {
+    for (int x = 0; x < dstWidth; x ++) {
+        dst[x] = (uint8_t) ((r0[2 * x] + r0[2 * x + 1] + r1[2 * x] + r1[2 * x + 1] + 2) >> 2);
+    }
+}
+// endregion
+
+#ifdef PIX_CONVERT_NEON
+// region Neon, compiled for arm abis but not run on device yet, tmediabench pixcheck verifies it against scalar.
+static void u16ToU8Neon(const uint16_t *src, uint8_t *dst, int width, int shift) {
+    int x = 0;
+    const int16x8_t s = vdupq_n_s16((int16_t) -shift);
+    for (; x + 16 <= width; x += 16) {
+        uint16x8_t a = vrshlq_u16(vld1q_u16(src + x), s);
+        uint16x8_t b = vrshlq_u16(vld1q_u16(src + x + 8), s);
+        vst1q_u8(dst + x, vcombine_u8(vqmovn_u16(a), vqmovn_u16(b)));
+    }
+    u16ToU8Scalar(src + x, dst + x, width - x, shift);
+}
+
+static void deinterleaveU16ToU8Neon(const uint16_t *src, uint8_t *dstU, uint8_t *dstV, int width, int shift) {
+    int x = 0;
+    const int16x8_t s = vdupq_n_s16((int16_t) -shift);
+    for (; x + 8 <= width; x += 8) {
+        uint16x8x2_t uv = vld2q_u16(src + 2 * x);
+        vst1_u8(dstU + x, vqmovn_u16(vrshlq_u16(uv.val[0], s)));
+        vst1_u8(dstV + x, vqmovn_u16(vrshlq_u16(uv.val[1], s)));
+    }
+    deinterleaveU16ToU8Scalar(src + 2 * x, dstU + x, dstV + x, width - x, shift);
+}
+
+static void fullToLimitedLumaNeon(const uint8_t *src, uint8_t *dst, int width) {
+    int x = 0;
+    const uint8x8_t scale = vdup_n_u8(LUMA_RANGE_SCALE);
+    const uint8x16_t offset = vdupq_n_u8(16);
+    for (; x + 16 <= width; x += 16) {
+        uint8x16_t y = vld1q_u8(src + x);
+        uint8x8_t lo = vrshrn_n_u16(vmull_u8(vget_low_u8(y), scale), 8);
+        uint8x8_t hi = vrshrn_n_u16(vmull_u8(vget_high_u8(y), scale), 8);
+        vst1q_u8(dst + x, vaddq_u8(vcombine_u8(lo, hi), offset));
+    }
+    fullToLimitedLumaScalar(src + x, dst + x, width - x);
+}
+
+static void fullToLimitedChromaNeon(const uint8_t *src, uint8_t *dst, int width) {
+    int x = 0;
+    const uint8x8_t center8 = vdup_n_u8(128);
+    const int16x8_t center16 = vdupq_n_s16(128);
+    for (; x + 16 <= width; x += 16) {
+        uint8x16_t c = vld1q_u8(src + x);
+        int16x8_t lo = vreinterpretq_s16_u16(vsubl_u8(vget_low_u8(c), center8));
+        int16x8_t hi = vreinterpretq_s16_u16(vsubl_u8(vget_high_u8(c), center8));
+        lo = vaddq_s16(vrshrq_n_s16(vmulq_n_s16(lo, CHROMA_RANGE_SCALE), 8), center16);
+        hi = vaddq_s16(vrshrq_n_s16(vmulq_n_s16(hi, CHROMA_RANGE_SCALE), 8), center16);
+        vst1q_u8(dst + x, vcombine_u8(vqmovun_s16(lo), vqmovun_s16(hi)));
+    }
+    fullToLimitedChromaScalar(src + x, dst + x, width - x);
+}
+
+static void averageRowsNeon(const uint8_t *a, const uint8_t *b, uint8_t *dst, int width) {
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        vst1q_u8(dst + x, vrhaddq_u8(vld1q_u8(a + x), vld1q_u8(b + x)));
+    }
+    averageRowsScalar(a + x, b + x, dst + x, width - x);
+}
+
+static void boxDownscale2xNeon(const uint8_t *r0, const uint8_t *r1, uint8_t *dst, int dstWidth) {
+    int x = 0;
+    for (; x + 8 <= dstWidth; x += 8) {
+        uint16x8_t sum = vpaddlq_u8(vld1q_u8(r0 + 2 * x));
+        sum = vpadalq_u8(sum, vld1q_u8(r1 + 2 * x));
+        vst1_u8(dst + x, vrshrn_n_u16(sum, 2));
+    }
+    boxDownscale2xScalar(r0 + 2 * x, r1 + 2 * x, dst + x, dstWidth - x);
+}
+// endregion
+#endif
+
+#ifdef PIX_CONVERT_X86
+// region Sse2, baseline of all Android x86 abis.
+// No Sse4 level: kernels only need unsigned saturating packs and 16 bits multiplies which Sse2 has, Sse4.1's
+// packus_epi32 / cvtepu8 only save an unpack, Avx2 level covers wider registers.
+static void u16ToU8Sse2(const uint16_t *src, uint8_t *dst, int width, int shift) {
+    int x = 0;
+    const __m128i round = _mm_set1_epi16((short) (1 << (shift - 1)));
+    const __m128i s = _mm_cvtsi32_si128(shift);
+    for (; x + 16 <= width; x += 16) {
+        __m128i a = _mm_srl_epi16(_mm_adds_epu16(_mm_loadu_si128((const __m128i *) (src + x)), round), s);
+        __m128i b = _mm_srl_epi16(_mm_adds_epu16(_mm_loadu_si128((const __m128i *) (src + x + 8)), round), s);
+        _mm_storeu_si128((__m128i *) (dst + x), _mm_packus_epi16(a, b));
+    }
+    u16ToU8Scalar(src + x, dst + x, width - x, shift);
+}
+
+static void deinterleaveU16ToU8Sse2(const uint16_t *src, uint8_t *dstU, uint8_t *dstV, int width, int shift) {
+    int x = 0;
+    const __m128i round = _mm_set1_epi16((short) (1 << (shift - 1)));
+    const __m128i s = _mm_cvtsi32_si128(shift);
+    const __m128i lowByte = _mm_set1_epi16(0x00FF);
+    for (; x + 16 <= width; x += 16) {
+        const uint16_t *p = src + 2 * x;
+        __m128i r0 = _mm_srl_epi16(_mm_adds_epu16(_mm_loadu_si128((const __m128i *) p), round), s);
+        __m128i r1 = _mm_srl_epi16(_mm_adds_epu16(_mm_loadu_si128((const __m128i *) (p + 8)), round), s);
+        __m128i r2 = _mm_srl_epi16(_mm_adds_epu16(_mm_loadu_si128((const __m128i *) (p + 16)), round), s);
+        __m128i r3 = _mm_srl_epi16(_mm_adds_epu16(_mm_loadu_si128((const __m128i *) (p + 24)), round), s);
+        // u0 v0 u1 v1 ... bytes.
+        __m128i b0 = _mm_packus_epi16(r0, r1);
+        __m128i b1 = _mm_packus_epi16(r2, r3);
+        __m128i u = _mm_packus_epi16(_mm_and_si128(b0, lowByte), _mm_and_si128(b1, lowByte));
+        __m128i v = _mm_packus_epi16(_mm_srli_epi16(b0, 8), _mm_srli_epi16(b1, 8));
+        _mm_storeu_si128((__m128i *) (dstU + x), u);
+        _mm_storeu_si128((__m128i *) (dstV + x), v);
+    }
+    deinterleaveU16ToU8Scalar(src + 2 * x, dstU + x, dstV + x, width - x, shift);
+}
+
+static void fullToLimitedLumaSse2(const uint8_t *src, uint8_t *dst, int width) {
+    int x = 0;
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i scale = _mm_set1_epi16(LUMA_RANGE_SCALE);
+    const __m128i round = _mm_set1_epi16(128);
+    const __m128i offset = _mm_set1_epi16(16);
+    for (; x + 16 <= width; x += 16) {
+        __m128i y = _mm_loadu_si128((const __m128i *) (src + x));
+        __m128i lo = _mm_unpacklo_epi8(y, zero);
+        __m128i hi = _mm_unpackhi_epi8(y, zero);
+        lo = _mm_add_epi16(_mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(lo, scale), round), 8), offset);
+        hi = _mm_add_epi16(_mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(hi, scale), round), 8), offset);
+        _mm_storeu_si128((__m128i *) (dst + x), _mm_packus_epi16(lo, hi));
+    }
+    fullToLimitedLumaScalar(src + x, dst + x, width - x);
+}
+
+static void fullToLimitedChromaSse2(const uint8_t *src, uint8_t *dst, int width) {
+    int x = 0;
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i scale = _mm_set1_epi16(CHROMA_RANGE_SCALE);
+    const __m128i center = _mm_set1_epi16(128);
+    for (; x + 16 <= width; x += 16) {
+        __m128i c = _mm_loadu_si128((const __m128i *) (src + x));
+        __m128i lo = _mm_sub_epi16(_mm_unpacklo_epi8(c, zero), center);
+        __m128i hi = _mm_sub_epi16(_mm_unpackhi_epi8(c, zero), center);
+        lo = _mm_add_epi16(_mm_srai_epi16(_mm_add_epi16(_mm_mullo_epi16(lo, scale), center), 8), center);
+        hi = _mm_add_epi16(_mm_srai_epi16(_mm_add_epi16(_mm_mullo_epi16(hi, scale), center), 8), center);
+        _mm_storeu_si128((__m128i *) (dst + x), _mm_packus_epi16(lo, hi));
+    }
+    fullToLimitedChromaScalar(src + x, dst + x, width - x);
+}
+
+static void averageRowsSse2(const uint8_t *a, const uint8_t *b, uint8_t *dst, int width) {
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        __m128i r = _mm_avg_epu8(_mm_loadu_si128((const __m128i *) (a + x)), _mm_loadu_si128((const __m128i *) (b + x)));
+        _mm_storeu_si128((__m128i *) (dst + x), r);
+    }
+    averageRowsScalar(a + x, b + x, dst + x, width - x);
+}
+
+// Horizontal pairs sum of 16 bytes to 8 u16.
+static inline __m128i pairSumSse2(__m128i v) {
+    const __m128i mask = _mm_set1_epi16(0x00FF);
+    return _mm_add_epi16(_mm_and_si128(v, mask), _mm_srli_epi16(v, 8));
+}
+
+static void boxDownscale2xSse2(const uint8_t *r0, const uint8_t *r1, uint8_t *dst, int dstWidth) {
+    int x = 0;
+    const __m128i round = _mm_set1_epi16(2);
+    for (; x + 16 <= dstWidth; x += 16) {
+        const uint8_t *a = r0 + 2 * x;
+        const uint8_t *b = r1 + 2 * x;
+        __m128i lo = _mm_add_epi16(pairSumSse2(_mm_loadu_si128((const __m128i *) a)), pairSumSse2(_mm_loadu_si128((const __m128i *) b)));
+        __m128i hi = _mm_add_epi16(pairSumSse2(_mm_loadu_si128((const __m128i *) (a + 16))), pairSumSse2(_mm_loadu_si128((const __m128i *) (b + 16))));
+        lo = _mm_srli_epi16(_mm_add_epi16(lo, round), 2);
+        hi = _mm_srli_epi16(_mm_add_epi16(hi, round), 2);
+        _mm_storeu_si128((__m128i *) (dst + x), _mm_packus_epi16(lo, hi));
+    }
+    boxDownscale2xScalar(r0 + 2 * x, r1 + 2 * x, dst + x, dstWidth - x);
+}
+// endregion
+
+// region Avx2, packs work in 128 bits lanes, permute to restore order.
+__attribute__((target("avx2")))
+static void u16ToU8Avx2(const uint16_t *src, uint8_t *dst, int width, int shift) {
+    int x = 0;
+    const __m256i round = _mm256_set1_epi16((short) (1 << (shift - 1)));
+    const __m128i s = _mm_cvtsi32_si128(shift);
+    for (; x + 32 <= width; x += 32) {
+        __m256i a = _mm256_srl_epi16(_mm256_adds_epu16(_mm256_loadu_si256((const __m256i *) (src + x)), round), s);
+        __m256i b = _mm256_srl_epi16(_mm256_adds_epu16(_mm256_loadu_si256((const __m256i *) (src + x + 16)), round), s);
+        __m256i r = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+        _mm256_storeu_si256((__m256i *) (dst + x), r);
+    }
+    u16ToU8Sse2(src + x, dst + x, width - x, shift);
+}
+
+__attribute__((target("avx2")))
+static void fullToLimitedLumaAvx2(const uint8_t *src, uint8_t *dst, int width) {
+    int x = 0;
+    const __m256i scale = _mm256_set1_epi16(LUMA_RANGE_SCALE);
+    const __m256i round = _mm256_set1_epi16(128);
+    const __m256i offset = _mm256_set1_epi16(16);
+    for (; x + 32 <= width; x += 32) {
+        __m256i lo = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *) (src + x)));
+        __m256i hi = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *) (src + x + 16)));
+        lo = _mm256_add_epi16(_mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(lo, scale), round), 8), offset);
+        hi = _mm256_add_epi16(_mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(hi, scale), round), 8), offset);
+        __m256i r = _mm256_permute4x64_epi64(_mm256_packus_epi16(lo, hi), 0xD8);
+        _mm256_storeu_si256((__m256i *) (dst + x), r);
+    }
+    fullToLimitedLumaSse2(src + x, dst + x, width - x);
+}
+
+__attribute__((target("avx2")))
+static void fullToLimitedChromaAvx2(const uint8_t *src, uint8_t *dst, int width) {
+    int x = 0;
+    const __m256i scale = _mm256_set1_epi16(CHROMA_RANGE_SCALE);
+    const __m256i center = _mm256_set1_epi16(128);
+    for (; x + 32 <= width; x += 32) {
+        __m256i lo = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *) (src + x))), center);
+        __m256i hi = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *) (src + x + 16))), center);
+        lo = _mm256_add_epi16(_mm256_srai_epi16(_mm256_add_epi16(_mm256_mullo_epi16(lo, scale), center), 8), center);
+        hi = _mm256_add_epi16(_mm256_srai_epi16(_mm256_add_epi16(_mm256_mullo_epi16(hi, scale), center), 8), center);
+        __m256i r = _mm256_permute4x64_epi64(_mm256_packus_epi16(lo, hi), 0xD8);
+        _mm256_storeu_si256((__m256i *) (dst + x), r);
+    }
+    fullToLimitedChromaSse2(src + x, dst + x, width - x);
+}
+
+__attribute__((target("avx2")))
+static void averageRowsAvx2(const uint8_t *a, const uint8_t *b, uint8_t *dst, int width) {
+    int x = 0;
+    for (; x + 32 <= width; x += 32) {
+        __m256i r = _mm256_avg_epu8(_mm256_loadu_si256((const __m256i *) (a + x)), _mm256_loadu_si256((const __m256i *) (b + x)));
+        _mm256_storeu_si256((__m256i *) (dst + x), r);
+    }
+    averageRowsSse2(a + x, b + x, dst + x, width - x);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i pairSumAvx2(__m256i v) {
+    const __m256i mask = _mm256_set1_epi16(0x00FF);
+    return _mm256_add_epi16(_mm256_and_si256(v, mask), _mm256_srli_epi16(v, 8));
+}
+
+__attribute__((target("avx2")))
+static void boxDownscale2xAvx2(const uint8_t *r0, const uint8_t *r1, uint8_t *dst, int dstWidth) {
+    int x = 0;
+    const __m256i round = _mm256_set1_epi16(2);
+    for (; x + 32 <= dstWidth; x += 32) {
+        const uint8_t *a = r0 + 2 * x;
+        const uint8_t *b = r1 + 2 * x;
+        __m256i lo = _mm256_add_epi16(pairSumAvx2(_mm256_loadu_si256((const __m256i *) a)), pairSumAvx2(_mm256_loadu_si256((const __m256i *) b)));
+        __m256i hi = _mm256_add_epi16(pairSumAvx2(_mm256_loadu_si256((const __m256i *) (a + 32))), pairSumAvx2(_mm256_loadu_si256((const __m256i *) (b + 32))));
+        lo = _mm256_srli_epi16(_mm256_add_epi16(lo, round), 2);
+        hi = _mm256_srli_epi16(_mm256_add_epi16(hi, round), 2);
+        __m256i r = _mm256_permute4x64_epi64(_mm256_packus_epi16(lo, hi), 0xD8);
+        _mm256_storeu_si256((__m256i *) (dst + x), r);
+    }
+    boxDownscale2xSse2(r0 + 2 * x, r1 + 2 * x, dst + x, dstWidth - x);
+}
+// endregion
+#endif
+
+static bool isPixConvertLevelSupported(tMediaPixConvertLevel level) {
+    switch (level) {
+        case PixConvertScalar:
+            return true;
+#ifdef PIX_CONVERT_NEON
+        case PixConvertNeon:
+            return true;
+#endif
+#ifdef PIX_CONVERT_X86
+        case PixConvertSse2:
+            return true;
+        case PixConvertAvx2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+/**
+ * Kernels of level, lower level's kernels are used if level has no faster version, level must be supported.
+ */
+static tMediaPixConvertKernels createKernels(tMediaPixConvertLevel level) {
+    tMediaPixConvertKernels k;
+    k.level = level;
+    k.u16ToU8 = u16ToU8Scalar;
+    k.deinterleaveU16ToU8 = deinterleaveU16ToU8Scalar;
+    k.fullToLimitedLuma = fullToLimitedLumaScalar;
+    k.fullToLimitedChroma = fullToLimitedChromaScalar;
+    k.averageRows = averageRowsScalar;
+    k.boxDownscale2x = boxDownscale2xScalar;
+#ifdef PIX_CONVERT_NEON
+    if (level != PixConvertNeon) {
+        return k;
+    }
+    k.u16ToU8 = u16ToU8Neon;
+    k.deinterleaveU16ToU8 = deinterleaveU16ToU8Neon;
+    k.fullToLimitedLuma = fullToLimitedLumaNeon;
+    k.fullToLimitedChroma = fullToLimitedChromaNeon;
+    k.averageRows = averageRowsNeon;
+    k.boxDownscale2x = boxDownscale2xNeon;
+#endif
+#ifdef PIX_CONVERT_X86
+    if (level != PixConvertSse2 && level != PixConvertAvx2) {
+        return k;
+    }
+    k.u16ToU8 = u16ToU8Sse2;
+    k.deinterleaveU16ToU8 = deinterleaveU16ToU8Sse2;
+    k.fullToLimitedLuma = fullToLimitedLumaSse2;
+    k.fullToLimitedChroma = fullToLimitedChromaSse2;
+    k.averageRows = averageRowsSse2;
+    k.boxDownscale2x = boxDownscale2xSse2;
+    if (level == PixConvertAvx2) {
+        k.u16ToU8 = u16ToU8Avx2;
+        // Deinterleave is bound by loads, keep sse2.
+        k.fullToLimitedLuma = fullToLimitedLumaAvx2;
+        k.fullToLimitedChroma = fullToLimitedChromaAvx2;
+        k.averageRows = averageRowsAvx2;
+        k.boxDownscale2x = boxDownscale2xAvx2;
+    }
+#endif
+    return k;
+}
+
+static tMediaPixConvertKernels createBestKernels() {
+    tMediaPixConvertLevel best = PixConvertScalar;
+    for (auto level : {PixConvertNeon, PixConvertSse2, PixConvertAvx2}) {
+        if (isPixConvertLevelSupported(level)) {
+            best = level;
+        }
+    }
+    LOGD("Pixel convert kernels level: %d", best);
+    return createKernels(best);
+}
+
+const tMediaPixConvertKernels *getPixConvertKernels() {
+    static const tMediaPixConvertKernels kernels = createBestKernels();
+    return &kernels;
+}
+
+const tMediaPixConvertKernels *getPixConvertKernelsOfLevel(tMediaPixConvertLevel level) {
+    static const tMediaPixConvertKernels allKernels[PIX_CONVERT_LEVEL_COUNT] = {
+            createKernels(PixConvertScalar),
+            createKernels(PixConvertNeon),
+            createKernels(PixConvertSse2),
+            createKernels(PixConvertAvx2)
+    };
+    if (level < 0 || level >= PIX_CONVERT_LEVEL_COUNT || !isPixConvertLevelSupported(level)) {
+        return nullptr;
+    }
+    return &allKernels[level];
+}
+
+bool pixConvertToYuv420p(const AVFrame *src, uint8_t *dstData[3], const int dstLineSize[3], int dstWidth, int dstHeight) {
+    auto format = (AVPixelFormat) src->format;
+    if (format != AV_PIX_FMT_YUV420P10LE &&
+        format != AV_PIX_FMT_YUVJ420P &&
+        format != AV_PIX_FMT_YUV422P &&
+        format != AV_PIX_FMT_P010LE) {
+        return false;
+    }
+    const tMediaPixConvertKernels *k = getPixConvertKernels();
+    int w = FFMIN(src->width, dstWidth);
+    int h = FFMIN(src->height, dstHeight);
+    int cw = (w + 1) / 2;
+    // Odd height has a last chroma row for the last luma row.
+    int ch = (h + 1) / 2;
+    switch (format) {
+        case AV_PIX_FMT_YUV420P10LE:
+            for (int y = 0; y < h; y ++) {
+                k->u16ToU8((const uint16_t *) (src->data[0] + y * src->linesize[0]), dstData[0] + y * dstLineSize[0], w, 2);
+            }
+            for (int y = 0; y < ch; y ++) {
+                k->u16ToU8((const uint16_t *) (src->data[1] + y * src->linesize[1]), dstData[1] + y * dstLineSize[1], cw, 2);
+                k->u16ToU8((const uint16_t *) (src->data[2] + y * src->linesize[2]), dstData[2] + y * dstLineSize[2], cw, 2);
+            }
+            break;
+        case AV_PIX_FMT_P010LE:
+            // 10 bits in high bits of u16.
+            for (int y = 0; y < h; y ++) {
+                k->u16ToU8((const uint16_t *) (src->data[0] + y * src->linesize[0]), dstData[0] + y * dstLineSize[0], w, 8);
+            }
+            for (int y = 0; y < ch; y ++) {
+                k->deinterleaveU16ToU8((const uint16_t *) (src->data[1] + y * src->linesize[1]),
+                                       dstData[1] + y * dstLineSize[1], dstData[2] + y * dstLineSize[2], cw, 8);
+            }
+            break;
+        case AV_PIX_FMT_YUVJ420P:
+            for (int y = 0; y < h; y ++) {
+                k->fullToLimitedLuma(src->data[0] + y * src->linesize[0], dstData[0] + y * dstLineSize[0], w);
+            }
+            for (int y = 0; y < ch; y ++) {
+                k->fullToLimitedChroma(src->data[1] + y * src->linesize[1], dstData[1] + y * dstLineSize[1], cw);
+                k->fullToLimitedChroma(src->data[2] + y * src->linesize[2], dstData[2] + y * dstLineSize[2], cw);
+            }
+            break;
+        case AV_PIX_FMT_YUV422P:
+            av_image_copy_plane(dstData[0], dstLineSize[0], src->data[0], src->linesize[0], w, h);
+            // Vertical chroma downsample.
+            for (int y = 0; y < ch; y ++) {
+                for (int p = 1; p <= 2; p ++) {
+                    const uint8_t *r0 = src->data[p] + (2 * y) * src->linesize[p];
+                    const uint8_t *r1 = 2 * y + 1 < h ? r0 + src->linesize[p] : r0;
+                    k->averageRows(r0, r1, dstData[p] + y * dstLineSize[p], cw);
+                }
+            }
+            break;
+        default:
+            return false;
+    }
+    return true;
+}
+
+bool pixDownscaleYuv420p(const AVFrame *src, int shift, uint8_t *dstData[3], const int dstLineSize[3]) {
+    if (src->format != AV_PIX_FMT_YUV420P || shift <= 0) {
+        return false;
+    }
+    // Chroma planes must be exact 2x of output chroma every pass.
+    int align = 1 << (shift + 1);
+    if (src->width % align != 0 || src->height % align != 0) {
+        return false;
+    }
+    const tMediaPixConvertKernels *k = getPixConvertKernels();
+    int blockRows = 1 << shift;
+    // Half of block rows at half width, reduced in place pass by pass.
+    int scratchLineSize = src->width / 2;
+    auto scratch = static_cast<uint8_t *>(av_malloc(scratchLineSize * (blockRows / 2)));
+    if (scratch == nullptr) {
+        return false;
+    }
+    for (int p = 0; p < 3; p ++) {
+        int w = p == 0 ? src->width : src->width / 2;
+        int outH = (p == 0 ? src->height : src->height / 2) >> shift;
+        for (int y = 0; y < outH; y ++) {
+            const uint8_t *in = src->data[p] + (y * blockRows) * src->linesize[p];
+            int inLineSize = src->linesize[p];
+            int rows = blockRows;
+            int rowWidth = w;
+            while (rows > 1) {
+                rows /= 2;
+                rowWidth /= 2;
+                for (int r = 0; r < rows; r ++) {
+                    const uint8_t *r0 = in + (2 * r) * inLineSize;
+                    uint8_t *out = rows == 1 ? dstData[p] + y * dstLineSize[p] : scratch + r * scratchLineSize;
+                    k->boxDownscale2x(r0, r0 + inLineSize, out, rowWidth);
+                }
+                in = scratch;
+                inLineSize = scratchLineSize;
+            }
+        }
+    }
+    av_free(scratch);
+    return true;
+}
+
+int pixDownscaleShift(int w, int h, int targetWidth, int targetHeight, int maxShift) {
+    if (targetWidth <= 0 || targetHeight <= 0) {
+        return 0;
+    }
+    int shift = 0;
+    while (shift < maxShift && (w >> (shift + 1)) >= targetWidth && (h >> (shift + 1)) >= targetHeight) {
+        shift ++;
+    }
+    return shift;
+}
+
+int64_t pixFrameBufferBytes(const AVFrame *f) {
+    int64_t bytes = 0;
+    for (auto buf : f->buf) {
+        if (buf != nullptr) {
+            bytes += buf->size;
+        }
+    }
+    return bytes;
+}
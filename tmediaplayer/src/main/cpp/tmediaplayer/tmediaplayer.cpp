@@ -2,16 +2,25 @@
 // Created by pengcheng.tan on 2024/5/27.
 //
 #include "tmediaplayer.h"
+#include "tmediapixconvert.h"
 
+extern "C" {
+#include "libavutil/time.h"
+}
 
-AVPixelFormat hw_pix_fmt_i = AV_PIX_FMT_NONE;
 
+// Negotiation state lives in the owning player (AVCodecContext::opaque), so players don't race on it.
 static enum AVPixelFormat get_hw_format(AVCodecContext *ctx,
                                         const enum AVPixelFormat *pix_fmts) {
+    auto player = static_cast<tMediaPlayerContext *>(ctx->opaque);
+    if (player == nullptr) {
+        LOGE("Failed to get HW surface format, no player attached.");
+        return AV_PIX_FMT_NONE;
+    }
     const enum AVPixelFormat *p;
 
     for (p = pix_fmts; *p != -1; p++) {
-        if (*p == hw_pix_fmt_i) {
+        if (*p == player->video_hw_pix_fmt) {
             return *p;
         }
     }
@@ -19,6 +28,20 @@ static enum AVPixelFormat get_hw_format(AVCodecContext *ctx,
     return AV_PIX_FMT_NONE;
 }
 
+void releaseMetadata(Metadata *src) {
+    for (int i = 0; i < src->metadataCount; i ++) {
+        char *key = src->metadata[i * 2];
+        char *value = src->metadata[i * 2 + 1];
+        free(key);
+        free(value);
+        src->metadata[i * 2] = nullptr;
+        src->metadata[i * 2 + 1] = nullptr;
+    }
+    src->metadataCount = 0;
+    free(src->metadata);
+    src->metadata = nullptr;
+}
+
 void readMetadata(AVDictionary *src, Metadata *dst) {
     AVDictionaryEntry *metadataLocal = nullptr;
     int metadataCountLocal = 0;
@@ -63,17 +86,51 @@ bool isSupportSubtitleStream(AVStream * s) {
            );
 }
 
+/**
+ * Subtitle codec may unknown after bounded probing, wait it discovered by reading packets.
+ */
+bool isSubtitleStreamReady(AVStream * s) {
+    return isSupportSubtitleStream(s) && s->codecpar->codec_id != AV_CODEC_ID_NONE;
+}
+
 tMediaOptResult tMediaPlayerContext::prepare(
         const char *media_file_p,
         bool is_request_hw,
         int target_audio_channels,
         int target_audio_sample_rate,
-        int target_audio_sample_bit_depth) {
+        int target_audio_sample_bit_depth,
+        tMediaIOMode io_mode,
+        int64_t read_ahead_buffer_size,
+        bool fast_start,
+        tMediaDecodeThreadType video_decode_thread_type,
+        int video_decode_thread_count) {
 
     this->media_file = media_file_p;
     LOGD("Prepare media file: %s", media_file_p);
     this->format_ctx = avformat_alloc_context();
-    int result = avformat_open_input(&format_ctx, media_file, nullptr, nullptr);
+    if (interrupt_ctx != nullptr) {
+        interrupt_ctx->attach(format_ctx);
+    }
+    this->fastStart = fast_start;
+    if (fast_start) {
+        // Bounded probing, streams not found are discovered by reading packets.
+        format_ctx->probesize = FAST_START_PROBE_SIZE;
+        format_ctx->max_analyze_duration = FAST_START_MAX_ANALYZE_DURATION;
+    }
+    if (io_mode != IODefault && isLocalFilePath(media_file)) {
+        io_ctx = new tMediaIOContext;
+        if (io_ctx->prepare(media_file, io_mode, read_ahead_buffer_size)) {
+            format_ctx->pb = io_ctx->avio_ctx;
+            format_ctx->flags |= AVFMT_FLAG_CUSTOM_IO;
+            io_ctx->interrupt_cb = &format_ctx->interrupt_callback;
+        } else {
+            LOGE("Prepare custom io fail, use default file protocol.");
+            io_ctx->release();
+            io_ctx = nullptr;
+        }
+    }
+    beginBlockingOp(BlockingOpOpenInput);
+    int result = endBlockingOp(avformat_open_input(&format_ctx, media_file, nullptr, nullptr));
     if (result < 0) {
         LOGE("Avformat open file fail: %d", result);
         return OptFail;
@@ -138,13 +195,14 @@ tMediaOptResult tMediaPlayerContext::prepare(
     LOGD("Container name: %s", containerName);
 
     // Find out first audio stream and video stream.
-    result = avformat_find_stream_info(format_ctx, nullptr);
+    beginBlockingOp(BlockingOpFindStreamInfo);
+    result = endBlockingOp(findStreamInfoWithCache(format_ctx, media_file));
     if (result < 0) {
         LOGE("Avformat find stream info fail: %d", result);
         return OptFail;
     }
     int subtitleStreamCountLocal = 0;
-    for (int i = 0; i < format_ctx->nb_streams; i ++) {
+    for (unsigned int i = 0; i < format_ctx->nb_streams; i ++) {
         auto s = format_ctx->streams[i];
         auto codec_type = s->codecpar->codec_type;
         switch (codec_type) {
@@ -162,8 +220,9 @@ tMediaOptResult tMediaPlayerContext::prepare(
                 }
                 break;
             case AVMEDIA_TYPE_AUDIO:
+                audioStreamCount ++;
                 if (this->audio_stream != nullptr) {
-                    LOGE("Find multiple audio stream, skip it.");
+                    LOGD("Find multiple audio stream, use first as default.");
                 } else {
                     this->audio_stream = s;
                     this->audio_duration = 0L;
@@ -175,7 +234,7 @@ tMediaOptResult tMediaPlayerContext::prepare(
                 break;
 
             case AVMEDIA_TYPE_SUBTITLE:
-                if (isSupportSubtitleStream(s)) {
+                if (isSubtitleStreamReady(s)) {
                     subtitleStreamCountLocal ++;
                 }
                 break;
@@ -190,12 +249,12 @@ tMediaOptResult tMediaPlayerContext::prepare(
     if (subtitleStreamCountLocal > 0) {
         int subtitleIndex = 0;
         this->subtitleStreams = static_cast<SubtitleStream **>(malloc(sizeof(SubtitleStream *) * subtitleStreamCountLocal));
-        for (int i = 0; i < format_ctx->nb_streams; i ++) {
+        for (unsigned int i = 0; i < format_ctx->nb_streams; i ++) {
             auto s = format_ctx->streams[i];
             auto codec_type = s->codecpar->codec_type;
             if (codec_type == AVMEDIA_TYPE_SUBTITLE) {
                 // Do not support bitmap subtitle.
-                if (isSupportSubtitleStream(s)) {
+                if (isSubtitleStreamReady(s)) {
                     LOGD("SubtitleStream: %d", s->index);
                     auto* ts = new SubtitleStream;
                     subtitleStreams[subtitleIndex] = ts;
@@ -210,6 +269,25 @@ tMediaOptResult tMediaPlayerContext::prepare(
         }
     }
 
+    // Read audio streams
+    if (audioStreamCount > 0) {
+        int audioIndex = 0;
+        this->audioStreams = static_cast<AudioStream **>(malloc(sizeof(AudioStream *) * audioStreamCount));
+        for (unsigned int i = 0; i < format_ctx->nb_streams; i ++) {
+            auto s = format_ctx->streams[i];
+            if (s->codecpar->codec_type == AVMEDIA_TYPE_AUDIO) {
+                auto *as = new AudioStream;
+                audioStreams[audioIndex] = as;
+                as->stream = s;
+                readMetadata(s->metadata, &as->streamMetadata);
+                audioIndex ++;
+            }
+        }
+        LOGD("Find %d audio streams", audioStreamCount);
+    }
+
+    this->knownStreamCount = (int) format_ctx->nb_streams;
+
     // No video stream and audio stream.
     if (video_stream == nullptr && audio_stream == nullptr) {
         LOGE("Didn't find video stream or audio stream");
@@ -263,17 +341,18 @@ tMediaOptResult tMediaPlayerContext::prepare(
                 const AVCodec *hwDecoder = avcodec_find_decoder_by_name(hwCodecName);
                 if (hwDecoder) {
                     // find pixel format.
+                    video_hw_pix_fmt = AV_PIX_FMT_NONE;
                     for (int i = 0; ; ++i) {
                         const AVCodecHWConfig *config = avcodec_get_hw_config(hwDecoder, i);
                         if (!config) {
                             break;
                         }
                         if (config->methods & AV_CODEC_HW_CONFIG_METHOD_HW_DEVICE_CTX && config->device_type == hwDeviceType) {
-                            hw_pix_fmt_i = config->pix_fmt;
+                            video_hw_pix_fmt = config->pix_fmt;
                             break;
                         }
                     }
-                    if (hw_pix_fmt_i != AV_PIX_FMT_NONE) {
+                    if (video_hw_pix_fmt != AV_PIX_FMT_NONE) {
                         this->video_decoder = hwDecoder;
                         result = av_hwdevice_ctx_create(&hardware_ctx, hwDeviceType, nullptr,
                                                         nullptr, 0);
@@ -283,6 +362,7 @@ tMediaOptResult tMediaPlayerContext::prepare(
                             if (video_decoder_ctx) {
                                 result = avcodec_parameters_to_context(video_decoder_ctx, params);
                                 if (result >= 0) {
+                                    video_decoder_ctx->opaque = this;
                                     video_decoder_ctx->get_format = get_hw_format;
                                     video_decoder_ctx->hw_device_ctx = av_buffer_ref(hardware_ctx);
                                     result = avcodec_open2(video_decoder_ctx, video_decoder, nullptr);
@@ -316,6 +396,11 @@ tMediaOptResult tMediaPlayerContext::prepare(
         //endregion
 
         //region Software Decoder
+        if (hardware_ctx != nullptr) {
+            // Hardware decoder open fail, fallback to software.
+            av_buffer_unref(&hardware_ctx);
+            hardware_ctx = nullptr;
+        }
         this->video_decoder = avcodec_find_decoder(params->codec_id);
         if (video_decoder == nullptr) {
             LOGE("Didn't find sw video decoder.");
@@ -331,6 +416,8 @@ tMediaOptResult tMediaPlayerContext::prepare(
             LOGE("Attach video params to sw decoder ctx fail: %d", result);
             return OptFail;
         }
+        video_decode_threads.setRequest(video_decode_thread_type, video_decode_thread_count);
+        video_decode_threads.configure(video_decoder_ctx, video_decoder, videoIsAttachPic, 0);
         result = avcodec_open2(video_decoder_ctx, video_decoder, nullptr);
         if (result < 0) {
             LOGE("Open video sw decoder ctx fail: %d", result);
@@ -342,8 +429,6 @@ tMediaOptResult tMediaPlayerContext::prepare(
 
         // // set decode pixel size half
         // video_decoder_ctx->lowres = 1;
-        // // set decode thread count
-        // video_decoder_ctx->thread_count = 1;
         decoder_open_success:
         this->video_pixel_format = video_decoder_ctx->pix_fmt;
         const char *codecName = nullptr;
@@ -373,65 +458,9 @@ tMediaOptResult tMediaPlayerContext::prepare(
 
     // Audio
     if (audio_stream != nullptr) {
-        auto params = audio_stream->codecpar;
-        this->audio_codec_id = params->codec_id;
-        this->audio_bits_per_raw_sample = params->bits_per_raw_sample;
-        this->audio_bitrate = (int) params->bit_rate;
-        this->audio_decoder = avcodec_find_decoder(params->codec_id);
-        if (!audio_decoder) {
-            LOGE("Didn't find audio decoder.");
-            return OptFail;
-        }
-        this->audio_decoder_ctx = avcodec_alloc_context3(audio_decoder);
-        if (!audio_decoder_ctx) {
-            LOGE("Create audio decoder ctx fail");
+        if (openAudioStream(audio_stream) != OptSuccess) {
             return OptFail;
         }
-        result = avcodec_parameters_to_context(audio_decoder_ctx, params);
-        if (result < 0) {
-            LOGE("Attach params to audio ctx fail: %d", result);
-            return OptFail;
-        }
-        result = avcodec_open2(audio_decoder_ctx, audio_decoder, nullptr);
-        if (result < 0) {
-            LOGE("Open audio ctx fail: %d", result);
-            return OptFail;
-        }
-        this->audio_channels = audio_decoder_ctx->ch_layout.nb_channels;
-        this->audio_per_sample_bytes = av_get_bytes_per_sample(audio_decoder_ctx->sample_fmt);
-        this->audio_sample_format = audio_decoder_ctx->sample_fmt;
-        this->audio_simple_rate = audio_decoder_ctx->sample_rate;
-        this->audio_swr_ctx = swr_alloc();
-
-        swr_alloc_set_opts2(&audio_swr_ctx, &audio_output_ch_layout, audio_output_sample_fmt,audio_output_sample_rate,
-                            &audio_decoder_ctx->ch_layout, audio_decoder_ctx->sample_fmt, audio_decoder_ctx->sample_rate,
-                            0,nullptr);
-        result = swr_init(audio_swr_ctx);
-        if (result < 0) {
-            LOGE("Init swr ctx fail: %d", result);
-            return OptFail;
-        }
-        const char *codecName = nullptr;
-        if (audio_decoder->long_name) {
-            codecName = audio_decoder->long_name;
-        } else {
-            codecName = audio_decoder->name;
-        }
-        int codecNameLen = 0;
-        if (codecName) {
-            codecNameLen = strlen(codecName);
-        }
-        if (audioDecoderName != nullptr) {
-            free(audioDecoderName);
-        }
-        audioDecoderName = static_cast<char *>(malloc((codecNameLen + 1) * sizeof(char)));
-        if (codecName) {
-            memcpy(audioDecoderName, codecName, codecNameLen);
-        }
-        audioDecoderName[codecNameLen] = '\0';
-        audioMetadata = new Metadata;
-        readMetadata(audio_stream->metadata, audioMetadata);
-        LOGD("Prepare audio decoder success: %s", codecName);
         this->audio_frame = av_frame_alloc();
         this->audio_pkt = av_packet_alloc();
     }
@@ -447,9 +476,163 @@ tMediaOptResult tMediaPlayerContext::prepare(
     return OptSuccess;
 }
 
+tMediaOptResult tMediaPlayerContext::openAudioStream(AVStream *stream) {
+    auto params = stream->codecpar;
+    auto decoder = avcodec_find_decoder(params->codec_id);
+    if (!decoder) {
+        LOGE("Didn't find audio decoder.");
+        return OptFail;
+    }
+    auto decoderCtx = avcodec_alloc_context3(decoder);
+    if (!decoderCtx) {
+        LOGE("Create audio decoder ctx fail");
+        return OptFail;
+    }
+    int result = avcodec_parameters_to_context(decoderCtx, params);
+    if (result < 0) {
+        LOGE("Attach params to audio ctx fail: %d", result);
+        avcodec_free_context(&decoderCtx);
+        return OptFail;
+    }
+    result = avcodec_open2(decoderCtx, decoder, nullptr);
+    if (result < 0) {
+        LOGE("Open audio ctx fail: %d", result);
+        avcodec_free_context(&decoderCtx);
+        return OptFail;
+    }
+    SwrContext *swrCtx = swr_alloc();
+    swr_alloc_set_opts2(&swrCtx, &audio_output_ch_layout, audio_output_sample_fmt,audio_output_sample_rate,
+                        &decoderCtx->ch_layout, decoderCtx->sample_fmt, decoderCtx->sample_rate,
+                        0,nullptr);
+    result = swr_init(swrCtx);
+    if (result < 0) {
+        LOGE("Init swr ctx fail: %d", result);
+        swr_free(&swrCtx);
+        avcodec_free_context(&decoderCtx);
+        return OptFail;
+    }
+
+    // Replace old decoder.
+    if (audio_decoder_ctx != nullptr) {
+        avcodec_free_context(&audio_decoder_ctx);
+    }
+    if (audio_swr_ctx != nullptr) {
+        swr_free(&audio_swr_ctx);
+    }
+    this->audio_stream = stream;
+    this->audio_decoder = decoder;
+    this->audio_decoder_ctx = decoderCtx;
+    this->audio_swr_ctx = swrCtx;
+    this->audio_duration = 0L;
+    if (stream->duration != AV_NOPTS_VALUE && stream->time_base.den > 0 && stream->duration > 0) {
+        this->audio_duration = (long) (((double)stream->duration) * av_q2d(stream->time_base) * 1000.0);
+    }
+    this->audio_codec_id = params->codec_id;
+    this->audio_bits_per_raw_sample = params->bits_per_raw_sample;
+    this->audio_bitrate = (int) params->bit_rate;
+    this->audio_channels = decoderCtx->ch_layout.nb_channels;
+    this->audio_per_sample_bytes = av_get_bytes_per_sample(decoderCtx->sample_fmt);
+    this->audio_sample_format = decoderCtx->sample_fmt;
+    this->audio_simple_rate = decoderCtx->sample_rate;
+
+    const char *codecName = nullptr;
+    if (decoder->long_name) {
+        codecName = decoder->long_name;
+    } else {
+        codecName = decoder->name;
+    }
+    int codecNameLen = 0;
+    if (codecName) {
+        codecNameLen = strlen(codecName);
+    }
+    if (audioDecoderName != nullptr) {
+        free(audioDecoderName);
+    }
+    audioDecoderName = static_cast<char *>(malloc((codecNameLen + 1) * sizeof(char)));
+    if (codecName) {
+        memcpy(audioDecoderName, codecName, codecNameLen);
+    }
+    audioDecoderName[codecNameLen] = '\0';
+    if (audioMetadata != nullptr) {
+        releaseMetadata(audioMetadata);
+        free(audioMetadata);
+    }
+    audioMetadata = new Metadata;
+    readMetadata(stream->metadata, audioMetadata);
+    LOGD("Prepare audio decoder success: stream=%d, decoder=%s", stream->index, codecName);
+    return OptSuccess;
+}
+
+tMediaOptResult tMediaPlayerContext::switchAudioStream(int streamIndex, int64_t positionInMillis) {
+    if (audio_stream == nullptr || streamIndex < 0 || (unsigned int) streamIndex >= format_ctx->nb_streams) {
+        return OptFail;
+    }
+    auto target = format_ctx->streams[streamIndex];
+    if (target->codecpar->codec_type != AVMEDIA_TYPE_AUDIO) {
+        LOGE("Stream %d is not audio stream.", streamIndex);
+        return OptFail;
+    }
+    if (target == audio_stream) {
+        return OptSuccess;
+    }
+    if (openAudioStream(target) != OptSuccess) {
+        return OptFail;
+    }
+    av_packet_unref(audio_pkt);
+    av_frame_unref(audio_frame);
+    // Audio packet queue is flushed by packet reader thread, old stream packets before flush are skipped by decoder.
+    audio_resync_pos_in_millis = positionInMillis < 0 ? 0 : positionInMillis;
+    discard_dirty = true;
+    return OptSuccess;
+}
+
+void tMediaPlayerContext::resyncAudioStream() {
+    int64_t posInMillis = audio_resync_pos_in_millis.exchange(-1);
+    if (posInMillis < 0) {
+        return;
+    }
+    // Packets read before seek are still in queues, skip them.
+    video_skip_until_dts = last_video_pkt_dts;
+    subtitle_skip_until_millis = last_read_pkt_millis;
+    audio_skip_until_pts = av_rescale_q(posInMillis, AVRational {1, 1000}, audio_stream->time_base);
+    int64_t seekTs = posInMillis * AV_TIME_BASE / 1000L;
+    beginBlockingOp(BlockingOpSeek);
+    int ret = endBlockingOp(avformat_seek_file(format_ctx, -1, INT64_MIN, seekTs, INT64_MAX, AVSEEK_FLAG_BACKWARD));
+    if (ret < 0) {
+        // New audio start from current read position.
+        LOGE("Resync audio seek fail: %d", ret);
+        video_skip_until_dts = AV_NOPTS_VALUE;
+        subtitle_skip_until_millis = -1;
+    } else {
+        LOGD("Resync audio stream %d at %lldms", audio_stream->index, (long long) posInMillis);
+    }
+}
+
+void tMediaPlayerContext::beginBlockingOp(tMediaBlockingOp op) {
+    if (interrupt_ctx != nullptr) {
+        interrupt_ctx->beginOp(op);
+    }
+}
+
+int tMediaPlayerContext::endBlockingOp(int ret) {
+    if (interrupt_ctx != nullptr) {
+        return interrupt_ctx->endOp(ret);
+    }
+    return ret;
+}
+
 tMediaReadPktResult tMediaPlayerContext::readPacket() {
-    int ret = av_read_frame(format_ctx, pkt);
+    beginBlockingOp(BlockingOpReadFrame);
+    int ret = endBlockingOp(av_read_frame(format_ctx, pkt));
     if (ret < 0) {
+        if (interrupt_ctx != nullptr && interrupt_ctx->isLastOpInterrupted()) {
+            // Interrupted io sets eof_reached, clear it or cancelled read is treated as eof.
+            if (format_ctx->pb != nullptr) {
+                format_ctx->pb->eof_reached = 0;
+                format_ctx->pb->error = 0;
+            }
+            return ReadFail;
+        }
         if (ret == AVERROR_EOF || avio_feof(format_ctx->pb)) {
             return ReadEof;
         } else {
@@ -458,6 +641,7 @@ tMediaReadPktResult tMediaPlayerContext::readPacket() {
     } else {
         if (video_stream && pkt->stream_index == video_stream->index) {
             pkt->time_base = video_stream->time_base;
+            pkt_alloc_stats.onPacketRead(pkt);
             // video
             if (videoIsAttachPic) {
                 return ReadVideoAttachmentSuccess;
@@ -467,6 +651,7 @@ tMediaReadPktResult tMediaPlayerContext::readPacket() {
         }
         if (audio_stream && pkt->stream_index == audio_stream->index) {
             pkt->time_base = audio_stream->time_base;
+            pkt_alloc_stats.onPacketRead(pkt);
             // audio
             return ReadAudioSuccess;
         }
@@ -479,11 +664,353 @@ tMediaReadPktResult tMediaPlayerContext::readPacket() {
                 }
             }
         }
+        if (fastStart && discoverStream(pkt->stream_index)) {
+            // New subtitle stream.
+            pkt->time_base = format_ctx->streams[pkt->stream_index]->time_base;
+            return ReadSubtitleSuccess;
+        }
         av_packet_unref(pkt);
         return UnknownPkt;
     }
 }
 
+void tMediaPlayerContext::setSelectedSubtitleStream(int streamIndex) {
+    selected_subtitle_stream_index = streamIndex;
+    discard_dirty = true;
+}
+
+void tMediaPlayerContext::setVideoDiscarded(bool discarded) {
+    video_discarded = discarded;
+    discard_dirty = true;
+}
+
+void tMediaPlayerContext::applyStreamsDiscard() {
+    if (!discard_dirty.exchange(false)) {
+        return;
+    }
+    int subtitleIndex = selected_subtitle_stream_index;
+    bool discardVideo = video_discarded && audio_stream != nullptr && !videoIsAttachPic;
+    for (unsigned int i = 0; i < format_ctx->nb_streams; i ++) {
+        auto s = format_ctx->streams[i];
+        AVDiscard discard;
+        if (s == audio_stream) {
+            discard = AVDISCARD_DEFAULT;
+        } else if (s == video_stream) {
+            discard = discardVideo ? AVDISCARD_ALL : AVDISCARD_DEFAULT;
+            if (!discardVideo && s->discard == AVDISCARD_ALL) {
+                video_wait_key_frame = true;
+            }
+        } else if (s->index == subtitleIndex) {
+            discard = AVDISCARD_DEFAULT;
+        } else if (fastStart && s->codecpar->codec_type == AVMEDIA_TYPE_SUBTITLE && !isSubtitleStreamReady(s)) {
+            // Need packets to discover codec.
+            discard = AVDISCARD_DEFAULT;
+        } else {
+            // Extra audio/video, unselected subtitle, data and attachment streams.
+            discard = AVDISCARD_ALL;
+        }
+        if (s->discard != discard) {
+            LOGD("Stream %d discard: %d -> %d", i, s->discard, discard);
+            s->discard = discard;
+        }
+    }
+}
+
+bool tMediaPlayerContext::discoverStream(int streamIndex) {
+    if (streamIndex < 0 || (unsigned int) streamIndex >= format_ctx->nb_streams) {
+        return false;
+    }
+    auto target = format_ctx->streams[streamIndex];
+    bool isNewStream = streamIndex >= knownStreamCount;
+    bool isPendingSubtitle = target->codecpar->codec_type == AVMEDIA_TYPE_SUBTITLE && isSupportSubtitleStream(target);
+    if (!isNewStream && !isPendingSubtitle) {
+        return false;
+    }
+    if (isNewStream) {
+        LOGD("Discover new streams, count: %d -> %d", knownStreamCount, format_ctx->nb_streams);
+        knownStreamCount = (int) format_ctx->nb_streams;
+        // New streams need discard.
+        discard_dirty = true;
+    }
+    if (!isSubtitleStreamReady(target)) {
+        return false;
+    }
+    // Add to subtitle streams.
+    auto newStreams = static_cast<SubtitleStream **>(realloc(subtitleStreams, sizeof(SubtitleStream *) * (subtitleStreamCount + 1)));
+    if (newStreams == nullptr) {
+        LOGE("Realloc subtitle streams fail.");
+        return false;
+    }
+    subtitleStreams = newStreams;
+    auto* ts = new SubtitleStream;
+    ts->stream = target;
+    readMetadata(target->metadata, &ts->streamMetadata);
+    subtitleStreams[subtitleStreamCount] = ts;
+    subtitleStreamCount ++;
+    newStreamsDiscovered = true;
+    discard_dirty = true;
+    LOGD("Discover subtitle stream: %d", streamIndex);
+    return true;
+}
+
+static int64_t ptsToMillis(int64_t pts, AVRational time_base) {
+    if (pts == AV_NOPTS_VALUE || time_base.den <= 0) {
+        return 0L;
+    } else {
+        return (int64_t) ((double) pts * av_q2d(time_base) * 1000.0);
+    }
+}
+
+bool tMediaPlayerContext::isPktQueuesFull(int64_t maxBytes, int64_t maxDurationInMillis) {
+    if (video_pkt_queue == nullptr || audio_pkt_queue == nullptr) {
+        return true;
+    }
+    // Need space for eof.
+    if ((uint32_t) video_pkt_queue->count() + 1 >= video_pkt_queue->capacity ||
+        (uint32_t) audio_pkt_queue->count() + 1 >= audio_pkt_queue->capacity) {
+        return true;
+    }
+    if (video_pkt_queue->sizeInBytes.load() + audio_pkt_queue->sizeInBytes.load() > maxBytes) {
+        return true;
+    }
+    bool audioQueueIsFull = audio_stream == nullptr || audio_pkt_queue->duration.load() > maxDurationInMillis;
+    bool videoQueueIsFull = video_stream == nullptr || videoIsAttachPic || video_pkt_queue->duration.load() > maxDurationInMillis;
+    return audioQueueIsFull && videoQueueIsFull;
+}
+
+tMediaReadPktsToQueueResult tMediaPlayerContext::readPacketsToQueues(int64_t maxBytes, int64_t maxDurationInMillis, bool requestAttachment) {
+    if (video_pkt_queue == nullptr || audio_pkt_queue == nullptr) {
+        LOGE("Packet queues not attached.");
+        return ReadToQueueFail;
+    }
+    applyStreamsDiscard();
+    resyncAudioStream();
+    if (reverse_playback && video_reverse != nullptr) {
+        return readReversePacketsToQueue();
+    }
+    if (trick_play_speed != 0 && video_stream != nullptr && !videoIsAttachPic) {
+        return readTrickPlayPacketsToQueue(maxBytes);
+    }
+    // Limit packets count of one call, let reader thread handle seek and release.
+    for (int i = 0; i < READ_PKT_MAX_BATCH_SIZE; i ++) {
+        if (isPktQueuesFull(maxBytes, maxDurationInMillis)) {
+            return ReadToQueueFull;
+        }
+        auto result = readPacket();
+        if (result == ReadVideoSuccess || result == ReadAudioSuccess || result == ReadSubtitleSuccess) {
+            int64_t ts = pkt->pts != AV_NOPTS_VALUE ? pkt->pts : pkt->dts;
+            if (ts != AV_NOPTS_VALUE) {
+                last_read_pkt_millis = ptsToMillis(ts, pkt->time_base);
+            }
+        }
+        switch (result) {
+            case ReadVideoSuccess:
+                if (video_skip_until_dts != AV_NOPTS_VALUE) {
+                    if (pkt->dts == AV_NOPTS_VALUE || pkt->dts <= video_skip_until_dts) {
+                        // Already in queue.
+                        av_packet_unref(pkt);
+                        break;
+                    }
+                    video_skip_until_dts = AV_NOPTS_VALUE;
+                }
+                if (video_wait_key_frame) {
+                    if (!(pkt->flags & AV_PKT_FLAG_KEY)) {
+                        av_packet_unref(pkt);
+                        break;
+                    }
+                    // Decoder flush by serial changed.
+                    video_wait_key_frame = false;
+                    video_pkt_queue->flush();
+                }
+                last_video_pkt_dts = pkt->dts;
+                video_pkt_queue->push(pkt, ptsToMillis(pkt->duration, pkt->time_base));
+                break;
+            case ReadAudioSuccess:
+                if (audio_skip_until_pts != AV_NOPTS_VALUE) {
+                    if (pkt->pts != AV_NOPTS_VALUE && pkt->pts + pkt->duration <= audio_skip_until_pts) {
+                        av_packet_unref(pkt);
+                        break;
+                    }
+                    audio_skip_until_pts = AV_NOPTS_VALUE;
+                }
+                audio_pkt_queue->push(pkt, ptsToMillis(pkt->duration, pkt->time_base));
+                break;
+            case ReadVideoAttachmentSuccess:
+                if (requestAttachment) {
+                    video_pkt_queue->push(pkt, 0L);
+                    video_pkt_queue->pushEof();
+                    return ReadToQueueAttachment;
+                } else {
+                    av_packet_unref(pkt);
+                }
+                break;
+            case ReadSubtitleSuccess:
+                if (subtitle_skip_until_millis >= 0) {
+                    if (ptsToMillis(pkt->pts, pkt->time_base) <= subtitle_skip_until_millis) {
+                        av_packet_unref(pkt);
+                        break;
+                    }
+                    subtitle_skip_until_millis = -1;
+                }
+                return ReadToQueueSubtitle;
+            case ReadEof:
+                // Audio resync may read to eof again.
+                if (video_stream != nullptr && !videoIsAttachPic && !video_eof_pushed) {
+                    video_pkt_queue->pushEof();
+                    video_eof_pushed = true;
+                }
+                video_skip_until_dts = AV_NOPTS_VALUE;
+                subtitle_skip_until_millis = -1;
+                if (audio_stream != nullptr) {
+                    audio_pkt_queue->pushEof();
+                }
+                return ReadToQueueEof;
+            case ReadFail:
+                return ReadToQueueFail;
+            default:
+                break;
+        }
+    }
+    return ReadToQueueContinue;
+}
+
+tMediaReadPktsToQueueResult tMediaPlayerContext::readTrickPlayPacketsToQueue(int64_t maxBytes) {
+    int speed = trick_play_speed;
+    for (int i = 0; i < READ_PKT_MAX_BATCH_SIZE; i ++) {
+        if (video_pkt_queue->count() >= TRICK_PLAY_MAX_QUEUED_KEY_FRAMES || video_pkt_queue->sizeInBytes.load() > maxBytes) {
+            return ReadToQueueFull;
+        }
+        auto result = readPacket();
+        if (result == ReadVideoSuccess) {
+            int64_t ts = pkt->dts != AV_NOPTS_VALUE ? pkt->dts : pkt->pts;
+            if (!(pkt->flags & AV_PKT_FLAG_KEY) || ts == AV_NOPTS_VALUE) {
+                av_packet_unref(pkt);
+                continue;
+            }
+            int64_t last = trick_play_last_key_ts;
+            if (last != AV_NOPTS_VALUE && (speed > 0 ? ts <= last : ts >= last)) {
+                av_packet_unref(pkt);
+                if (speed < 0) {
+                    // Seek landed on a key frame already shown, go further back.
+                    trick_play_step_scale *= 2;
+                    if (trick_play_step_scale > TRICK_PLAY_MAX_STEP_SCALE || !seekToNextTrickPlayKeyFrame(speed)) {
+                        result = ReadEof;
+                    }
+                }
+                if (result != ReadEof) {
+                    continue;
+                }
+            } else {
+                if (pkt->pts != AV_NOPTS_VALUE) {
+                    last_read_pkt_millis = ptsToMillis(pkt->pts, pkt->time_base);
+                }
+                last_video_pkt_dts = pkt->dts;
+                trick_play_last_key_ts = ts;
+                trick_play_step_scale = 1;
+                video_pkt_queue->push(pkt, ptsToMillis(pkt->duration, pkt->time_base));
+                if (seekToNextTrickPlayKeyFrame(speed)) {
+                    continue;
+                }
+                result = ReadEof;
+            }
+        }
+        switch (result) {
+            case ReadEof:
+                if (!video_eof_pushed) {
+                    video_pkt_queue->pushEof();
+                    video_eof_pushed = true;
+                }
+                if (audio_stream != nullptr) {
+                    audio_pkt_queue->pushEof();
+                }
+                return ReadToQueueEof;
+            case ReadFail:
+                return ReadToQueueFail;
+            default:
+                // Audio, subtitle and attachment packets are discarded.
+                av_packet_unref(pkt);
+                break;
+        }
+    }
+    return ReadToQueueContinue;
+}
+
+bool tMediaPlayerContext::seekToNextTrickPlayKeyFrame(int speed) {
+    AVStream *st = video_stream;
+    int64_t last = trick_play_last_key_ts;
+    int64_t step = av_rescale_q((int64_t) speed * TRICK_PLAY_FRAME_INTERVAL_IN_MILLIS * trick_play_step_scale, AVRational {1, 1000}, st->time_base);
+    int64_t target = last + step;
+    int64_t start = st->start_time != AV_NOPTS_VALUE ? st->start_time : 0;
+    if (speed < 0 && last <= start) {
+        return false;
+    }
+    int64_t keyTs = AV_NOPTS_VALUE;
+    if (avformat_index_get_entries_count(st) > 0) {
+        int index = av_index_search_timestamp(st, target, speed > 0 ? 0 : AVSEEK_FLAG_BACKWARD);
+        if (index < 0 && speed < 0) {
+            // Target before first indexed key frame, use the previous one.
+            index = av_index_search_timestamp(st, last - 1, AVSEEK_FLAG_BACKWARD);
+        }
+        if (index >= 0) {
+            auto entry = avformat_index_get_entry(st, index);
+            if (entry != nullptr && (speed > 0 ? entry->timestamp > last : entry->timestamp < last)) {
+                keyTs = entry->timestamp;
+            }
+        }
+    }
+    int ret;
+    beginBlockingOp(BlockingOpSeek);
+    if (keyTs != AV_NOPTS_VALUE) {
+        ret = endBlockingOp(av_seek_frame(format_ctx, st->index, keyTs, AVSEEK_FLAG_BACKWARD));
+    } else if (speed > 0) {
+        ret = endBlockingOp(avformat_seek_file(format_ctx, st->index, target, target, INT64_MAX, 0));
+    } else {
+        ret = endBlockingOp(avformat_seek_file(format_ctx, st->index, INT64_MIN, FFMAX(target, start), FFMAX(target, start), AVSEEK_FLAG_BACKWARD));
+    }
+    if (ret < 0) {
+        // Fast forward keep reading key frames in order.
+        LOGE("Trick play seek fail: %d", ret);
+        return speed > 0;
+    }
+    return true;
+}
+
+tMediaReadPktsToQueueResult tMediaPlayerContext::readReversePacketsToQueue() {
+    // Audio renderer reaches eof, video master clock runs backward.
+    if (audio_stream != nullptr && !reverse_audio_eof_pushed) {
+        audio_pkt_queue->pushEof();
+    }
+    reverse_audio_eof_pushed = true;
+    return ReadToQueueEof;
+}
+
+tMediaOptResult tMediaPlayerContext::setReversePlayback(bool enabled, int64_t cacheSizeInBytes) {
+    if (!enabled) {
+        reverse_playback = false;
+        if (video_reverse != nullptr) {
+            // Free cached frames.
+            video_reverse->stop();
+        }
+        return OptSuccess;
+    }
+    if (video_stream == nullptr || videoIsAttachPic) {
+        LOGE("Reverse playback need video stream.");
+        return OptFail;
+    }
+    if (video_reverse == nullptr) {
+        // Own demuxer and software decoder, player's demuxer and decoder state are kept for switching back.
+        auto reverse = new tMediaReverseDecoder;
+        if (!reverse->prepare(media_file, video_stream->index, cacheSizeInBytes, video_decode_threads.requestType, video_decode_threads.requestCount)) {
+            LOGE("Prepare reverse decoder fail.");
+            reverse->release();
+            return OptFail;
+        }
+        video_reverse = reverse;
+    }
+    reverse_playback = true;
+    return OptSuccess;
+}
+
 void tMediaPlayerContext::movePacketRef(AVPacket *target) {
     av_packet_move_ref(target, pkt);
 //    if (video_stream && video_stream->index == pkt->stream_index) {
@@ -506,10 +1033,23 @@ tMediaOptResult tMediaPlayerContext::resumeReadPacket() {
 
 tMediaOptResult tMediaPlayerContext::seekTo(int64_t targetPosInMillis) {
     int64_t seekTs = targetPosInMillis * AV_TIME_BASE / 1000L;
-    int ret = avformat_seek_file(format_ctx, -1, INT64_MIN, seekTs, INT64_MAX, AVSEEK_FLAG_BACKWARD);
+    beginBlockingOp(BlockingOpSeek);
+    int ret = endBlockingOp(avformat_seek_file(format_ctx, -1, INT64_MIN, seekTs, INT64_MAX, AVSEEK_FLAG_BACKWARD));
     if (ret < 0) {
         return OptFail;
     } else {
+        last_video_pkt_dts = AV_NOPTS_VALUE;
+        last_read_pkt_millis = -1;
+        video_skip_until_dts = AV_NOPTS_VALUE;
+        subtitle_skip_until_millis = -1;
+        audio_skip_until_pts = AV_NOPTS_VALUE;
+        video_eof_pushed = false;
+        trick_play_last_key_ts = AV_NOPTS_VALUE;
+        trick_play_step_scale = 1;
+        reverse_audio_eof_pushed = false;
+        if (reverse_playback && video_reverse != nullptr) {
+            video_reverse->start(targetPosInMillis);
+        }
         return OptSuccess;
     }
 }
@@ -554,11 +1094,230 @@ tMediaDecodeResult tMediaPlayerContext::decodeVideo(AVPacket *targetPkt) {
     if (targetPkt != nullptr) {
         av_packet_move_ref(video_pkt, targetPkt);
     }
-    return decode(video_decoder_ctx, video_frame, video_pkt);
+    return decodeVideoPkt(-1);
+}
+
+tMediaDecodeResult tMediaPlayerContext::decodeVideoPkt(int64_t masterClockInMillis) {
+    auto &threads = video_decode_threads;
+    // Only software decoder in use supports lowres, hardware decoder may fallback to software.
+    bool lowresChanged = video_decoder_ctx->hw_device_ctx == nullptr && video_decoder->max_lowres > 0 && videoLowres() != video_decoder_ctx->lowres;
+    if ((threads.retuneThreadCount > 0 || lowresChanged) && video_pkt->flags & AV_PKT_FLAG_KEY) {
+        int threadCount = threads.retuneThreadCount > 0 ? threads.retuneThreadCount : threads.appliedCount.load();
+        threads.retuneThreadCount = 0;
+        reopenVideoDecoder(threadCount);
+    }
+    bool trickPlay = trick_play_speed != 0;
+    if (trickPlay != video_trick_play_applied) {
+        video_trick_play_applied = trickPlay;
+        // Restore degrade level's discard settings.
+        video_degrade.reset();
+    }
+    if (trickPlay) {
+        video_decoder_ctx->skip_frame = AVDISCARD_NONKEY;
+    } else {
+        video_degrade.applyTo(video_decoder_ctx);
+    }
+    while (true) {
+        int64_t start = av_gettime_relative();
+        auto result = decode(video_decoder_ctx, video_frame, video_pkt);
+        if (result != DecodeSuccess && result != DecodeSuccessAndSkipNextPkt) {
+            return result;
+        }
+        if (threads.onFrameDecoded(av_gettime_relative() - start, video_fps)) {
+            LOGD("Video decoder will be reopened at next key frame.");
+        }
+        auto time_base = video_stream->time_base;
+        if (time_base.den <= 0 || video_frame->pts == AV_NOPTS_VALUE) {
+            return result;
+        }
+        int64_t ptsInMillis = ptsToMillis(video_frame->pts, time_base);
+        video_degrade.onFrameDecoded(ptsInMillis, video_degrade_enabled ? masterClockInMillis : -1);
+        if (!isLateVideoFrame(ptsInMillis, masterClockInMillis)) {
+            video_continuous_drops = 0;
+            return result;
+        }
+        av_frame_unref(video_frame);
+        video_continuous_drops ++;
+        video_late_dropped_frames ++;
+        LOGD("Drop late video frame: %lld, master clock: %lld", (long long) ptsInMillis, (long long) masterClockInMillis);
+        if (result == DecodeSuccess) {
+            return DecodeFailAndNeedMorePkt;
+        }
+        // Packet not sent, decode it again.
+    }
+}
+
+bool tMediaPlayerContext::isLateVideoFrame(int64_t framePtsInMillis, int64_t masterClockInMillis) {
+    if (!video_drop_late_frames || masterClockInMillis < 0 || videoIsAttachPic) {
+        return false;
+    }
+    if (video_continuous_drops >= LATE_FRAME_MAX_CONTINUOUS_DROPS) {
+        return false;
+    }
+    // Last frames, keep for renderer.
+    if (video_pkt_queue->count() <= 0) {
+        return false;
+    }
+    int64_t lag = masterClockInMillis - framePtsInMillis;
+    if (lag >= LATE_FRAME_NOSYNC_IN_MILLIS) {
+        return false;
+    }
+    int64_t frameDuration = ptsToMillis(video_frame->duration, video_stream->time_base);
+    return lag > FFMAX(frameDuration, (int64_t) LATE_FRAME_DROP_MIN_LAG_IN_MILLIS);
+}
+
+tMediaOptResult tMediaPlayerContext::reopenVideoDecoder(int threadCount) {
+    if (video_decoder_ctx->hw_device_ctx != nullptr || video_stream == nullptr) {
+        return OptFail;
+    }
+    AVCodecContext *newCtx = avcodec_alloc_context3(video_decoder);
+    if (!newCtx) {
+        LOGE("Create reopen video decoder ctx fail.");
+        return OptFail;
+    }
+    int result = avcodec_parameters_to_context(newCtx, video_stream->codecpar);
+    if (result < 0) {
+        avcodec_free_context(&newCtx);
+        LOGE("Attach video params to reopen decoder ctx fail: %d", result);
+        return OptFail;
+    }
+    int oldType = video_decode_threads.appliedType;
+    int oldCount = video_decode_threads.appliedCount;
+    video_decode_threads.configure(newCtx, video_decoder, videoIsAttachPic, threadCount);
+    newCtx->lowres = videoLowres();
+    result = avcodec_open2(newCtx, video_decoder, nullptr);
+    if (result < 0) {
+        avcodec_free_context(&newCtx);
+        video_decode_threads.appliedType = oldType;
+        video_decode_threads.appliedCount = oldCount;
+        LOGE("Open reopen video decoder ctx fail: %d", result);
+        return OptFail;
+    }
+    avcodec_free_context(&video_decoder_ctx);
+    video_decoder_ctx = newCtx;
+    if (threadCount != oldCount) {
+        video_decode_threads.retuneCount ++;
+    }
+    video_decode_threads.resetCost();
+    // Apply skip flags of current degrade level to new ctx.
+    video_degrade.dirty = true;
+    LOGD("Reopen video decoder with %d threads, lowres: %d.", threadCount, newCtx->lowres);
+    return OptSuccess;
+}
+
+int tMediaPlayerContext::videoLowres() {
+    int targetWidth = video_target_width;
+    int targetHeight = video_target_height;
+    if (targetWidth == video_lowres_target_width && targetHeight == video_lowres_target_height) {
+        return video_lowres;
+    }
+    video_lowres_target_width = targetWidth;
+    video_lowres_target_height = targetHeight;
+    video_lowres = 0;
+    if (video_decoder == nullptr || targetWidth <= 0 || targetHeight <= 0) {
+        return video_lowres;
+    }
+    int w = video_stream->codecpar->width;
+    int h = video_stream->codecpar->height;
+    while (video_lowres < video_decoder->max_lowres && (w >> (video_lowres + 1)) >= targetWidth && (h >> (video_lowres + 1)) >= targetHeight) {
+        video_lowres ++;
+    }
+    return video_lowres;
+}
+
+int tMediaPlayerContext::videoDownscaleShift(int w, int h) {
+    return pixDownscaleShift(w, h, video_target_width, video_target_height, VIDEO_DOWNSCALE_MAX_SHIFT);
+}
+
+tMediaDecodeResult tMediaPlayerContext::decodeVideoFromQueue(bool skipPktRead, int64_t masterClockInMillis) {
+    if (!skipPktRead) {
+        int serial = -1;
+        auto popResult = video_pkt_queue->pop(video_pkt, &serial);
+        if (popResult == PopPktEmpty) {
+            return DecodeNoPkt;
+        }
+        if (serial != video_pkt_serial) {
+            LOGD("Serial changed, flush video decoder, serial: %d", serial);
+            video_pkt_serial = serial;
+            avcodec_flush_buffers(video_decoder_ctx);
+            video_degrade.reset();
+            video_continuous_drops = 0;
+            video_frame_step.onSerialChanged();
+        }
+        if (popResult == PopPktEof) {
+            return DecodePktEof;
+        }
+    }
+    return decodeVideoPkt(masterClockInMillis);
+}
+
+tMediaOptResult tMediaVideoBuffer::refFrame(AVFrame *src) {
+    if (frame == nullptr) {
+        frame = av_frame_alloc();
+        if (frame == nullptr) {
+            LOGE("Alloc video buffer ref frame fail.");
+            return OptFail;
+        }
+    }
+    av_frame_unref(frame);
+    int ret = av_frame_ref(frame, src);
+    if (ret < 0) {
+        LOGE("Ref decoded video frame fail: %d", ret);
+        return OptFail;
+    }
+    int rowBytes[4] = {0};
+    av_image_fill_linesizes(rowBytes, (AVPixelFormat) frame->format, frame->width);
+    auto desc = av_pix_fmt_desc_get((AVPixelFormat) frame->format);
+    for (int i = 0; i < 3; i ++) {
+        planes[i] = frame->data[i];
+        lineSizes[i] = frame->linesize[i];
+        planeRowBytes[i] = rowBytes[i];
+        if (i == 0 || desc == nullptr) {
+            planeRows[i] = frame->height;
+        } else {
+            planeRows[i] = AV_CEIL_RSHIFT(frame->height, desc->log2_chroma_h);
+        }
+    }
+    isFrameRef = true;
+    return OptSuccess;
 }
 
-void tMediaPlayerContext::flushVideoCodecBuffer() {
-    avcodec_flush_buffers(video_decoder_ctx);
+void tMediaVideoBuffer::unrefFrame() {
+    if (frame != nullptr) {
+        av_frame_unref(frame);
+    }
+    if (isFrameRef) {
+        for (int i = 0; i < 3; i ++) {
+            planes[i] = nullptr;
+            lineSizes[i] = 0;
+            planeRowBytes[i] = 0;
+            planeRows[i] = 0;
+        }
+        isFrameRef = false;
+    }
+}
+
+void tMediaVideoBuffer::release() {
+    unrefFrame();
+    if (frame != nullptr) {
+        av_frame_free(&frame);
+    }
+    if (rgbaBuffer != nullptr) {
+        free(rgbaBuffer);
+    }
+    if (yBuffer != nullptr) {
+        free(yBuffer);
+    }
+    if (uBuffer != nullptr) {
+        free(uBuffer);
+    }
+    if (vBuffer != nullptr) {
+        free(vBuffer);
+    }
+    if (uvBuffer != nullptr) {
+        free(uvBuffer);
+    }
+    delete this;
 }
 
 tMediaOptResult tMediaPlayerContext::moveDecodedVideoFrameToBuffer(tMediaVideoBuffer *videoBuffer) {
@@ -568,7 +1327,11 @@ tMediaOptResult tMediaPlayerContext::moveDecodedVideoFrameToBuffer(tMediaVideoBu
 //    auto colorRange = frame->color_range;
 //    auto colorPrimaries = frame->color_primaries;
 //    auto colorSpace = frame->colorspace;
-    if (format == AV_PIX_FMT_YUV420P) {
+    // Frames much larger than view are downscaled, referenced without copy only at decoded size.
+    int downscaleShift = videoDownscaleShift(w, h);
+    int outW = w >> downscaleShift;
+    int outH = h >> downscaleShift;
+    if (downscaleShift == 0 && format == AV_PIX_FMT_YUV420P) {
         if (w % YUV_ALIGN_SIZE == 0) {
             videoBuffer->width = w;
         } else {
@@ -579,47 +1342,14 @@ tMediaOptResult tMediaPlayerContext::moveDecodedVideoFrameToBuffer(tMediaVideoBu
         int ySize = av_image_get_buffer_size(AV_PIX_FMT_GRAY8, videoBuffer->width, videoBuffer->height, 1);
         int uSize = (yuvSize - ySize) / 2;
         int vSize = uSize;
-
-        // alloc Y buffer if need.
-        if (videoBuffer->yBufferSize < ySize || videoBuffer->yBuffer == nullptr) {
-            if (videoBuffer->yBuffer != nullptr) {
-                free(videoBuffer->yBuffer);
-            }
-            videoBuffer->yBuffer = static_cast<uint8_t *>(av_malloc(ySize * sizeof(uint8_t)));
-            videoBuffer->yBufferSize = ySize;
-        }
-
-        // alloc U buffer if need.
-        if (videoBuffer->uBufferSize < uSize || videoBuffer->uBuffer == nullptr) {
-            if (videoBuffer->uBuffer != nullptr) {
-                free(videoBuffer->uBuffer);
-            }
-            videoBuffer->uBuffer = static_cast<uint8_t *>(av_malloc(uSize * sizeof(uint8_t)));
-            videoBuffer->uBufferSize = uSize;
-        }
-
-        // // alloc V buffer if need.
-        if (videoBuffer->vBufferSize < vSize || videoBuffer->vBuffer == nullptr) {
-            if (videoBuffer->vBuffer != nullptr) {
-                free(videoBuffer->vBuffer);
-            }
-            videoBuffer->vBuffer = static_cast<uint8_t *>(av_malloc(vSize * sizeof(uint8_t)));
-            videoBuffer->vBufferSize = vSize;
+        if (videoBuffer->refFrame(video_frame) != OptSuccess) {
+            return OptFail;
         }
-        uint8_t *yBuffer = videoBuffer->yBuffer;
-        uint8_t *uBuffer = videoBuffer->uBuffer;
-        uint8_t *vBuffer = videoBuffer->vBuffer;
-        int lineSize[AV_NUM_DATA_POINTERS];
-        av_image_fill_linesizes(lineSize, AV_PIX_FMT_YUV420P, videoBuffer->width);
-        // Copy yuv data to video frame.
-        av_image_copy_plane(yBuffer, lineSize[0], video_frame->data[0], video_frame->linesize[0], lineSize[0], h);
-        av_image_copy_plane(uBuffer, lineSize[1], video_frame->data[1], video_frame->linesize[1], lineSize[1], h / 2);
-        av_image_copy_plane(vBuffer, lineSize[2], video_frame->data[2], video_frame->linesize[2], lineSize[2], h / 2);
         videoBuffer->yContentSize = ySize;
         videoBuffer->uContentSize = uSize;
         videoBuffer->vContentSize = vSize;
         videoBuffer->type = Yuv420p;
-    } else if ((format == AV_PIX_FMT_NV12 || format == AV_PIX_FMT_NV21)) {
+    } else if (downscaleShift == 0 && (format == AV_PIX_FMT_NV12 || format == AV_PIX_FMT_NV21)) {
         if (w % YUV_ALIGN_SIZE == 0) {
             videoBuffer->width = w;
         } else {
@@ -634,35 +1364,9 @@ tMediaOptResult tMediaPlayerContext::moveDecodedVideoFrameToBuffer(tMediaVideoBu
         }
         int ySize =  av_image_get_buffer_size(AV_PIX_FMT_GRAY8, videoBuffer->width, videoBuffer->height, 1);
         int uvSize = yuvSize - ySize;
-        // alloc Y buffer if need.
-        if (videoBuffer->yBufferSize < ySize || videoBuffer->yBuffer == nullptr) {
-            if (videoBuffer->yBuffer != nullptr) {
-                free(videoBuffer->yBuffer);
-            }
-            videoBuffer->yBuffer = static_cast<uint8_t *>(av_malloc(ySize * sizeof(uint8_t)));
-            videoBuffer->yBufferSize = ySize;
-        }
-
-        // alloc UV buffer if need.
-        if (videoBuffer->uvBufferSize < uvSize || videoBuffer->uvBuffer == nullptr) {
-            if (videoBuffer->uvBuffer != nullptr) {
-                free(videoBuffer->uvBuffer);
-            }
-            videoBuffer->uvBuffer = static_cast<uint8_t *>(av_malloc(uvSize * sizeof(uint8_t)));
-            videoBuffer->uvBufferSize = uvSize;
-        }
-        uint8_t *yBuffer = videoBuffer->yBuffer;
-        uint8_t *uvBuffer = videoBuffer->uvBuffer;
-        int lineSize[AV_NUM_DATA_POINTERS];
-        if (format == AV_PIX_FMT_NV12) {
-            av_image_fill_linesizes(lineSize, AV_PIX_FMT_NV12, videoBuffer->width);
-        } else {
-            av_image_fill_linesizes(lineSize, AV_PIX_FMT_NV21, videoBuffer->width);
+        if (videoBuffer->refFrame(video_frame) != OptSuccess) {
+            return OptFail;
         }
-        // Copy Y buffer.
-        av_image_copy_plane(yBuffer, lineSize[0], video_frame->data[0], video_frame->linesize[0], lineSize[0], h);
-        // Copy UV buffer.
-        av_image_copy_plane(uvBuffer, lineSize[1], video_frame->data[1], video_frame->linesize[1], lineSize[1], h / 2);
         videoBuffer->yContentSize = ySize;
         videoBuffer->uvContentSize = uvSize;
         if (video_frame->format == AV_PIX_FMT_NV12) {
@@ -670,59 +1374,46 @@ tMediaOptResult tMediaPlayerContext::moveDecodedVideoFrameToBuffer(tMediaVideoBu
         } else {
             videoBuffer->type = Nv21;
         }
-    } else if (format == AV_PIX_FMT_RGBA) {
+    } else if (downscaleShift == 0 && format == AV_PIX_FMT_RGBA) {
         videoBuffer->width = w;
         videoBuffer->height = h;
         int rgbaSize = av_image_get_buffer_size(AV_PIX_FMT_RGBA, w, h, 1);
-        // alloc rgba data if need.
-        if (videoBuffer->rgbaBufferSize < rgbaSize || videoBuffer->rgbaBuffer == nullptr) {
-            if (videoBuffer->rgbaBuffer != nullptr) {
-                free(videoBuffer->rgbaBuffer);
-            }
-            videoBuffer->rgbaBuffer = static_cast<uint8_t *>(av_malloc(rgbaSize * sizeof(uint8_t)));
-            videoBuffer->rgbaBufferSize = rgbaSize;
+        if (videoBuffer->refFrame(video_frame) != OptSuccess) {
+            return OptFail;
         }
-        uint8_t *rgbaBuffer = videoBuffer->rgbaBuffer;
-        int lineSize[AV_NUM_DATA_POINTERS];
-        av_image_fill_linesizes(lineSize, AV_PIX_FMT_RGBA, videoBuffer->width);
-        av_image_copy_plane(rgbaBuffer, lineSize[0], video_frame->data[0], video_frame->linesize[0], lineSize[0], h);
-        // Copy RGBA data.
-        // copyFrameData(rgbaBuffer, frame->data[0], w, h, frame->linesize[0], 4);
         videoBuffer->rgbaContentSize = rgbaSize;
         videoBuffer->type = Rgba;
-    } else {
-        // Others format need to convert to Yuv420p.
-        if (w != video_width ||
-            h != video_height ||
-            video_sws_ctx == nullptr) {
-            LOGD("Decode video change rgbaSize, recreate sws ctx.");
-            if (video_sws_ctx != nullptr) {
-                sws_freeContext(video_sws_ctx);
-            }
-
-            this->video_sws_ctx = sws_getContext(
-                    w,
-                    h,
-                    (AVPixelFormat) video_frame->format,
-                    w,
-                    h,
-                    AV_PIX_FMT_YUV420P,
-                    SWS_BICUBIC,
-                    nullptr,
-                    nullptr,
-                    nullptr);
-            if (video_sws_ctx == nullptr) {
-                LOGE("Decode video fail, sws ctx create fail.");
-                return OptFail;
-            }
-        }
-
+    } else if (downscaleShift == 0 && video_high_bit_depth_passthrough && (format == AV_PIX_FMT_YUV420P10LE || format == AV_PIX_FMT_P010LE)) {
         if (w % YUV_ALIGN_SIZE == 0) {
             videoBuffer->width = w;
         } else {
             videoBuffer->width = w + (YUV_ALIGN_SIZE - (w % YUV_ALIGN_SIZE));
         }
         videoBuffer->height = h;
+        // 2 bytes per sample, chroma planes round up odd sizes.
+        int ySize = videoBuffer->width * videoBuffer->height * 2;
+        int chromaSize = ((videoBuffer->width + 1) / 2) * ((videoBuffer->height + 1) / 2) * 2;
+        if (videoBuffer->refFrame(video_frame) != OptSuccess) {
+            return OptFail;
+        }
+        videoBuffer->yContentSize = ySize;
+        if (format == AV_PIX_FMT_YUV420P10LE) {
+            videoBuffer->uContentSize = chromaSize;
+            videoBuffer->vContentSize = chromaSize;
+            videoBuffer->type = Yuv420p10;
+        } else {
+            // U and V interleaved.
+            videoBuffer->uvContentSize = chromaSize * 2;
+            videoBuffer->type = P010;
+        }
+    } else {
+        // Others format and downscaled frames need to convert to Yuv420p.
+        if (outW % YUV_ALIGN_SIZE == 0) {
+            videoBuffer->width = outW;
+        } else {
+            videoBuffer->width = outW + (YUV_ALIGN_SIZE - (outW % YUV_ALIGN_SIZE));
+        }
+        videoBuffer->height = outH;
         int yuvSize = av_image_get_buffer_size(AV_PIX_FMT_YUV420P, videoBuffer->width, videoBuffer->height, 1);
         int ySize = av_image_get_buffer_size(AV_PIX_FMT_GRAY8, videoBuffer->width, videoBuffer->height, 1);
         int uSize = (yuvSize - ySize) / 2;
@@ -758,13 +1449,33 @@ tMediaOptResult tMediaPlayerContext::moveDecodedVideoFrameToBuffer(tMediaVideoBu
         uint8_t *data[AV_NUM_DATA_POINTERS] = {videoBuffer->yBuffer, videoBuffer->uBuffer, videoBuffer->vBuffer};
         int lineSize[AV_NUM_DATA_POINTERS];
         av_image_fill_linesizes(lineSize, AV_PIX_FMT_YUV420P, videoBuffer->width);
-        // Convert to yuv420p.
-        int result = sws_scale(video_sws_ctx, video_frame->data, video_frame->linesize, 0, video_frame->height, data, lineSize);
-        if (result < 0) {
-            videoBuffer->type = UnknownImgType;
-            // Convert fail.
-            LOGE("Decode video sws scale fail: %d", result);
-            return OptFail;
+        // Common same size conversions and yuv420p downscale use simd kernels, others use sws.
+        bool converted;
+        if (downscaleShift > 0) {
+            converted = pixDownscaleYuv420p(video_frame, downscaleShift, data, lineSize);
+        } else {
+            converted = pixConvertToYuv420p(video_frame, data, lineSize, videoBuffer->width, videoBuffer->height);
+        }
+        if (!converted) {
+            if (!video_sws.ensureContext(video_frame, outW, outH, AV_PIX_FMT_YUV420P, downscaleShift > 0 ? SWS_AREA : SWS_BICUBIC)) {
+                LOGE("Decode video fail, sws ctx create fail.");
+                return OptFail;
+            }
+            // Convert to yuv420p, large frames are converted by slice threads.
+            int result = video_sws.scale(video_frame, data, lineSize);
+            if (result < 0) {
+                videoBuffer->type = UnknownImgType;
+                // Convert fail.
+                LOGE("Decode video sws scale fail: %d", result);
+                return OptFail;
+            }
+        }
+        videoBuffer->unrefFrame();
+        for (int i = 0; i < 3; i ++) {
+            videoBuffer->planes[i] = data[i];
+            videoBuffer->lineSizes[i] = lineSize[i];
+            videoBuffer->planeRowBytes[i] = lineSize[i];
+            videoBuffer->planeRows[i] = i == 0 ? videoBuffer->height : AV_CEIL_RSHIFT(videoBuffer->height, 1);
         }
         videoBuffer->yContentSize = ySize;
         videoBuffer->uContentSize = uSize;
@@ -790,15 +1501,176 @@ tMediaOptResult tMediaPlayerContext::moveDecodedVideoFrameToBuffer(tMediaVideoBu
     return OptSuccess;
 }
 
-tMediaDecodeResult tMediaPlayerContext::decodeAudio(AVPacket *targetPkt) {
-    if (targetPkt != nullptr) {
-        av_packet_move_ref(audio_pkt, targetPkt);
+static void writeVideoFrameDescriptor(int64_t *descriptor, tMediaVideoBuffer *buffer, int serial, int64_t deliverCostInMicros) {
+    descriptor[FrameDescPts] = buffer->pts;
+    descriptor[FrameDescDuration] = buffer->duration;
+    descriptor[FrameDescSerial] = serial;
+    descriptor[FrameDescImageType] = buffer->type;
+    descriptor[FrameDescWidth] = buffer->width;
+    descriptor[FrameDescHeight] = buffer->height;
+    descriptor[FrameDescDeliverCost] = deliverCostInMicros * 1000L;
+}
+
+tMediaDecodeToBuffersResult tMediaPlayerContext::decodeVideoToBuffers(tMediaVideoBuffer **buffers, int count, int64_t masterClockInMillis, int64_t *descriptors) {
+    if (reverse_playback && video_reverse != nullptr) {
+        return decodeReverseVideoToBuffers(buffers, count, descriptors);
     }
-    return decode(audio_decoder_ctx, audio_frame, audio_pkt);
+    auto &frameStep = video_frame_step;
+    // Resumed, return cached frames to decoder.
+    frameStep.trimIfDisabled();
+    // Frames of a backward step are before master clock, never drop them.
+    if (frameStep.isReplaying() || frameStep.isRedecoding() || frameStep.pendingRedecodeUntilPts != AV_NOPTS_VALUE) {
+        masterClockInMillis = -1;
+    }
+    int published = 0;
+    auto batchResult = DecodeToBuffersContinue;
+    for (int i = 0; i < DECODE_MAX_BATCH_SIZE; i ++) {
+        if (published >= count) {
+            batchResult = DecodeToBuffersFull;
+            break;
+        }
+        if (frameStep.isReplaying()) {
+            if (frameStep.popReplay(video_frame)) {
+                auto buffer = buffers[published];
+                int64_t start = av_gettime_relative();
+                if (moveDecodedVideoFrameToBuffer(buffer) == OptSuccess) {
+                    int64_t *descriptor = descriptors + DECODE_BATCH_HEADER_SIZE + published * VIDEO_FRAME_DESCRIPTOR_SIZE;
+                    writeVideoFrameDescriptor(descriptor, buffer, video_pkt_serial, av_gettime_relative() - start);
+                    published ++;
+                } else {
+                    LOGE("Move replay video frame fail.");
+                }
+                continue;
+            }
+            // Replay done, live decoder already reached eof.
+            if (frameStep.liveEof) {
+                batchResult = DecodeToBuffersEof;
+                break;
+            }
+        }
+        auto result = decodeVideoFromQueue(video_skip_next_pkt_read, masterClockInMillis);
+        video_skip_next_pkt_read = false;
+        if (result == DecodeNoPkt) {
+            batchResult = DecodeToBuffersNoPkt;
+            break;
+        }
+        if (result == DecodePktEof) {
+            frameStep.liveEof = true;
+            if (frameStep.isRedecoding()) {
+                // Showing frame not decoded again, replay from the last one.
+                frameStep.redecodeUntilPts = AV_NOPTS_VALUE;
+                if (frameStep.beginReplay(INT64_MAX)) {
+                    continue;
+                }
+            }
+            batchResult = DecodeToBuffersEof;
+            break;
+        }
+        if ((result == DecodeSuccess || result == DecodeSuccessAndSkipNextPkt) && frameStep.isRedecoding()) {
+            video_skip_next_pkt_read = result == DecodeSuccessAndSkipNextPkt;
+            // Cache only, delivered by replay.
+            frameStep.onRedecodedFrame(video_frame);
+            av_frame_unref(video_frame);
+        } else if (result == DecodeSuccess || result == DecodeSuccessAndSkipNextPkt) {
+            video_skip_next_pkt_read = result == DecodeSuccessAndSkipNextPkt;
+            frameStep.onLiveFrame(video_frame);
+            auto buffer = buffers[published];
+            int64_t start = av_gettime_relative();
+            if (moveDecodedVideoFrameToBuffer(buffer) == OptSuccess) {
+                int64_t *descriptor = descriptors + DECODE_BATCH_HEADER_SIZE + published * VIDEO_FRAME_DESCRIPTOR_SIZE;
+                writeVideoFrameDescriptor(descriptor, buffer, video_pkt_serial, av_gettime_relative() - start);
+                published ++;
+            } else {
+                LOGE("Move video frame fail.");
+            }
+        } else if (result == DecodeFail) {
+            LOGE("Decode video fail.");
+        }
+    }
+    descriptors[0] = published;
+    return batchResult;
 }
 
-void tMediaPlayerContext::flushAudioCodecBuffer() {
-    avcodec_flush_buffers(audio_decoder_ctx);
+tMediaDecodeToBuffersResult tMediaPlayerContext::decodeReverseVideoToBuffers(tMediaVideoBuffer **buffers, int count, int64_t *descriptors) {
+    video_reverse->targetWidth = video_target_width.load();
+    video_reverse->targetHeight = video_target_height.load();
+    // No packet popped, frames belong to current seek.
+    int serial = video_pkt_queue->serial;
+    int published = 0;
+    auto batchResult = DecodeToBuffersContinue;
+    for (int i = 0; i < DECODE_MAX_BATCH_SIZE; i ++) {
+        if (published >= count) {
+            batchResult = DecodeToBuffersFull;
+            break;
+        }
+        auto popResult = video_reverse->popFrame(video_frame);
+        if (popResult == ReversePopWaiting) {
+            break;
+        }
+        if (popResult == ReversePopEnd) {
+            batchResult = DecodeToBuffersEof;
+            break;
+        }
+        auto buffer = buffers[published];
+        int64_t start = av_gettime_relative();
+        if (moveDecodedVideoFrameToBuffer(buffer) == OptSuccess) {
+            int64_t *descriptor = descriptors + DECODE_BATCH_HEADER_SIZE + published * VIDEO_FRAME_DESCRIPTOR_SIZE;
+            writeVideoFrameDescriptor(descriptor, buffer, serial, av_gettime_relative() - start);
+            published ++;
+        } else {
+            LOGE("Move reverse video frame fail.");
+        }
+    }
+    descriptors[0] = published;
+    return batchResult;
+}
+
+int64_t tMediaPlayerContext::stepVideoFrameBackward(int64_t showingPtsInMillis) {
+    auto &frameStep = video_frame_step;
+    auto time_base = video_stream->time_base;
+    int64_t showingPts = av_rescale_q(showingPtsInMillis, AVRational {1, 1000}, time_base);
+    if (frameStep.beginReplay(showingPts)) {
+        frameStep.stats.cacheHits ++;
+        LOGD("Step backward from %lld ms, replay cached frames.", (long long) showingPtsInMillis);
+        return -1;
+    }
+    frameStep.stats.cacheMisses ++;
+    frameStep.pendingRedecodeUntilPts = showingPts;
+    // Decode from the key frame of showing frame's GOP, or previous GOP if showing frame is the key frame.
+    int64_t seekPos = showingPtsInMillis - 1;
+    if (frameStep.lastKeyPts != AV_NOPTS_VALUE && frameStep.lastKeyPts < showingPts) {
+        seekPos = FFMIN(ptsToMillis(frameStep.lastKeyPts, time_base) + 1, seekPos);
+    }
+    seekPos = FFMAX(seekPos, (int64_t) 0);
+    LOGD("Step backward from %lld ms, not cached, decode from %lld ms.", (long long) showingPtsInMillis, (long long) seekPos);
+    return seekPos;
+}
+
+tMediaDecodeResult tMediaPlayerContext::decodeAudioFromQueue(bool skipPktRead) {
+    if (!skipPktRead) {
+        int serial = -1;
+        tMediaPacketQueuePopResult popResult;
+        while (true) {
+            popResult = audio_pkt_queue->pop(audio_pkt, &serial);
+            // Skip old stream packets after audio stream switched.
+            if (popResult != PopPktSuccess || audio_pkt->stream_index == audio_stream->index) {
+                break;
+            }
+            av_packet_unref(audio_pkt);
+        }
+        if (popResult == PopPktEmpty) {
+            return DecodeNoPkt;
+        }
+        if (serial != audio_pkt_serial) {
+            LOGD("Serial changed, flush audio decoder, serial: %d", serial);
+            audio_pkt_serial = serial;
+            avcodec_flush_buffers(audio_decoder_ctx);
+        }
+        if (popResult == PopPktEof) {
+            return DecodePktEof;
+        }
+    }
+    return decode(audio_decoder_ctx, audio_frame, audio_pkt);
 }
 
 tMediaOptResult tMediaPlayerContext::moveDecodedAudioFrameToBuffer(tMediaAudioBuffer *audioBuffer) {
@@ -850,18 +1722,42 @@ tMediaOptResult tMediaPlayerContext::moveDecodedAudioFrameToBuffer(tMediaAudioBu
     return OptSuccess;
 }
 
-void releaseMetadata(Metadata *src) {
-    for (int i = 0; i < src->metadataCount; i ++) {
-        char *key = src->metadata[i * 2];
-        char *value = src->metadata[i * 2 + 1];
-        free(key);
-        free(value);
-        src->metadata[i * 2] = nullptr;
-        src->metadata[i * 2 + 1] = nullptr;
+tMediaDecodeToBuffersResult tMediaPlayerContext::decodeAudioToBuffers(tMediaAudioBuffer **buffers, int count, int64_t *descriptors) {
+    int published = 0;
+    auto batchResult = DecodeToBuffersContinue;
+    for (int i = 0; i < DECODE_MAX_BATCH_SIZE; i ++) {
+        if (published >= count) {
+            batchResult = DecodeToBuffersFull;
+            break;
+        }
+        auto result = decodeAudioFromQueue(audio_skip_next_pkt_read);
+        audio_skip_next_pkt_read = false;
+        if (result == DecodeNoPkt) {
+            batchResult = DecodeToBuffersNoPkt;
+            break;
+        }
+        if (result == DecodePktEof) {
+            batchResult = DecodeToBuffersEof;
+            break;
+        }
+        if (result == DecodeSuccess || result == DecodeSuccessAndSkipNextPkt) {
+            audio_skip_next_pkt_read = result == DecodeSuccessAndSkipNextPkt;
+            auto buffer = buffers[published];
+            if (moveDecodedAudioFrameToBuffer(buffer) == OptSuccess) {
+                int64_t *descriptor = descriptors + DECODE_BATCH_HEADER_SIZE + published * AUDIO_FRAME_DESCRIPTOR_SIZE;
+                descriptor[FrameDescPts] = buffer->pts;
+                descriptor[FrameDescDuration] = buffer->duration;
+                descriptor[FrameDescSerial] = audio_pkt_serial;
+                published ++;
+            } else {
+                LOGE("Move audio frame fail.");
+            }
+        } else if (result == DecodeFail) {
+            LOGE("Decode audio fail.");
+        }
     }
-    src->metadataCount = 0;
-    free(src->metadata);
-    src->metadata = nullptr;
+    descriptors[0] = published;
+    return batchResult;
 }
 
 void tMediaPlayerContext::release() {
@@ -876,6 +1772,20 @@ void tMediaPlayerContext::release() {
         format_ctx = nullptr;
     }
 
+    video_frame_step.clear();
+
+    // Reverse decoder has its own demuxer, worker thread is joined.
+    if (video_reverse != nullptr) {
+        video_reverse->release();
+        video_reverse = nullptr;
+    }
+
+    // Custom io need release after format_ctx closed.
+    if (io_ctx != nullptr) {
+        io_ctx->release();
+        io_ctx = nullptr;
+    }
+
     // File Metadata
     releaseMetadata(&fileMetadata);
 
@@ -894,10 +1804,8 @@ void tMediaPlayerContext::release() {
         av_buffer_unref(&hardware_ctx);
         hardware_ctx = nullptr;
     }
-    if (video_sws_ctx != nullptr) {
-        sws_freeContext(video_sws_ctx);
-        video_sws_ctx = nullptr;
-    }
+    video_hw_pix_fmt = AV_PIX_FMT_NONE;
+    video_sws.freeContext();
     if (video_frame != nullptr) {
         av_frame_unref(video_frame);
         av_frame_free(&video_frame);
@@ -947,6 +1855,22 @@ void tMediaPlayerContext::release() {
         audioMetadata = nullptr;
     }
 
+    if (audioStreams != nullptr) {
+        for (int i = 0; i < audioStreamCount; i ++) {
+            auto s = audioStreams[i];
+            releaseMetadata(&s->streamMetadata);
+            delete s;
+        }
+        free(audioStreams);
+        audioStreamCount = 0;
+        audioStreams = nullptr;
+    }
+
+    // Packet queues and interrupt owned by Java player.
+    video_pkt_queue = nullptr;
+    audio_pkt_queue = nullptr;
+    interrupt_ctx = nullptr;
+
     // Subtitle free
     if (subtitleStreams != nullptr) {
         for (int i = 0; i < subtitleStreamCount; i ++) {
@@ -959,6 +1883,6 @@ void tMediaPlayerContext::release() {
         subtitleStreams = nullptr;
     }
 
-    free(this);
     LOGD("Release media player");
+    delete this;
 }
@@ -0,0 +1,205 @@
+//
+// Created by pengcheng.tan on 2024/8/16.
+//
+#include <mutex>
+#include <sys/stat.h>
+#include "tmediaprobecache.h"
+#include "tmediaio.h"
+#include "tmediaplayer.h"
+
+extern "C" {
+#include "libavutil/time.h"
+}
+
+static std::mutex probeCacheLock;
+static tMediaProbeCacheEntry *probeCacheEntries[PROBE_CACHE_MAX_ENTRY_COUNT] = {nullptr};
+static int64_t probeCacheUseCounter = 0;
+static tMediaProbeCacheStats probeCacheStats;
+
+void tMediaProbeCacheEntry::release() {
+    if (path != nullptr) {
+        free(path);
+        path = nullptr;
+    }
+    if (streams != nullptr) {
+        for (unsigned int i = 0; i < streamCount; i ++) {
+            avcodec_parameters_free(&streams[i].codecpar);
+        }
+        delete[] streams;
+        streams = nullptr;
+    }
+    delete this;
+}
+
+static bool readFileKey(const char *file, int64_t *fileSize, int64_t *mtimeInNanos) {
+    if (!isLocalFilePath(file)) {
+        return false;
+    }
+    const char *path = file;
+    if (strncmp(path, "file://", 7) == 0) {
+        path = path + 7;
+    }
+    struct stat st {};
+    if (stat(path, &st) != 0) {
+        return false;
+    }
+    *fileSize = st.st_size;
+    *mtimeInNanos = (int64_t) st.st_mtim.tv_sec * 1000000000L + st.st_mtim.tv_nsec;
+    return true;
+}
+
+/**
+ * Need probeCacheLock.
+ */
+static int findEntryIndex(const char *file) {
+    for (int i = 0; i < PROBE_CACHE_MAX_ENTRY_COUNT; i ++) {
+        auto e = probeCacheEntries[i];
+        if (e != nullptr && strcmp(e->path, file) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Need probeCacheLock.
+ */
+static bool applyEntry(tMediaProbeCacheEntry *entry, AVFormatContext *format_ctx) {
+    if (entry->iformat != format_ctx->iformat || entry->streamCount != format_ctx->nb_streams) {
+        return false;
+    }
+    // Streams created by demuxer header must be same as cached.
+    for (unsigned int i = 0; i < entry->streamCount; i ++) {
+        auto s = format_ctx->streams[i];
+        auto cached = entry->streams + i;
+        if (s->codecpar->codec_type != cached->codecType || s->id != cached->id) {
+            return false;
+        }
+    }
+    for (unsigned int i = 0; i < entry->streamCount; i ++) {
+        auto s = format_ctx->streams[i];
+        auto cached = entry->streams + i;
+        if (avcodec_parameters_copy(s->codecpar, cached->codecpar) < 0) {
+            return false;
+        }
+        s->avg_frame_rate = cached->avgFrameRate;
+        s->r_frame_rate = cached->rFrameRate;
+        s->sample_aspect_ratio = cached->sampleAspectRatio;
+        s->start_time = cached->startTime;
+        s->duration = cached->duration;
+        s->nb_frames = cached->nbFrames;
+    }
+    format_ctx->start_time = entry->startTime;
+    format_ctx->duration = entry->duration;
+    format_ctx->bit_rate = entry->bitRate;
+    return true;
+}
+
+static tMediaProbeCacheEntry *createEntry(AVFormatContext *format_ctx, const char *file, int64_t fileSize, int64_t mtimeInNanos) {
+    auto entry = new tMediaProbeCacheEntry;
+    int pathLen = strlen(file);
+    entry->path = static_cast<char *>(malloc((pathLen + 1) * sizeof(char)));
+    memcpy(entry->path, file, pathLen);
+    entry->path[pathLen] = '\0';
+    entry->fileSize = fileSize;
+    entry->mtimeInNanos = mtimeInNanos;
+    entry->iformat = format_ctx->iformat;
+    entry->startTime = format_ctx->start_time;
+    entry->duration = format_ctx->duration;
+    entry->bitRate = format_ctx->bit_rate;
+    entry->streamCount = format_ctx->nb_streams;
+    entry->streams = new tMediaProbeStream[entry->streamCount];
+    for (unsigned int i = 0; i < entry->streamCount; i ++) {
+        auto s = format_ctx->streams[i];
+        auto cached = entry->streams + i;
+        cached->codecType = s->codecpar->codec_type;
+        cached->id = s->id;
+        // Contains extradata.
+        cached->codecpar = avcodec_parameters_alloc();
+        if (cached->codecpar == nullptr || avcodec_parameters_copy(cached->codecpar, s->codecpar) < 0) {
+            entry->release();
+            return nullptr;
+        }
+        cached->avgFrameRate = s->avg_frame_rate;
+        cached->rFrameRate = s->r_frame_rate;
+        cached->sampleAspectRatio = s->sample_aspect_ratio;
+        cached->startTime = s->start_time;
+        cached->duration = s->duration;
+        cached->nbFrames = s->nb_frames;
+    }
+    return entry;
+}
+
+int findStreamInfoWithCache(AVFormatContext *format_ctx, const char *file) {
+    int64_t start = av_gettime_relative();
+    int64_t fileSize = 0;
+    int64_t mtimeInNanos = 0;
+    bool canCache = readFileKey(file, &fileSize, &mtimeInNanos);
+    if (canCache) {
+        std::lock_guard<std::mutex> lk(probeCacheLock);
+        int index = findEntryIndex(file);
+        if (index >= 0) {
+            auto entry = probeCacheEntries[index];
+            if (entry->fileSize == fileSize && entry->mtimeInNanos == mtimeInNanos && applyEntry(entry, format_ctx)) {
+                entry->lastUsed = ++ probeCacheUseCounter;
+                int64_t cost = av_gettime_relative() - start;
+                probeCacheStats.hits ++;
+                probeCacheStats.hitsProbeTimeInMicros += cost;
+                LOGD("Probe cache hit: %s, cost %lldus", file, (long long) cost);
+                return 0;
+            }
+        }
+    }
+
+    int ret = avformat_find_stream_info(format_ctx, nullptr);
+    int64_t cost = av_gettime_relative() - start;
+    probeCacheStats.misses ++;
+    probeCacheStats.missesProbeTimeInMicros += cost;
+    LOGD("Probe cache miss: %s, cost %lldus", file, (long long) cost);
+    if (ret < 0 || !canCache) {
+        return ret;
+    }
+    auto newEntry = createEntry(format_ctx, file, fileSize, mtimeInNanos);
+    if (newEntry == nullptr) {
+        return ret;
+    }
+    std::lock_guard<std::mutex> lk(probeCacheLock);
+    newEntry->lastUsed = ++ probeCacheUseCounter;
+    int index = findEntryIndex(file);
+    if (index < 0) {
+        // Empty slot or least recently used entry.
+        index = 0;
+        for (int i = 0; i < PROBE_CACHE_MAX_ENTRY_COUNT; i ++) {
+            auto e = probeCacheEntries[i];
+            if (e == nullptr) {
+                index = i;
+                break;
+            }
+            if (e->lastUsed < probeCacheEntries[index]->lastUsed) {
+                index = i;
+            }
+        }
+    }
+    if (probeCacheEntries[index] != nullptr) {
+        probeCacheEntries[index]->release();
+    }
+    probeCacheEntries[index] = newEntry;
+    return ret;
+}
+
+void getProbeCacheStats(int64_t *target) {
+    target[0] = probeCacheStats.hits.load();
+    target[1] = probeCacheStats.misses.load();
+    target[2] = probeCacheStats.hitsProbeTimeInMicros.load();
+    target[3] = probeCacheStats.missesProbeTimeInMicros.load();
+}
+
+void clearProbeCache() {
+    std::lock_guard<std::mutex> lk(probeCacheLock);
+    for (int i = 0; i < PROBE_CACHE_MAX_ENTRY_COUNT; i ++) {
+        if (probeCacheEntries[i] != nullptr) {
+            probeCacheEntries[i]->release();
+            probeCacheEntries[i] = nullptr;
+        }
+    }
+}
@@ -0,0 +1,392 @@
+//
+// Created by pengcheng.tan on 2024/8/28.
+//
+#include "tmediareverse.h"
+#include "tmediaplayer.h"
+#include "tmediapixconvert.h"
+#include "tmediaprobecache.h"
+
+extern "C" {
+#include "libavutil/time.h"
+}
+
+void tMediaReverseGop::insert(AVFrame *f, int64_t fBytes, int64_t maxBytes) {
+    int pos = count;
+    while (pos > 0 && frames[pos - 1]->pts > f->pts) {
+        pos --;
+    }
+    // Drop oldest frames, dropped frames are always older than kept frames.
+    while (count > 0 && (count >= REVERSE_MAX_GOP_FRAMES || bytes + fBytes > maxBytes)) {
+        truncated = true;
+        if (pos == 0) {
+            av_frame_free(&f);
+            return;
+        }
+        bytes -= pixFrameBufferBytes(frames[0]);
+        av_frame_free(&frames[0]);
+        for (int i = 1; i < count; i ++) {
+            frames[i - 1] = frames[i];
+        }
+        count --;
+        frames[count] = nullptr;
+        pos --;
+    }
+    for (int i = count; i > pos; i --) {
+        frames[i] = frames[i - 1];
+    }
+    frames[pos] = f;
+    count ++;
+    bytes += fBytes;
+}
+
+void tMediaReverseGop::clear() {
+    for (int i = 0; i < count; i ++) {
+        av_frame_free(&frames[i]);
+    }
+    count = 0;
+    bytes = 0;
+    startTs = AV_NOPTS_VALUE;
+    endTs = AV_NOPTS_VALUE;
+    truncated = false;
+}
+
+bool tMediaReverseDecoder::prepare(const char *file, int streamIndex, int64_t cacheSizeInBytes, tMediaDecodeThreadType threadType, int threadCount) {
+    maxCacheBytes = FFMAX(cacheSizeInBytes, (int64_t) REVERSE_MIN_CACHE_SIZE);
+    format_ctx = avformat_alloc_context();
+    if (format_ctx == nullptr) {
+        LOGE("Alloc reverse format ctx fail.");
+        return false;
+    }
+    interrupt.attach(format_ctx);
+    interrupt.beginOp(BlockingOpOpenInput);
+    int ret = interrupt.endOp(avformat_open_input(&format_ctx, file, nullptr, nullptr));
+    if (ret < 0) {
+        LOGE("Reverse open file fail: %d", ret);
+        return false;
+    }
+    interrupt.beginOp(BlockingOpFindStreamInfo);
+    ret = interrupt.endOp(findStreamInfoWithCache(format_ctx, file));
+    if (ret < 0) {
+        LOGE("Reverse find stream info fail: %d", ret);
+        return false;
+    }
+    if (streamIndex < 0 || (unsigned int) streamIndex >= format_ctx->nb_streams || format_ctx->streams[streamIndex]->codecpar->codec_type != AVMEDIA_TYPE_VIDEO) {
+        LOGE("Reverse wrong video stream: %d", streamIndex);
+        return false;
+    }
+    video_stream = format_ctx->streams[streamIndex];
+    // Only demux video.
+    for (unsigned int i = 0; i < format_ctx->nb_streams; i ++) {
+        if (i != (unsigned int) streamIndex) {
+            format_ctx->streams[i]->discard = AVDISCARD_ALL;
+        }
+    }
+    video_decoder = avcodec_find_decoder(video_stream->codecpar->codec_id);
+    if (video_decoder == nullptr) {
+        LOGE("Reverse didn't find video decoder.");
+        return false;
+    }
+    video_decoder_ctx = avcodec_alloc_context3(video_decoder);
+    if (video_decoder_ctx == nullptr) {
+        LOGE("Create reverse video decoder ctx fail.");
+        return false;
+    }
+    ret = avcodec_parameters_to_context(video_decoder_ctx, video_stream->codecpar);
+    if (ret < 0) {
+        LOGE("Attach reverse video params to ctx fail: %d", ret);
+        return false;
+    }
+    // Latency of frame threading doesn't matter, whole GOP is decoded before emitting.
+    video_decode_threads.setRequest(threadType, threadCount);
+    video_decode_threads.configure(video_decoder_ctx, video_decoder, false, 0);
+    ret = avcodec_open2(video_decoder_ctx, video_decoder, nullptr);
+    if (ret < 0) {
+        LOGE("Open reverse video decoder ctx fail: %d", ret);
+        return false;
+    }
+    pkt = av_packet_alloc();
+    frame = av_frame_alloc();
+    if (pkt == nullptr || frame == nullptr) {
+        LOGE("Alloc reverse packet or frame fail.");
+        return false;
+    }
+    worker = new std::thread(&tMediaReverseDecoder::workerLoop, this);
+    LOGD("Prepare reverse decoder success, cacheSize=%lld", (long long) maxCacheBytes);
+    return true;
+}
+
+void tMediaReverseDecoder::start(int64_t positionInMillis) {
+    std::lock_guard<std::mutex> lk(lock);
+    for (auto gop : {emitting, prefetched}) {
+        updateCachedStats(-gop->bytes, -gop->count);
+        gop->clear();
+    }
+    prefetchReady = false;
+    reachedStart = false;
+    nextEndTs = av_rescale_q(positionInMillis, AVRational {1, 1000}, video_stream->time_base);
+    generation ++;
+    started = true;
+    cond.notify_all();
+    LOGD("Reverse start from %lld ms", (long long) positionInMillis);
+}
+
+void tMediaReverseDecoder::stop() {
+    std::lock_guard<std::mutex> lk(lock);
+    for (auto gop : {emitting, prefetched}) {
+        updateCachedStats(-gop->bytes, -gop->count);
+        gop->clear();
+    }
+    prefetchReady = false;
+    generation ++;
+    started = false;
+    cond.notify_all();
+}
+
+tMediaReversePopResult tMediaReverseDecoder::popFrame(AVFrame *target) {
+    std::unique_lock<std::mutex> lk(lock);
+    if (emitting->count <= 0) {
+        if (started && !prefetchReady && !reachedStart) {
+            int64_t waitStart = av_gettime_relative();
+            cond.wait_for(lk, std::chrono::milliseconds(REVERSE_WAIT_GOP_IN_MILLIS));
+            stats.stallTimeInMicros += av_gettime_relative() - waitStart;
+        }
+        if (prefetchReady) {
+            emitting->clear();
+            std::swap(emitting, prefetched);
+            prefetchReady = false;
+            // Decode next previous GOP.
+            cond.notify_all();
+        } else if (started && reachedStart) {
+            return ReversePopEnd;
+        } else {
+            return ReversePopWaiting;
+        }
+    }
+    emitting->count --;
+    AVFrame *f = emitting->frames[emitting->count];
+    emitting->frames[emitting->count] = nullptr;
+    int64_t fBytes = pixFrameBufferBytes(f);
+    emitting->bytes -= fBytes;
+    updateCachedStats(-fBytes, -1);
+    av_frame_unref(target);
+    av_frame_move_ref(target, f);
+    av_frame_free(&f);
+    stats.emittedFrames ++;
+    return ReversePopSuccess;
+}
+
+void tMediaReverseDecoder::workerLoop() {
+    std::unique_lock<std::mutex> lk(lock);
+    while (!stopWorker) {
+        if (!started || prefetchReady || reachedStart) {
+            cond.wait(lk);
+            continue;
+        }
+        int gen = generation;
+        int64_t endTs = nextEndTs;
+        lk.unlock();
+        int64_t start = av_gettime_relative();
+        bool success = decodeGop(endTs, decoding, gen);
+        int64_t cost = av_gettime_relative() - start;
+        lk.lock();
+        if (gen != generation) {
+            updateCachedStats(-decoding->bytes, -decoding->count);
+            decoding->clear();
+            continue;
+        }
+        if (!success) {
+            LOGD("Reverse reached start, GOP end: %lld", (long long) endTs);
+            reachedStart = true;
+            updateCachedStats(-decoding->bytes, -decoding->count);
+            decoding->clear();
+            cond.notify_all();
+            continue;
+        }
+        stats.decodedGops ++;
+        stats.gopDecodeTimeInMicros += cost;
+        nextEndTs = decoding->startTs;
+        LOGD("Reverse decode GOP [%lld, %lld), frames=%d, bytes=%lld, cost=%lld us", (long long) decoding->startTs, (long long) endTs,
+             decoding->count, (long long) decoding->bytes, (long long) cost);
+        if (decoding->count > 0) {
+            std::swap(prefetched, decoding);
+            prefetchReady = true;
+            cond.notify_all();
+        }
+    }
+}
+
+bool tMediaReverseDecoder::decodeGop(int64_t endTs, tMediaReverseGop *gop, int gen) {
+    int64_t streamStart = video_stream->start_time != AV_NOPTS_VALUE ? video_stream->start_time : 0;
+    if (endTs == AV_NOPTS_VALUE || endTs <= streamStart) {
+        return false;
+    }
+    gop->endTs = endTs;
+    int64_t step = FFMAX(av_rescale_q(REVERSE_SEEK_RETRY_STEP_IN_MILLIS, AVRational {1, 1000}, video_stream->time_base), (int64_t) 1);
+    int64_t target = endTs - 1;
+    for (int retry = 0; retry <= REVERSE_MAX_SEEK_RETRIES; retry ++) {
+        interrupt.beginOp(BlockingOpSeek);
+        int ret = interrupt.endOp(av_seek_frame(format_ctx, video_stream->index, FFMAX(target, streamStart), AVSEEK_FLAG_BACKWARD));
+        if (ret < 0) {
+            LOGE("Reverse seek fail: %d", ret);
+            return false;
+        }
+        avcodec_flush_buffers(video_decoder_ctx);
+        int64_t keyTs = AV_NOPTS_VALUE;
+        bool landedLate = false;
+        while (true) {
+            if (generation != gen) {
+                av_packet_unref(pkt);
+                return false;
+            }
+            av_packet_unref(pkt);
+            interrupt.beginOp(BlockingOpReadFrame);
+            ret = interrupt.endOp(av_read_frame(format_ctx, pkt));
+            if (ret < 0) {
+                // Eof or fail, drain decoder.
+                break;
+            }
+            if (pkt->stream_index != video_stream->index) {
+                continue;
+            }
+            int64_t pktTs = pkt->pts != AV_NOPTS_VALUE ? pkt->pts : pkt->dts;
+            bool isKey = pkt->flags & AV_PKT_FLAG_KEY;
+            if (keyTs == AV_NOPTS_VALUE) {
+                if (!isKey || pktTs == AV_NOPTS_VALUE) {
+                    continue;
+                }
+                if (pktTs >= endTs) {
+                    landedLate = true;
+                    break;
+                }
+                keyTs = pktTs;
+            } else if ((isKey && pktTs != AV_NOPTS_VALUE && pktTs >= endTs) || (pkt->dts != AV_NOPTS_VALUE && pkt->dts >= endTs)) {
+                // Frames of later packets are all after endTs.
+                break;
+            }
+            while (true) {
+                ret = avcodec_send_packet(video_decoder_ctx, pkt);
+                while (avcodec_receive_frame(video_decoder_ctx, frame) >= 0) {
+                    cacheFrame(frame, gop, keyTs);
+                }
+                if (ret != AVERROR(EAGAIN)) {
+                    if (ret < 0) {
+                        LOGE("Reverse send packet fail: %d", ret);
+                    }
+                    break;
+                }
+            }
+        }
+        av_packet_unref(pkt);
+        if (landedLate || keyTs == AV_NOPTS_VALUE) {
+            // Key frame before endTs not indexed, step back further.
+            if (target <= streamStart) {
+                return false;
+            }
+            target -= step;
+            step *= 2;
+            continue;
+        }
+        avcodec_send_packet(video_decoder_ctx, nullptr);
+        while (avcodec_receive_frame(video_decoder_ctx, frame) >= 0) {
+            cacheFrame(frame, gop, keyTs);
+        }
+        avcodec_flush_buffers(video_decoder_ctx);
+        gop->startTs = gop->truncated && gop->count > 0 ? gop->frames[0]->pts : keyTs;
+        return true;
+    }
+    LOGE("Reverse didn't find key frame before %lld", (long long) endTs);
+    return false;
+}
+
+void tMediaReverseDecoder::cacheFrame(AVFrame *src, tMediaReverseGop *gop, int64_t keyTs) {
+    stats.decodedFrames ++;
+    int64_t ts = src->pts != AV_NOPTS_VALUE ? src->pts : src->best_effort_timestamp;
+    if (ts == AV_NOPTS_VALUE || ts < keyTs || ts >= gop->endTs) {
+        av_frame_unref(src);
+        return;
+    }
+    AVFrame *cached = av_frame_alloc();
+    if (cached == nullptr) {
+        LOGE("Alloc reverse cached frame fail.");
+        av_frame_unref(src);
+        return;
+    }
+    int shift = pixDownscaleShift(src->width, src->height, targetWidth, targetHeight, VIDEO_DOWNSCALE_MAX_SHIFT);
+    if (shift > 0) {
+        cached->format = AV_PIX_FMT_YUV420P;
+        cached->width = src->width >> shift;
+        cached->height = src->height >> shift;
+        bool success = av_frame_get_buffer(cached, 0) >= 0;
+        if (success && !pixDownscaleYuv420p(src, shift, cached->data, cached->linesize)) {
+            success = sws.ensureContext(src, cached->width, cached->height, AV_PIX_FMT_YUV420P, SWS_AREA) &&
+                    sws.scale(src, cached->data, cached->linesize) >= 0;
+        }
+        if (!success) {
+            LOGE("Reverse downscale frame fail.");
+            av_frame_free(&cached);
+            av_frame_unref(src);
+            return;
+        }
+        av_frame_copy_props(cached, src);
+        av_frame_unref(src);
+    } else {
+        // Keep decoder's frame buffer without copy.
+        av_frame_move_ref(cached, src);
+    }
+    cached->pts = ts;
+    int countBefore = gop->count;
+    int64_t bytesBefore = gop->bytes;
+    gop->insert(cached, pixFrameBufferBytes(cached), maxCacheBytes / REVERSE_CACHED_GOP_COUNT);
+    updateCachedStats(gop->bytes - bytesBefore, gop->count - countBefore);
+}
+
+void tMediaReverseDecoder::updateCachedStats(int64_t bytesDelta, int framesDelta) {
+    int64_t bytes = stats.cachedBytes += bytesDelta;
+    stats.cachedFrames += framesDelta;
+    int64_t old = stats.peakCachedBytes.load();
+    while (bytes > old && !stats.peakCachedBytes.compare_exchange_weak(old, bytes)) {}
+}
+
+void tMediaReverseDecoder::writeStats(int64_t *target) {
+    target[0] = stats.cachedBytes.load();
+    target[1] = stats.peakCachedBytes.load();
+    target[2] = stats.cachedFrames.load();
+    target[3] = stats.decodedGops.load();
+    target[4] = stats.decodedFrames.load();
+    target[5] = stats.gopDecodeTimeInMicros.load();
+    target[6] = stats.emittedFrames.load();
+    target[7] = stats.stallTimeInMicros.load();
+}
+
+void tMediaReverseDecoder::release() {
+    // Blocking read of worker return.
+    interrupt.abort();
+    if (worker != nullptr) {
+        {
+            std::lock_guard<std::mutex> lk(lock);
+            stopWorker = true;
+            generation ++;
+            cond.notify_all();
+        }
+        worker->join();
+        delete worker;
+        worker = nullptr;
+    }
+    for (auto &gop : gops) {
+        gop.clear();
+    }
+    sws.freeContext();
+    if (video_decoder_ctx != nullptr) {
+        avcodec_free_context(&video_decoder_ctx);
+    }
+    if (format_ctx != nullptr) {
+        avformat_close_input(&format_ctx);
+    }
+    if (pkt != nullptr) {
+        av_packet_free(&pkt);
+    }
+    if (frame != nullptr) {
+        av_frame_free(&frame);
+    }
+    delete this;
+}
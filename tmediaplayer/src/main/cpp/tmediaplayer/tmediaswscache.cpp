@@ -0,0 +1,132 @@
+//
+// Created by pengcheng.tan on 2024/8/25.
+//
+#include <mutex>
+#include "tmediaswscache.h"
+#include "tmediaplayer.h"
+
+extern "C" {
+#include "libavutil/opt.h"
+}
+
+static std::mutex swsCacheLock;
+static tMediaSwsCacheEntry swsCacheEntries[SWS_CACHE_MAX_ENTRY_COUNT];
+static int64_t swsCacheUseCounter = 0;
+static tMediaSwsCacheStats swsCacheStats;
+
+bool tMediaSwsKey::equals(const tMediaSwsKey &other) const {
+    return srcWidth == other.srcWidth &&
+           srcHeight == other.srcHeight &&
+           srcFormat == other.srcFormat &&
+           srcFullRange == other.srcFullRange &&
+           dstWidth == other.dstWidth &&
+           dstHeight == other.dstHeight &&
+           dstFormat == other.dstFormat &&
+           flags == other.flags &&
+           threadCount == other.threadCount;
+}
+
+static SwsContext *createSwsContext(const tMediaSwsKey &key) {
+    auto ctx = sws_alloc_context();
+    if (ctx == nullptr) {
+        LOGE("Alloc sws ctx fail.");
+        return nullptr;
+    }
+    av_opt_set_int(ctx, "srcw", key.srcWidth, 0);
+    av_opt_set_int(ctx, "srch", key.srcHeight, 0);
+    av_opt_set_int(ctx, "src_format", key.srcFormat, 0);
+    av_opt_set_int(ctx, "src_range", key.srcFullRange ? 1 : 0, 0);
+    av_opt_set_int(ctx, "dstw", key.dstWidth, 0);
+    av_opt_set_int(ctx, "dsth", key.dstHeight, 0);
+    av_opt_set_int(ctx, "dst_format", key.dstFormat, 0);
+    av_opt_set_int(ctx, "sws_flags", key.flags, 0);
+    av_opt_set_int(ctx, "threads", key.threadCount, 0);
+    int ret = sws_init_context(ctx, nullptr, nullptr);
+    if (ret < 0) {
+        LOGE("Init sws ctx fail: %d", ret);
+        sws_freeContext(ctx);
+        return nullptr;
+    }
+    LOGD("Create sws ctx %dx%d -> %dx%d, slice threads: %d", key.srcWidth, key.srcHeight, key.dstWidth, key.dstHeight, key.threadCount);
+    return ctx;
+}
+
+SwsContext *acquireSwsContext(const tMediaSwsKey &key) {
+    {
+        std::lock_guard<std::mutex> lk(swsCacheLock);
+        for (auto &e : swsCacheEntries) {
+            if (e.ctx != nullptr && e.key.equals(key)) {
+                auto ctx = e.ctx;
+                e.ctx = nullptr;
+                swsCacheStats.hits ++;
+                return ctx;
+            }
+        }
+    }
+    swsCacheStats.misses ++;
+    return createSwsContext(key);
+}
+
+void recycleSwsContext(const tMediaSwsKey &key, SwsContext *ctx) {
+    if (ctx == nullptr) {
+        return;
+    }
+    SwsContext *evicted = nullptr;
+    {
+        std::lock_guard<std::mutex> lk(swsCacheLock);
+        // Empty slot or least recently used entry.
+        int index = 0;
+        for (int i = 0; i < SWS_CACHE_MAX_ENTRY_COUNT; i ++) {
+            auto &e = swsCacheEntries[i];
+            if (e.ctx == nullptr) {
+                index = i;
+                break;
+            }
+            if (e.lastUsed < swsCacheEntries[index].lastUsed) {
+                index = i;
+            }
+        }
+        auto &target = swsCacheEntries[index];
+        evicted = target.ctx;
+        target.key = key;
+        target.ctx = ctx;
+        target.lastUsed = ++ swsCacheUseCounter;
+    }
+    if (evicted != nullptr) {
+        swsCacheStats.evictions ++;
+        // Joins slice threads, free out of lock.
+        sws_freeContext(evicted);
+    }
+}
+
+void getSwsCacheStats(int64_t *target) {
+    target[0] = swsCacheStats.hits.load();
+    target[1] = swsCacheStats.misses.load();
+    target[2] = swsCacheStats.evictions.load();
+    int idle = 0;
+    {
+        std::lock_guard<std::mutex> lk(swsCacheLock);
+        for (auto &e : swsCacheEntries) {
+            if (e.ctx != nullptr) {
+                idle ++;
+            }
+        }
+    }
+    target[3] = idle;
+}
+
+void clearSwsCache() {
+    SwsContext *contexts[SWS_CACHE_MAX_ENTRY_COUNT] = {nullptr};
+    {
+        std::lock_guard<std::mutex> lk(swsCacheLock);
+        for (int i = 0; i < SWS_CACHE_MAX_ENTRY_COUNT; i ++) {
+            contexts[i] = swsCacheEntries[i].ctx;
+            swsCacheEntries[i].ctx = nullptr;
+        }
+    }
+    for (auto ctx : contexts) {
+        if (ctx != nullptr) {
+            sws_freeContext(ctx);
+        }
+    }
+}
@@ -0,0 +1,134 @@
+//
+// Created by pengcheng.tan on 2024/8/25.
+//
+#include <thread>
+#include "tmediaswsslice.h"
+#include "tmediaplayer.h"
+
+extern "C" {
+#include "libavutil/time.h"
+}
+
+static int autoSliceCount(int width, int height) {
+    int pixels = width * height;
+    int count;
+    if (pixels < SWS_SLICE_MIN_PIXELS) {
+        count = 1;
+    } else if (pixels <= 1920 * 1080) {
+        count = 2;
+    } else if (pixels <= 3840 * 2160) {
+        count = 4;
+    } else {
+        count = SWS_SLICE_MAX_THREAD_COUNT;
+    }
+    int cores = (int) std::thread::hardware_concurrency();
+    if (cores <= 0) {
+        cores = 1;
+    }
+    return count > cores ? cores : count;
+}
+
+static void noFree(void *, uint8_t *) {
+    // Buffers owned by caller.
+}
+
+void tMediaSlicedSws::setThreadCount(int count) {
+    if (count < 0) {
+        count = 0;
+    }
+    if (count > SWS_SLICE_MAX_THREAD_COUNT) {
+        count = SWS_SLICE_MAX_THREAD_COUNT;
+    }
+    requestCount = count;
+}
+
+bool tMediaSlicedSws::ensureContext(const AVFrame *src, int dstW, int dstH, AVPixelFormat dstFmt, int swsFlags) {
+    tMediaSwsKey newKey;
+    newKey.srcWidth = src->width;
+    newKey.srcHeight = src->height;
+    newKey.srcFormat = (AVPixelFormat) src->format;
+    newKey.srcFullRange = src->color_range == AVCOL_RANGE_JPEG;
+    newKey.dstWidth = dstW;
+    newKey.dstHeight = dstH;
+    newKey.dstFormat = dstFmt;
+    newKey.flags = swsFlags;
+    int count = requestCount;
+    if (count <= 0) {
+        count = autoSliceCount(dstW, dstH);
+    }
+    newKey.threadCount = count;
+    if (ctx != nullptr && newKey.equals(key)) {
+        return true;
+    }
+    if (ctx != nullptr) {
+        recycleSwsContext(key, ctx);
+        ctx = nullptr;
+    }
+    ctx = acquireSwsContext(newKey);
+    if (ctx == nullptr) {
+        return false;
+    }
+    key = newKey;
+    appliedCount = count;
+    return true;
+}
+
+int tMediaSlicedSws::scale(const AVFrame *src, uint8_t *const dstData[], const int dstLineSize[]) {
+    if (ctx == nullptr) {
+        return AVERROR(EINVAL);
+    }
+    int64_t start = av_gettime_relative();
+    int ret;
+    // Slice threads only work with frame api, not ref counted src would be copied.
+    if (appliedCount > 1 && src->buf[0] != nullptr) {
+        if (dstFrame == nullptr) {
+            dstFrame = av_frame_alloc();
+        }
+        if (dstFrame == nullptr) {
+            return AVERROR(ENOMEM);
+        }
+        dstFrame->width = key.dstWidth;
+        dstFrame->height = key.dstHeight;
+        dstFrame->format = key.dstFormat;
+        for (int i = 0; i < 4; i ++) {
+            dstFrame->data[i] = dstData[i];
+            dstFrame->linesize[i] = dstData[i] != nullptr ? dstLineSize[i] : 0;
+        }
+        dstFrame->buf[0] = av_buffer_create(dstData[0], (size_t) dstLineSize[0] * key.dstHeight, noFree, nullptr, 0);
+        if (dstFrame->buf[0] == nullptr) {
+            av_frame_unref(dstFrame);
+            return AVERROR(ENOMEM);
+        }
+        ret = sws_scale_frame(ctx, dstFrame, src);
+        av_frame_unref(dstFrame);
+    } else {
+        ret = sws_scale(ctx, src->data, src->linesize, 0, src->height, dstData, dstLineSize);
+    }
+    if (ret >= 0) {
+        int64_t cost = av_gettime_relative() - start;
+        convertedFrames ++;
+        convertCostSum += cost;
+        if (cost > maxConvertCost) {
+            maxConvertCost = cost;
+        }
+    }
+    return ret;
+}
+
+void tMediaSlicedSws::writeStats(int64_t *target) {
+    int64_t frames = convertedFrames;
+    target[0] = appliedCount;
+    target[1] = frames;
+    target[2] = frames > 0 ? convertCostSum / frames : 0;
+    target[3] = maxConvertCost;
+}
+
+void tMediaSlicedSws::freeContext() {
+    if (ctx != nullptr) {
+        recycleSwsContext(key, ctx);
+        ctx = nullptr;
+    }
+    if (dstFrame != nullptr) {
+        av_frame_free(&dstFrame);
+    }
+}
@@ -10,6 +10,8 @@ typedef struct tMediaSubtitlePktReaderContext {
     AVFormatContext *format_ctx = nullptr;
     AVStream *subtitle_stream = nullptr;
     AVPacket *pkt = nullptr;
+    // Release and load new file interrupt blocking io.
+    tMediaInterruptContext interrupt;
 
     tMediaOptResult prepare(const char *subtitle_file);
 
@@ -53,6 +53,34 @@ Java_com_tans_tmediaplayer_subtitle_ExternalSubtitle_movePacketRefNative(
     readerCtx->movePacketRef(pkt);
 }
 
+extern "C" JNIEXPORT void JNICALL
+Java_com_tans_tmediaplayer_subtitle_ExternalSubtitle_setTimeoutNative(
+        JNIEnv * env,
+        jobject j_subtitle,
+        jlong native_reader,
+        jlong timeout_in_millis) {
+    auto readerCtx = reinterpret_cast<tMediaSubtitlePktReaderContext *>(native_reader);
+    readerCtx->interrupt.setTimeout(timeout_in_millis);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_tans_tmediaplayer_subtitle_ExternalSubtitle_cancelNative(
+        JNIEnv * env,
+        jobject j_subtitle,
+        jlong native_reader) {
+    auto readerCtx = reinterpret_cast<tMediaSubtitlePktReaderContext *>(native_reader);
+    readerCtx->interrupt.cancel();
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_tans_tmediaplayer_subtitle_ExternalSubtitle_abortNative(
+        JNIEnv * env,
+        jobject j_subtitle,
+        jlong native_reader) {
+    auto readerCtx = reinterpret_cast<tMediaSubtitlePktReaderContext *>(native_reader);
+    readerCtx->interrupt.abort();
+}
+
 extern "C" JNIEXPORT void JNICALL
 Java_com_tans_tmediaplayer_subtitle_ExternalSubtitle_releaseNative(
         JNIEnv * env,
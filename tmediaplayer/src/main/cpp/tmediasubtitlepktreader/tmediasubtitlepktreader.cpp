@@ -25,15 +25,17 @@ tMediaOptResult tMediaSubtitlePktReaderContext::prepare(const char *subtitle_fil
         format_ctx = nullptr;
     }
     this->format_ctx = avformat_alloc_context();
+    interrupt.attach(format_ctx);
     LOGD("Prepare subtitle file: %s", subtitle_file);
-    int ret = avformat_open_input(&format_ctx, subtitle_file, nullptr, nullptr);
+    interrupt.beginOp(BlockingOpOpenInput);
+    int ret = interrupt.endOp(avformat_open_input(&format_ctx, subtitle_file, nullptr, nullptr));
     if (ret < 0) {
         LOGE("Open subtitle file fail: %s", subtitle_file);
         return OptFail;
     }
     LOGD("Input subtitle file format: %s", format_ctx->iformat->long_name);
 
-    for (int i = 0; i < format_ctx->nb_streams; i ++) {
+    for (unsigned int i = 0; i < format_ctx->nb_streams; i ++) {
         auto s = format_ctx->streams[i];
         if (isSupportSubtitleStream(s)) {
             subtitle_stream = s;
@@ -54,7 +56,8 @@ tMediaReadPktResult tMediaSubtitlePktReaderContext::readPacket() {
     if (format_ctx == nullptr || pkt == nullptr) {
         return ReadFail;
     }
-    int ret = av_read_frame(format_ctx, pkt);
+    interrupt.beginOp(BlockingOpReadFrame);
+    int ret = interrupt.endOp(av_read_frame(format_ctx, pkt));
     if (ret < 0) {
         if (ret == AVERROR_EOF || avio_feof(format_ctx->pb)) {
             return ReadEof;
@@ -76,7 +79,8 @@ tMediaOptResult tMediaSubtitlePktReaderContext::seekTo(int16_t targetPosInMillis
         return OptFail;
     }
     int64_t seekTs = targetPosInMillis * AV_TIME_BASE / 1000L;
-    int ret = avformat_seek_file(format_ctx, -1, INT64_MIN, seekTs, INT64_MAX, AVSEEK_FLAG_BACKWARD);
+    interrupt.beginOp(BlockingOpSeek);
+    int ret = interrupt.endOp(avformat_seek_file(format_ctx, -1, INT64_MIN, seekTs, INT64_MAX, AVSEEK_FLAG_BACKWARD));
     if (ret < 0) {
         return OptFail;
     } else {
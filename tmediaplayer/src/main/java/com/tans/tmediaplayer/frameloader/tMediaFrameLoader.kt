@@ -20,13 +20,16 @@ object tMediaFrameLoader {
 
     fun loadMediaFileFrame(
         mediaFile: String,
-        position: Long = 0L
+        position: Long = 0L,
+        // Blocking io longer than timeout is interrupted, 0 means no timeout.
+        timeoutInMillis: Long = DEFAULT_TIMEOUT_IN_MILLIS
     ): Bitmap? {
         val file = File(mediaFile)
         if (file.isFile && file.canRead()) {
             val start = SystemClock.uptimeMillis()
             val nativeLoader = createFrameLoaderNative()
             try {
+                setTimeoutNative(nativeLoader, timeoutInMillis)
                 var result = prepareNative(nativeLoader, mediaFile).toOptResult()
                 if (result != OptResult.Success) {
                     return null
@@ -61,6 +64,8 @@ object tMediaFrameLoader {
 
     private external fun prepareNative(nativeFrameLoader: Long, filePath: String): Int
 
+    private external fun setTimeoutNative(nativeFrameLoader: Long, timeoutInMillis: Long)
+
     private external fun getFrameNative(nativeFrameLoader: Long, position: Long): Int
 
     private external fun durationNative(nativeFrameLoader: Long): Long
@@ -76,4 +81,6 @@ object tMediaFrameLoader {
     private external fun releaseNative(nativeFrameLoader: Long)
 
     private const val TAG = "tMediaFrameLoader"
+
+    private const val DEFAULT_TIMEOUT_IN_MILLIS = 10_000L
 }
\ No newline at end of file
@@ -2,7 +2,7 @@ package com.tans.tmediaplayer.player
 
 import android.os.SystemClock
 import com.tans.tmediaplayer.player.model.NO_SYNC_THRESHOLD
-import com.tans.tmediaplayer.player.rwqueue.PacketQueue
+import com.tans.tmediaplayer.player.rwqueue.NativePacketQueue
 import kotlin.math.abs
 
 internal class Clock {
@@ -12,10 +12,10 @@ internal class Clock {
     private var speed: Double = 1.0
     private var serial: Int = -1
     private var paused: Boolean = true
-    private var packetQueue: PacketQueue? = null
+    private var packetQueue: NativePacketQueue? = null
 
     @Synchronized
-    fun initClock(pktQueue: PacketQueue?) {
+    fun initClock(pktQueue: NativePacketQueue?) {
         speed = 1.0
         paused = true
         packetQueue = pktQueue
@@ -1,6 +1,7 @@
 package com.tans.tmediaplayer.player
 
 import android.widget.TextView
+import com.tans.tmediaplayer.player.model.AudioTrackInfo
 import com.tans.tmediaplayer.player.model.MediaInfo
 import com.tans.tmediaplayer.player.model.OptResult
 import com.tans.tmediaplayer.player.model.SubtitleStreamInfo
@@ -40,4 +41,8 @@ internal interface IPlayer {
     fun loadExternalSubtitleFile(file: String)
 
     fun getExternalSubtitleFile(): String?
+
+    fun selectAudioTrack(track: AudioTrackInfo): OptResult
+
+    fun getSelectedAudioTrack(): AudioTrackInfo?
 }
\ No newline at end of file
@@ -5,18 +5,21 @@ import android.os.HandlerThread
 import android.os.Message
 import android.os.SystemClock
 import com.tans.tmediaplayer.MediaLog
-import com.tans.tmediaplayer.player.model.DecodeResult
-import com.tans.tmediaplayer.player.model.OptResult
+import com.tans.tmediaplayer.player.model.AUDIO_FRAME_DESCRIPTOR_SIZE
+import com.tans.tmediaplayer.player.model.DECODE_BATCH_HEADER_SIZE
+import com.tans.tmediaplayer.player.model.DECODE_MAX_BATCH_SIZE
+import com.tans.tmediaplayer.player.model.DecodeToBuffersResult
 import com.tans.tmediaplayer.player.rwqueue.AudioFrame
 import com.tans.tmediaplayer.player.rwqueue.AudioFrameQueue
-import com.tans.tmediaplayer.player.rwqueue.PacketQueue
+import com.tans.tmediaplayer.player.rwqueue.NativePacketQueue
 import com.tans.tmediaplayer.player.tMediaPlayer
 import java.util.concurrent.atomic.AtomicBoolean
 import java.util.concurrent.atomic.AtomicReference
+import kotlin.math.min
 
 internal class AudioFrameDecoder(
     private val player: tMediaPlayer,
-    private val audioPacketQueue: PacketQueue,
+    private val audioPacketQueue: NativePacketQueue,
     private val audioFrameQueue: AudioFrameQueue
 ) {
 
@@ -40,10 +43,14 @@ internal class AudioFrameDecoder(
     private val audioDecoderHandler: Handler by lazy {
         object : Handler(audioDecoderThread.looper) {
 
-            private var skipNextPktRead: Boolean = false
-
             private var packetSerial: Int = -1
 
+            private val batchFrames: Array<AudioFrame?> = arrayOfNulls(min(audioFrameQueue.maxQueueSize, DECODE_MAX_BATCH_SIZE))
+
+            private val batchNativeFrames: LongArray = LongArray(batchFrames.size)
+
+            private val descriptors: LongArray = LongArray(DECODE_BATCH_HEADER_SIZE + batchFrames.size * AUDIO_FRAME_DESCRIPTOR_SIZE)
+
             override fun handleMessage(msg: Message) {
                 super.handleMessage(msg)
                 synchronized(this@AudioFrameDecoder) {
@@ -52,82 +59,77 @@ internal class AudioFrameDecoder(
                     if (nativePlayer != null && state in activeStates) {
                         when (msg.what) {
                             DecoderHandlerMsg.RequestDecode.ordinal -> {
-                                if (skipNextPktRead || audioPacketQueue.isCanRead()) {
-                                    if (audioFrameQueue.isCanWrite()) {
-                                        val pkt = if (skipNextPktRead) {
-                                            null
-                                        } else {
-                                            audioPacketQueue.dequeueReadable()
-                                        }
-                                        val serialChanged = if (pkt != null) {
-                                            val changed = pkt.serial != packetSerial
-                                            packetSerial = pkt.serial
-                                            changed
+                                var count = 0
+                                while (count < batchFrames.size) {
+                                    val frame = audioFrameQueue.dequeueWritable() ?: break
+                                    batchFrames[count] = frame
+                                    batchNativeFrames[count] = frame.nativeFrame
+                                    count ++
+                                }
+                                if (count > 0) {
+                                    val start = SystemClock.uptimeMillis()
+                                    // Native decode until buffers full, no packet or eof, Java only handle state changes.
+                                    val decodeResult = player.decodeAudioToBuffersInternal(nativePlayer, batchNativeFrames, count, descriptors)
+                                    val published = descriptors[0].toInt()
+                                    for (i in 0 until count) {
+                                        val frame = batchFrames[i]!!
+                                        batchFrames[i] = null
+                                        if (i < published) {
+                                            val offset = DECODE_BATCH_HEADER_SIZE + i * AUDIO_FRAME_DESCRIPTOR_SIZE
+                                            frame.pts = descriptors[offset]
+                                            frame.duration = descriptors[offset + 1]
+                                            frame.serial = descriptors[offset + 2].toInt()
+                                            audioFrameQueue.enqueueDecodedReadable(frame)
+                                            if (frame.serial != packetSerial) {
+                                                MediaLog.d(TAG, "Serial changed, audio decoder flushed, serial: ${frame.serial}")
+                                                packetSerial = frame.serial
+                                            }
                                         } else {
-                                            false
+                                            audioFrameQueue.enqueueWritable(frame)
                                         }
-                                        if (serialChanged) {
-                                            MediaLog.d(TAG, "Serial changed, flush audio decoder, serial: $packetSerial")
-                                            player.flushAudioCodecBufferInternal(nativePlayer)
+                                    }
+                                    if (published > 0) {
+                                        player.readableAudioFrameReady()
+                                    }
+                                    // Old serial packets may be dropped even no frame published.
+                                    player.writeableAudioPacketReady()
+                                    when (decodeResult) {
+                                        DecodeToBuffersResult.Continue -> {
+                                            this@AudioFrameDecoder.state.set(DecoderState.Ready)
+                                            requestDecode()
                                         }
-                                        if (skipNextPktRead || pkt != null) {
-                                            skipNextPktRead = false
-                                            if (pkt?.isEof == true) {
-                                                val frame = audioFrameQueue.dequeueWriteableForce()
-                                                frame.isEof = true
-                                                frame.serial = packetSerial
-                                                audioFrameQueue.enqueueReadable(frame)
-                                                MediaLog.d(TAG, "Decode audio frame eof.")
-                                                this@AudioFrameDecoder.state.set(DecoderState.Eof)
-                                                player.readableAudioFrameReady()
-                                            } else {
-                                                val start = SystemClock.uptimeMillis()
-                                                val decodeResult = player.decodeAudioInternal(nativePlayer, pkt)
-                                                var audioFrame: AudioFrame? = null
-                                                when (decodeResult) {
-                                                    DecodeResult.Success, DecodeResult.SuccessAndSkipNextPkt -> {
-                                                        val frame = audioFrameQueue.dequeueWriteableForce()
-                                                        frame.serial = packetSerial
-                                                        val moveResult = player.moveDecodedAudioFrameToBufferInternal(nativePlayer, frame)
-                                                        if (moveResult == OptResult.Success) {
-                                                            audioFrame = frame
-                                                            audioFrameQueue.enqueueReadable(frame)
-                                                            player.readableAudioFrameReady()
-                                                        } else {
-                                                            audioFrameQueue.enqueueWritable(frame)
-                                                            MediaLog.e(TAG, "Move audio frame fail.")
-                                                        }
-                                                        skipNextPktRead = decodeResult == DecodeResult.SuccessAndSkipNextPkt
-                                                        requestDecode()
-                                                    }
-                                                    DecodeResult.Fail, DecodeResult.FailAndNeedMorePkt, DecodeResult.DecodeEnd -> {
-                                                        if (decodeResult == DecodeResult.Fail) {
-                                                            MediaLog.e(TAG, "Decode audio fail.")
-                                                        }
-                                                        skipNextPktRead = false
-                                                        requestDecode()
-                                                    }
-                                                }
-                                                val end = SystemClock.uptimeMillis()
-                                                MediaLog.d(TAG, "Decode audio cost ${end - start}ms, DecodeResult=${decodeResult}, pkt=${pkt}, audioFrame=${audioFrame}")
-                                                if (state != DecoderState.Ready) {
-                                                    this@AudioFrameDecoder.state.set(DecoderState.Ready)
-                                                }
+                                        DecodeToBuffersResult.BuffersFull -> {
+                                            MediaLog.d(TAG, "Waiting frame queue writeable buffer.")
+                                            this@AudioFrameDecoder.state.set(DecoderState.WaitingWritableFrameBuffer)
+                                            // Frame may be recycled before state changed.
+                                            if (audioFrameQueue.isCanWrite()) {
+                                                requestDecode()
                                             }
-                                            if (pkt != null) {
-                                                audioPacketQueue.enqueueWritable(pkt)
-                                                player.writeableAudioPacketReady()
+                                        }
+                                        DecodeToBuffersResult.NoPkt -> {
+                                            MediaLog.d(TAG, "Waiting packet queue readable buffer.")
+                                            this@AudioFrameDecoder.state.set(DecoderState.WaitingReadablePacketBuffer)
+                                            // Packet may be pushed before state changed.
+                                            if (audioPacketQueue.isCanRead()) {
+                                                requestDecode()
                                             }
-                                        } else {
-                                            requestDecode()
                                         }
-                                    } else {
-                                        MediaLog.d(TAG, "Waiting frame queue writeable buffer.")
-                                        this@AudioFrameDecoder.state.set(DecoderState.WaitingWritableFrameBuffer)
+                                        DecodeToBuffersResult.Eof -> {
+                                            packetSerial = player.audioPacketSerialInternal(nativePlayer)
+                                            val frame = audioFrameQueue.dequeueWriteableForce()
+                                            frame.isEof = true
+                                            frame.serial = packetSerial
+                                            audioFrameQueue.enqueueReadable(frame)
+                                            MediaLog.d(TAG, "Decode audio frame eof.")
+                                            this@AudioFrameDecoder.state.set(DecoderState.Eof)
+                                            player.readableAudioFrameReady()
+                                        }
                                     }
+                                    val end = SystemClock.uptimeMillis()
+                                    MediaLog.d(TAG, "Decode audio cost ${end - start}ms, DecodeToBuffersResult=${decodeResult}, publishedFrames=${published}")
                                 } else {
-                                    MediaLog.d(TAG, "Waiting packet queue readable buffer.")
-                                    this@AudioFrameDecoder.state.set(DecoderState.WaitingReadablePacketBuffer)
+                                    MediaLog.d(TAG, "Waiting frame queue writeable buffer.")
+                                    this@AudioFrameDecoder.state.set(DecoderState.WaitingWritableFrameBuffer)
                                 }
                             }
                         }
@@ -5,23 +5,32 @@ import android.os.HandlerThread
 import android.os.Message
 import android.os.SystemClock
 import com.tans.tmediaplayer.MediaLog
-import com.tans.tmediaplayer.player.model.DecodeResult
-import com.tans.tmediaplayer.player.model.OptResult
-import com.tans.tmediaplayer.player.rwqueue.PacketQueue
+import com.tans.tmediaplayer.player.model.DECODE_BATCH_HEADER_SIZE
+import com.tans.tmediaplayer.player.model.DECODE_MAX_BATCH_SIZE
+import com.tans.tmediaplayer.player.model.DecodeToBuffersResult
+import com.tans.tmediaplayer.player.model.VIDEO_FRAME_DESCRIPTOR_SIZE
+import com.tans.tmediaplayer.player.model.toImageRawType
+import com.tans.tmediaplayer.player.rwqueue.NativePacketQueue
 import com.tans.tmediaplayer.player.rwqueue.VideoFrame
 import com.tans.tmediaplayer.player.rwqueue.VideoFrameQueue
 import com.tans.tmediaplayer.player.tMediaPlayer
 import java.util.concurrent.atomic.AtomicBoolean
+import java.util.concurrent.atomic.AtomicLong
 import java.util.concurrent.atomic.AtomicReference
+import kotlin.math.min
 
 internal class VideoFrameDecoder(
     private val player: tMediaPlayer,
-    private val videoPacketQueue: PacketQueue,
+    private val videoPacketQueue: NativePacketQueue,
     private val videoFrameQueue: VideoFrameQueue
 ) {
 
     private val state: AtomicReference<DecoderState> = AtomicReference(DecoderState.NotInit)
 
+    // Conversion and copy cost of delivered frames.
+    private val deliveredFrames: AtomicLong = AtomicLong(0L)
+    private val deliverCostInNanos: AtomicLong = AtomicLong(0L)
+
     // Is read thread ready?
     private val isLooperPrepared: AtomicBoolean by lazy { AtomicBoolean(false) }
 
@@ -45,10 +54,14 @@ internal class VideoFrameDecoder(
     private val videoDecoderHandler: Handler by lazy {
         object : Handler(videoDecoderThread.looper) {
 
-            private var skipNextPktRead: Boolean = false
-
             private var packetSerial: Int = -1
 
+            private val batchFrames: Array<VideoFrame?> = arrayOfNulls(min(videoFrameQueue.maxQueueSize, DECODE_MAX_BATCH_SIZE))
+
+            private val batchNativeFrames: LongArray = LongArray(batchFrames.size)
+
+            private val descriptors: LongArray = LongArray(DECODE_BATCH_HEADER_SIZE + batchFrames.size * VIDEO_FRAME_DESCRIPTOR_SIZE)
+
             override fun handleMessage(msg: Message) {
                 super.handleMessage(msg)
                 synchronized(this@VideoFrameDecoder) {
@@ -57,87 +70,83 @@ internal class VideoFrameDecoder(
                     if (nativePlayer != null && state in activeStates) {
                         when (msg.what) {
                             DecoderHandlerMsg.RequestDecode.ordinal -> {
-                                if (skipNextPktRead || videoPacketQueue.isCanRead()) {
-                                    if (videoFrameQueue.isCanWrite()) {
-                                        val pkt = if (skipNextPktRead) {
-                                            null
-                                        } else {
-                                            videoPacketQueue.dequeueReadable()
-                                        }
-                                        val serialChanged = if (pkt != null) {
-                                            val changed = pkt.serial != packetSerial
-                                            packetSerial = pkt.serial
-                                            changed
+                                var count = 0
+                                while (count < batchFrames.size) {
+                                    val frame = videoFrameQueue.dequeueWritable() ?: break
+                                    batchFrames[count] = frame
+                                    batchNativeFrames[count] = frame.nativeFrame
+                                    count ++
+                                }
+                                if (count > 0) {
+                                    val start = SystemClock.uptimeMillis()
+                                    // Native decode until buffers full, no packet or eof, Java only handle state changes.
+                                    val decodeResult = player.decodeVideoToBuffersInternal(nativePlayer, batchNativeFrames, count, descriptors)
+                                    val published = descriptors[0].toInt()
+                                    for (i in 0 until count) {
+                                        val frame = batchFrames[i]!!
+                                        batchFrames[i] = null
+                                        if (i < published) {
+                                            val deliverStart = System.nanoTime()
+                                            val offset = DECODE_BATCH_HEADER_SIZE + i * VIDEO_FRAME_DESCRIPTOR_SIZE
+                                            frame.pts = descriptors[offset]
+                                            frame.duration = descriptors[offset + 1]
+                                            frame.serial = descriptors[offset + 2].toInt()
+                                            frame.imageType = descriptors[offset + 3].toInt().toImageRawType()
+                                            frame.width = descriptors[offset + 4].toInt()
+                                            frame.height = descriptors[offset + 5].toInt()
+                                            videoFrameQueue.enqueueDecodedReadable(frame)
+                                            deliverCostInNanos.addAndGet(descriptors[offset + 6] + System.nanoTime() - deliverStart)
+                                            deliveredFrames.incrementAndGet()
+                                            if (frame.serial != packetSerial) {
+                                                MediaLog.d(TAG, "Serial changed, video decoder flushed, serial: ${frame.serial}")
+                                                packetSerial = frame.serial
+                                            }
                                         } else {
-                                            false
+                                            videoFrameQueue.enqueueWritable(frame)
                                         }
-                                        if (serialChanged) {
-                                            MediaLog.d(TAG, "Serial changed, flush video decoder, serial: $packetSerial")
-                                            player.flushVideoCodecBufferInternal(nativePlayer)
+                                    }
+                                    if (published > 0) {
+                                        player.readableVideoFrameReady()
+                                    }
+                                    // Old serial packets may be dropped even no frame published.
+                                    player.writeableVideoPacketReady()
+                                    when (decodeResult) {
+                                        DecodeToBuffersResult.Continue -> {
+                                            this@VideoFrameDecoder.state.set(DecoderState.Ready)
+                                            requestDecode()
                                         }
-                                        if (skipNextPktRead || pkt != null) {
-                                            skipNextPktRead = false
-                                            if (pkt?.isEof == true) {
-                                                val frame = videoFrameQueue.dequeueWriteableForce()
-                                                frame.isEof = true
-                                                frame.serial = packetSerial
-                                                videoFrameQueue.enqueueReadable(frame)
-                                                MediaLog.d(TAG, "Decode video frame eof.")
-                                                this@VideoFrameDecoder.state.set(DecoderState.Eof)
-                                                player.readableVideoFrameReady()
-                                            } else {
-                                                val start = SystemClock.uptimeMillis()
-                                                val decodeResult = player.decodeVideoInternal(nativePlayer, pkt)
-                                                var videoFrame: VideoFrame? = null
-                                                when (decodeResult) {
-                                                    DecodeResult.Success, DecodeResult.SuccessAndSkipNextPkt -> {
-                                                        val frame =
-                                                            videoFrameQueue.dequeueWriteableForce()
-                                                        frame.serial = packetSerial
-                                                        val moveResult =
-                                                            player.moveDecodedVideoFrameToBufferInternal(
-                                                                nativePlayer,
-                                                                frame
-                                                            )
-                                                        if (moveResult == OptResult.Success) {
-                                                            videoFrame = frame
-                                                            videoFrameQueue.enqueueReadable(frame)
-                                                            player.readableVideoFrameReady()
-                                                        } else {
-                                                            videoFrameQueue.enqueueWritable(frame)
-                                                            MediaLog.e(TAG, "Move video frame fail.")
-                                                        }
-                                                        skipNextPktRead = decodeResult == DecodeResult.SuccessAndSkipNextPkt
-                                                        requestDecode()
-                                                    }
-
-                                                    DecodeResult.Fail, DecodeResult.FailAndNeedMorePkt, DecodeResult.DecodeEnd -> {
-                                                        if (decodeResult == DecodeResult.Fail) {
-                                                            MediaLog.e(TAG, "Decode video fail.")
-                                                        }
-                                                        requestDecode()
-                                                    }
-                                                }
-                                                val end = SystemClock.uptimeMillis()
-                                                MediaLog.d(TAG, "Decode video cost ${end - start}ms, DecodeResult=${decodeResult}, pkt=${pkt}, videoFrame=${videoFrame}")
-                                                if (state != DecoderState.Ready) {
-                                                    this@VideoFrameDecoder.state.set(DecoderState.Ready)
-                                                }
+                                        DecodeToBuffersResult.BuffersFull -> {
+                                            MediaLog.d(TAG, "Waiting frame queue writeable buffer.")
+                                            this@VideoFrameDecoder.state.set(DecoderState.WaitingWritableFrameBuffer)
+                                            // Frame may be recycled before state changed.
+                                            if (videoFrameQueue.isCanWrite()) {
+                                                requestDecode()
                                             }
-                                            if (pkt != null) {
-                                                videoPacketQueue.enqueueWritable(pkt)
-                                                player.writeableVideoPacketReady()
+                                        }
+                                        DecodeToBuffersResult.NoPkt -> {
+                                            MediaLog.d(TAG, "Waiting packet queue readable buffer.")
+                                            this@VideoFrameDecoder.state.set(DecoderState.WaitingReadablePacketBuffer)
+                                            // Packet may be pushed before state changed.
+                                            if (videoPacketQueue.isCanRead()) {
+                                                requestDecode()
                                             }
-                                        } else {
-                                            requestDecode()
                                         }
-                                    } else {
-                                        MediaLog.d(TAG, "Waiting frame queue writeable buffer.")
-                                        this@VideoFrameDecoder.state.set(DecoderState.WaitingWritableFrameBuffer)
+                                        DecodeToBuffersResult.Eof -> {
+                                            packetSerial = player.videoPacketSerialInternal(nativePlayer)
+                                            val frame = videoFrameQueue.dequeueWriteableForce()
+                                            frame.isEof = true
+                                            frame.serial = packetSerial
+                                            videoFrameQueue.enqueueReadable(frame)
+                                            MediaLog.d(TAG, "Decode video frame eof.")
+                                            this@VideoFrameDecoder.state.set(DecoderState.Eof)
+                                            player.readableVideoFrameReady()
+                                        }
                                     }
+                                    val end = SystemClock.uptimeMillis()
+                                    MediaLog.d(TAG, "Decode video cost ${end - start}ms, DecodeToBuffersResult=${decodeResult}, publishedFrames=${published}")
                                 } else {
-                                    MediaLog.d(TAG, "Waiting packet queue readable buffer.")
-                                    this@VideoFrameDecoder.state.set(DecoderState.WaitingReadablePacketBuffer)
+                                    MediaLog.d(TAG, "Waiting frame queue writeable buffer.")
+                                    this@VideoFrameDecoder.state.set(DecoderState.WaitingWritableFrameBuffer)
                                 }
                             }
                         }
@@ -179,6 +188,27 @@ internal class VideoFrameDecoder(
         }
     }
 
+    /**
+     * Step to the frame before showing frame, decoder handler is not running. If native replays cached frames,
+     * queued frames are flushed and refilled from the frame before showing frame.
+     * @return -1 if cached frames replay, otherwise the position need seek to, null if decoder not active.
+     */
+    fun stepBackward(nativePlayer: Long, showingPts: Long): Long? {
+        synchronized(this) {
+            val state = getState()
+            if (state !in activeStates) {
+                MediaLog.e(TAG, "Step backward fail, wrong state: $state")
+                return null
+            }
+            val result = player.stepVideoFrameBackwardInternal(nativePlayer, showingPts)
+            if (result < 0L) {
+                videoFrameQueue.flushReadableBuffer()
+                requestDecode()
+            }
+            return result
+        }
+    }
+
     fun release() {
         synchronized(this) {
             val oldState = getState()
@@ -193,6 +223,11 @@ internal class VideoFrameDecoder(
         }
     }
 
+    fun getAvgFrameDeliverCostInMicros(): Long {
+        val frames = deliveredFrames.get()
+        return if (frames > 0) deliverCostInNanos.get() / frames / 1000L else 0L
+    }
+
     fun getState(): DecoderState = state.get()
 
     companion object {
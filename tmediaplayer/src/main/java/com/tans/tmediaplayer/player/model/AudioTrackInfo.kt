@@ -0,0 +1,9 @@
+package com.tans.tmediaplayer.player.model
+
+data class AudioTrackInfo(
+    val streamId: Int,
+    val audioCodec: FFmpegCodec,
+    val audioChannels: Int,
+    val audioSimpleRate: Int,
+    val metadata: Map<String, String>
+)
\ No newline at end of file
@@ -0,0 +1,13 @@
+package com.tans.tmediaplayer.player.model
+
+enum class BlockingIOOp {
+    None,
+    OpenInput,
+    FindStreamInfo,
+    ReadFrame,
+    Seek
+}
+
+internal fun Int.toBlockingIOOp(): BlockingIOOp {
+    return BlockingIOOp.entries.find { it.ordinal == this } ?: BlockingIOOp.None
+}
\ No newline at end of file
@@ -0,0 +1,11 @@
+package com.tans.tmediaplayer.player.model
+
+data class BlockingIOStats(
+    // Blocking calls interrupted by release, cancel or timeout.
+    val interruptCount: Long,
+    val lastInterruptedOp: BlockingIOOp,
+    // How long the call had blocked before it was interrupted.
+    val lastInterruptedCostInMicros: Long,
+    val maxInterruptedCostInMicros: Long,
+    val maxBlockingCostInMicros: Long
+)
\ No newline at end of file
@@ -9,4 +9,13 @@ internal const val SYNC_THRESHOLD_MAX = 100L
 
 internal const val SYNC_FRAMEDUP_THRESHOLD = 100L
 
-internal const val VIDEO_REFRESH_RATE = 10L
\ No newline at end of file
+internal const val VIDEO_REFRESH_RATE = 10L
+
+// Keep same with native.
+internal const val DECODE_MAX_BATCH_SIZE = 64
+
+internal const val DECODE_BATCH_HEADER_SIZE = 1
+
+internal const val VIDEO_FRAME_DESCRIPTOR_SIZE = 7
+
+internal const val AUDIO_FRAME_DESCRIPTOR_SIZE = 3
\ No newline at end of file
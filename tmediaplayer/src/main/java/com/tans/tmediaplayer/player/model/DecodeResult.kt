@@ -5,7 +5,9 @@ internal enum class DecodeResult {
     SuccessAndSkipNextPkt,
     Fail,
     FailAndNeedMorePkt,
-    DecodeEnd
+    DecodeEnd,
+    NoPkt,
+    PktEof
 }
 internal fun Int.toDecodeResult(): DecodeResult {
     return DecodeResult.entries.find { it.ordinal == this } ?: DecodeResult.Fail
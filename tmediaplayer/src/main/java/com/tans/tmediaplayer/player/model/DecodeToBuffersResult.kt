@@ -0,0 +1,12 @@
+package com.tans.tmediaplayer.player.model
+
+internal enum class DecodeToBuffersResult {
+    Continue,
+    BuffersFull,
+    NoPkt,
+    Eof
+}
+
+internal fun Int.toDecodeToBuffersResult(): DecodeToBuffersResult {
+    return DecodeToBuffersResult.entries.find { it.ordinal == this } ?: DecodeToBuffersResult.Continue
+}
\ No newline at end of file
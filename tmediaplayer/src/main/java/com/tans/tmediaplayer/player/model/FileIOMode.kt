@@ -0,0 +1,32 @@
+package com.tans.tmediaplayer.player.model
+
+/**
+ * Local file io backend, not local files always use FFmpeg default protocol.
+ */
+enum class FileIOMode {
+    /**
+     * FFmpeg default file protocol.
+     */
+    Default,
+
+    /**
+     * Mmap whole file, advise kernel to load next window.
+     */
+    Mmap,
+
+    /**
+     * Background thread reads ahead to a ring buffer.
+     */
+    ReadAhead,
+
+    /**
+     * Thread pool keeps several reads in flight, blocks are LRU cached, good for interleaved files.
+     */
+    AsyncRead,
+
+    /**
+     * Same as AsyncRead, reads are kept in flight by io_uring on Linux. Fallback to AsyncRead if io_uring is
+     * unavailable, always on Android apps.
+     */
+    UringRead
+}
\ No newline at end of file
@@ -0,0 +1,10 @@
+package com.tans.tmediaplayer.player.model
+
+data class FileIOStats(
+    // Bytes returned to demuxer.
+    val bytesRead: Long,
+    val readSyscalls: Long,
+    // Time of demuxer waiting for data.
+    val stallTimeInMicros: Long,
+    val seekCount: Long
+)
\ No newline at end of file
@@ -0,0 +1,14 @@
+package com.tans.tmediaplayer.player.model
+
+/**
+ * Backward frame steps replay recently decoded frames cached by native, misses decode again from key frame.
+ */
+data class FrameStepStats(
+    val cachedFrames: Long,
+    val cachedBytes: Long,
+    val cacheHits: Long,
+    val cacheMisses: Long,
+    // Frames decoded from key frame for missed backward steps.
+    val redecodedFrames: Long,
+    val replayedFrames: Long
+)
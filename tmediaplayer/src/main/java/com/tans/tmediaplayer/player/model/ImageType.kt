@@ -5,6 +5,8 @@ internal enum class ImageRawType {
     Nv12,
     Nv21,
     Rgba,
+    Yuv420p10,
+    P010,
     Unknown
 }
 
@@ -14,6 +16,8 @@ internal fun Int.toImageRawType(): ImageRawType {
         ImageRawType.Nv12.ordinal -> ImageRawType.Nv12
         ImageRawType.Nv21.ordinal -> ImageRawType.Nv21
         ImageRawType.Rgba.ordinal -> ImageRawType.Rgba
+        ImageRawType.Yuv420p10.ordinal -> ImageRawType.Yuv420p10
+        ImageRawType.P010.ordinal -> ImageRawType.P010
         else -> ImageRawType.Unknown
     }
 }
\ No newline at end of file
@@ -0,0 +1,12 @@
+package com.tans.tmediaplayer.player.model
+
+/**
+ * Decoded video frames late than master clock are dropped before conversion and copy to Java.
+ */
+data class LateVideoFrameDropStats(
+    val droppedFrames: Long,
+    // Conversion and copy cost of a delivered frame.
+    val avgFrameDeliverCostInMicros: Long,
+    // Estimated by droppedFrames * avgFrameDeliverCostInMicros.
+    val savedCpuTimeInMicros: Long
+)
\ No newline at end of file
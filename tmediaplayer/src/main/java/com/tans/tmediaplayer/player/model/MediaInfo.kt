@@ -7,5 +7,6 @@ data class MediaInfo(
     val containerName: String,
     val audioStreamInfo: AudioStreamInfo?,
     val videoStreamInfo: VideoStreamInfo?,
-    val subtitleStreams: List<SubtitleStreamInfo>
+    val subtitleStreams: List<SubtitleStreamInfo>,
+    val audioTracks: List<AudioTrackInfo>
 )
@@ -0,0 +1,17 @@
+package com.tans.tmediaplayer.player.model
+
+/**
+ * Payload allocations of audio and video packets read from current media file.
+ */
+data class PacketAllocStats(
+    val packets: Long,
+    // Payload buffer allocated by demuxer for the packet.
+    val payloadAllocations: Long,
+    val payloadBytes: Long,
+    // Payloads which are usually mmap() backed by allocator.
+    val largePayloads: Long,
+    val maxPayloadSize: Long
+) {
+    val avgPayloadSize: Long
+        get() = if (payloadAllocations > 0) payloadBytes / payloadAllocations else 0L
+}
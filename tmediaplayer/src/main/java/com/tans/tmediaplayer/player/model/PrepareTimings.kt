@@ -0,0 +1,9 @@
+package com.tans.tmediaplayer.player.model
+
+/**
+ * Millis from prepare() called, -1 if not reached yet.
+ */
+data class PrepareTimings(
+    val timeToPreparedInMillis: Long,
+    val timeToFirstFrameInMillis: Long
+)
\ No newline at end of file
@@ -0,0 +1,17 @@
+package com.tans.tmediaplayer.player.model
+
+/**
+ * Stream info probe cache stats of all players and frame loaders.
+ */
+data class ProbeCacheStats(
+    val hits: Long,
+    val misses: Long,
+    val hitsProbeTimeInMicros: Long,
+    val missesProbeTimeInMicros: Long
+) {
+    val averageHitProbeTimeInMicros: Long
+        get() = if (hits > 0) hitsProbeTimeInMicros / hits else 0L
+
+    val averageMissProbeTimeInMicros: Long
+        get() = if (misses > 0) missesProbeTimeInMicros / misses else 0L
+}
\ No newline at end of file
@@ -0,0 +1,14 @@
+package com.tans.tmediaplayer.player.model
+
+internal enum class ReadPacketsToQueueResult {
+    Continue,
+    QueueFull,
+    Attachment,
+    Subtitle,
+    Eof,
+    Fail
+}
+
+internal fun Int.toReadPacketsToQueueResult(): ReadPacketsToQueueResult {
+    return ReadPacketsToQueueResult.entries.find { it.ordinal == this } ?: ReadPacketsToQueueResult.Fail
+}
\ No newline at end of file
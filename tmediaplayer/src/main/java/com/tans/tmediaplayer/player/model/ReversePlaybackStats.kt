@@ -0,0 +1,23 @@
+package com.tans.tmediaplayer.player.model
+
+/**
+ * Reverse playback decodes GOPs forward into a bounded frame cache and emits them backward.
+ */
+data class ReversePlaybackStats(
+    val cachedBytes: Long,
+    val peakCachedBytes: Long,
+    val cachedFrames: Long,
+    val decodedGops: Long,
+    val decodedFrames: Long,
+    val gopDecodeTimeInMicros: Long,
+    val emittedFrames: Long,
+    // Time of video decoder waiting previous GOP decoded.
+    val stallTimeInMicros: Long
+) {
+    val avgGopFrames: Double
+        get() = if (decodedGops > 0) decodedFrames.toDouble() / decodedGops.toDouble() else 0.0
+
+    // Max reverse fps the GOP decoder can sustain.
+    val sustainedFps: Double
+        get() = if (gopDecodeTimeInMicros > 0) decodedFrames.toDouble() * 1000000.0 / gopDecodeTimeInMicros.toDouble() else 0.0
+}
@@ -0,0 +1,12 @@
+package com.tans.tmediaplayer.player.model
+
+/**
+ * Sws conversion context cache stats of all players and frame loaders.
+ */
+data class VideoConvertCacheStats(
+    val hits: Long,
+    val misses: Long,
+    val evictions: Long,
+    // Contexts in cache, not used by any player or frame loader.
+    val idleContexts: Int
+)
\ No newline at end of file
@@ -0,0 +1,12 @@
+package com.tans.tmediaplayer.player.model
+
+/**
+ * Sws conversion of video formats not supported by renderer, large frames are split to slices converted by threads.
+ */
+data class VideoConvertStats(
+    // 1 means convert on decoder thread.
+    val sliceThreadCount: Int,
+    val convertedFrames: Long,
+    val avgConvertCostInMicros: Long,
+    val maxConvertCostInMicros: Long
+)
\ No newline at end of file
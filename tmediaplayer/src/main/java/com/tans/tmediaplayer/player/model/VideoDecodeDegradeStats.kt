@@ -0,0 +1,13 @@
+package com.tans.tmediaplayer.player.model
+
+/**
+ * Video decode degradation of current media file, levels:
+ * 0: none, 1: skip loop filter of non-ref frames, 2: skip loop filter of all frames and idct of non-ref frames,
+ * 3: skip non-ref frames, 4: skip non-key frames.
+ */
+data class VideoDecodeDegradeStats(
+    val currentLevel: Int,
+    val levelChanges: Long,
+    // Index is level.
+    val timeAtLevelInMillis: List<Long>
+)
\ No newline at end of file
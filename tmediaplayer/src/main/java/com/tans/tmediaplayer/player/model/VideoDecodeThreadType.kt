@@ -0,0 +1,25 @@
+package com.tans.tmediaplayer.player.model
+
+/**
+ * Software video decoder threading, hardware decoder ignore it.
+ */
+enum class VideoDecodeThreadType {
+    /**
+     * Choose by codec capabilities, thread count by resolution and cpu cores, add threads if decode can't keep up with frame rate.
+     */
+    Auto,
+
+    /**
+     * Decode several frames in parallel, best throughput, add (threadCount - 1) frames latency.
+     */
+    Frame,
+
+    /**
+     * Decode slices of one frame in parallel, no extra latency, only works when encoder produce multi slices.
+     */
+    Slice
+}
+
+internal fun Int.toVideoDecodeThreadType(): VideoDecodeThreadType? {
+    return VideoDecodeThreadType.entries.find { it.ordinal == this }
+}
\ No newline at end of file
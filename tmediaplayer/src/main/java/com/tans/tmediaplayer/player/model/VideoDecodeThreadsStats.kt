@@ -0,0 +1,15 @@
+package com.tans.tmediaplayer.player.model
+
+/**
+ * Software video decoder threading stats of current media file.
+ */
+data class VideoDecodeThreadsStats(
+    // Null when decoder use single thread or hardware.
+    val threadType: VideoDecodeThreadType?,
+    val threadCount: Int,
+    val decodedFrames: Long,
+    val avgDecodeCostInMicros: Long,
+    val maxDecodeCostInMicros: Long,
+    // Auto mode reopened decoder with more threads.
+    val retuneCount: Long
+)
\ No newline at end of file
@@ -5,9 +5,9 @@ import android.os.HandlerThread
 import android.os.Message
 import android.os.SystemClock
 import com.tans.tmediaplayer.MediaLog
-import com.tans.tmediaplayer.player.model.ReadPacketResult
 import com.tans.tmediaplayer.player.model.OptResult
-import com.tans.tmediaplayer.player.rwqueue.PacketQueue
+import com.tans.tmediaplayer.player.model.ReadPacketsToQueueResult
+import com.tans.tmediaplayer.player.rwqueue.NativePacketQueue
 import com.tans.tmediaplayer.player.tMediaPlayer
 import java.util.Locale
 import java.util.concurrent.atomic.AtomicBoolean
@@ -15,8 +15,8 @@ import java.util.concurrent.atomic.AtomicReference
 
 internal class PacketReader(
     private val player: tMediaPlayer,
-    private val audioPacketQueue: PacketQueue,
-    private val videoPacketQueue: PacketQueue
+    private val audioPacketQueue: NativePacketQueue,
+    private val videoPacketQueue: NativePacketQueue
 ) {
 
     private val state: AtomicReference<ReaderState> = AtomicReference(ReaderState.NotInit)
@@ -61,69 +61,45 @@ internal class PacketReader(
                                     MediaLog.d(TAG, "Packet queue full, audioSize=${String.format(Locale.US, "%.2f", audioSizeInBytes.toFloat() / 1024.0f)}KB, videoSize=${String.format(Locale.US, "%.2f", videoSizeInBytes.toFloat() / 1024.0f)}KB, audioDuration=$audioDuration, videoDuration=$videoDuration")
                                     this@PacketReader.state.set(ReaderState.WaitingWritableBuffer)
                                 } else {
-                                    when (player.readPacketInternal(nativePlayer)) {
-                                        ReadPacketResult.ReadVideoAttachmentSuccess -> {
-                                            if (requestAttachment.compareAndSet(true, false)) {
-                                                val pkt = videoPacketQueue.dequeueWriteableForce()
-                                                player.movePacketRefInternal(nativePlayer, pkt.nativePacket)
-                                                videoPacketQueue.enqueueReadable(pkt)
-                                                val eofPkt = videoPacketQueue.dequeueWriteableForce()
-                                                eofPkt.isEof = true
-                                                videoPacketQueue.enqueueReadable(eofPkt)
-                                                player.readableVideoPacketReady()
-                                                MediaLog.d(TAG, "Read video attachment.")
-                                            } else {
-                                                MediaLog.d(TAG, "Skip handle video attachment.")
-                                            }
-                                            requestReadPkt()
-                                        }
-                                        ReadPacketResult.ReadVideoSuccess -> {
-                                            val pkt = videoPacketQueue.dequeueWriteableForce()
-                                            player.movePacketRefInternal(nativePlayer, pkt.nativePacket)
-                                            videoPacketQueue.enqueueReadable(pkt)
-                                            MediaLog.d(TAG, "Read video pkt: $pkt")
+                                    if (state == ReaderState.WaitingWritableBuffer) {
+                                        this@PacketReader.state.set(ReaderState.Ready)
+                                    }
+                                    val readResult = player.readPacketsToQueuesInternal(nativePlayer, MAX_QUEUE_SIZE_IN_BYTES, MAX_QUEUE_DURATION, requestAttachment.get())
+                                    player.checkNewStreamsDiscovered(nativePlayer)
+                                    when (readResult) {
+                                        ReadPacketsToQueueResult.Continue -> {
                                             player.readableVideoPacketReady()
+                                            player.readableAudioPacketReady()
                                             requestReadPkt()
-
                                         }
-                                        ReadPacketResult.ReadAudioSuccess -> {
-                                            val pkt = audioPacketQueue.dequeueWriteableForce()
-                                            player.movePacketRefInternal(nativePlayer, pkt.nativePacket)
-                                            audioPacketQueue.enqueueReadable(pkt)
-                                            MediaLog.d(TAG, "Read audio pkt: $pkt")
+                                        ReadPacketsToQueueResult.QueueFull -> {
+                                            player.readableVideoPacketReady()
                                             player.readableAudioPacketReady()
+                                            this@PacketReader.state.set(ReaderState.WaitingWritableBuffer)
+                                        }
+                                        ReadPacketsToQueueResult.Attachment -> {
+                                            requestAttachment.set(false)
+                                            MediaLog.d(TAG, "Read video attachment.")
+                                            player.readableVideoPacketReady()
                                             requestReadPkt()
                                         }
-                                        ReadPacketResult.ReadSubtitleSuccess -> {
+                                        ReadPacketsToQueueResult.Subtitle -> {
+                                            // Subtitle pkt still in native player's pkt.
                                             MediaLog.d(TAG, "Read subtitle pkt.")
                                             player.getInternalSubtitle()?.enqueueSubtitlePacket()
+                                            player.readableVideoPacketReady()
+                                            player.readableAudioPacketReady()
                                             requestReadPkt()
                                         }
-                                        ReadPacketResult.ReadEof -> {
-                                            if (mediaInfo.videoStreamInfo != null && !mediaInfo.videoStreamInfo.isAttachment) {
-                                                val videoEofPkt = videoPacketQueue.dequeueWriteableForce()
-                                                videoEofPkt.isEof = true
-                                                videoPacketQueue.enqueueReadable(videoEofPkt)
-                                                player.readableVideoPacketReady()
-                                            }
-                                            if (mediaInfo.audioStreamInfo != null) {
-                                                val audioEofPkt = audioPacketQueue.dequeueWriteableForce()
-                                                audioEofPkt.isEof = true
-                                                audioPacketQueue.enqueueReadable(audioEofPkt)
-                                                player.readableAudioPacketReady()
-                                            }
+                                        ReadPacketsToQueueResult.Eof -> {
                                             MediaLog.d(TAG, "Read pkt eof.")
+                                            player.readableVideoPacketReady()
+                                            player.readableAudioPacketReady()
                                         }
-                                        ReadPacketResult.ReadFail -> {
+                                        ReadPacketsToQueueResult.Fail -> {
                                             MediaLog.e(TAG, "Read pkt fail.")
                                             requestReadPkt()
                                         }
-                                        ReadPacketResult.UnknownPkt -> {
-                                            requestReadPkt()
-                                        }
-                                    }
-                                    if (state == ReaderState.WaitingWritableBuffer) {
-                                        this@PacketReader.state.set(ReaderState.Ready)
                                     }
                                 }
                             }
@@ -148,6 +124,16 @@ internal class PacketReader(
                                     requestReadPkt()
                                 }
                             }
+
+                            HandlerMsg.RequestSwitchAudio.ordinal -> {
+                                val position = msg.obj
+                                if (position is Long) {
+                                    // Old audio stream packets dropped by serial changed, new stream resync at next read.
+                                    audioPacketQueue.flushReadableBuffer()
+                                    player.switchAudioResult(position)
+                                    requestReadPkt()
+                                }
+                            }
                         }
                     }
                 }
@@ -186,6 +172,19 @@ internal class PacketReader(
         }
     }
 
+    fun requestSwitchAudio(position: Long) {
+        val state = getState()
+        if (state in activeStates) {
+            pktReaderHandler.removeMessages(HandlerMsg.RequestSwitchAudio.ordinal)
+            val msg = pktReaderHandler.obtainMessage()
+            msg.what = HandlerMsg.RequestSwitchAudio.ordinal
+            msg.obj = position
+            pktReaderHandler.sendMessage(msg)
+        } else {
+            MediaLog.e(TAG, "Request switch audio fail, wrong state: $state")
+        }
+    }
+
     fun requestAttachment() {
         requestAttachment.set(true)
     }
@@ -217,7 +216,8 @@ internal class PacketReader(
 
         private enum class HandlerMsg {
             RequestReadPkt,
-            RequestSeek
+            RequestSeek,
+            RequestSwitchAudio
         }
 
         private const val TAG = "PacketReader"
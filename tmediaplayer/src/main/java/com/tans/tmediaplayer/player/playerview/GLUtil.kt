@@ -126,6 +126,31 @@ internal fun IntArray.toGlBuffer(): ByteBuffer {
     }
 }
 
+/**
+ * Upload plane which rows have stride padding, GL_UNPACK_ROW_LENGTH skip the padding so no packed copy needed.
+ */
+internal fun glTexImage2DWithStride(
+    internalFormat: Int,
+    width: Int,
+    height: Int,
+    format: Int,
+    bytesPerPixel: Int,
+    pixels: ByteBuffer,
+    strideInBytes: Int,
+    type: Int = GLES30.GL_UNSIGNED_BYTE
+) {
+    val hasPadding = strideInBytes != width * bytesPerPixel
+    if (hasPadding) {
+        GLES30.glPixelStorei(GLES30.GL_UNPACK_ALIGNMENT, 1)
+        GLES30.glPixelStorei(GLES30.GL_UNPACK_ROW_LENGTH, strideInBytes / bytesPerPixel)
+    }
+    GLES30.glTexImage2D(GLES30.GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, pixels)
+    if (hasPadding) {
+        GLES30.glPixelStorei(GLES30.GL_UNPACK_ROW_LENGTH, 0)
+        GLES30.glPixelStorei(GLES30.GL_UNPACK_ALIGNMENT, 4)
+    }
+}
+
 internal fun newGlIntBuffer(): IntBuffer {
     return ByteBuffer.allocateDirect(4).let {
         it.order(ByteOrder.nativeOrder())
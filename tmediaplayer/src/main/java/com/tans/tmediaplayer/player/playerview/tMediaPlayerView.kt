@@ -9,9 +9,11 @@ import com.tans.tmediaplayer.MediaLog
 import com.tans.tmediaplayer.R
 import com.tans.tmediaplayer.player.playerview.filter.AsciiArtImageFilter
 import com.tans.tmediaplayer.player.playerview.filter.FilterImageTexture
+import com.tans.tmediaplayer.player.playerview.texconverter.HighBitDepthYuvImageTextureConverter
 import com.tans.tmediaplayer.player.playerview.texconverter.RgbaImageTextureConverter
 import com.tans.tmediaplayer.player.playerview.texconverter.Yuv420pImageTextureConverter
 import com.tans.tmediaplayer.player.playerview.texconverter.Yuv420spImageTextureConverter
+import java.nio.ByteBuffer
 import java.util.concurrent.atomic.AtomicBoolean
 import java.util.concurrent.atomic.AtomicReference
 import javax.microedition.khronos.egl.EGLConfig
@@ -46,10 +48,22 @@ class tMediaPlayerView : GLSurfaceView {
         Yuv420spImageTextureConverter()
     }
 
+    private val highBitDepthYuvTexConverter: HighBitDepthYuvImageTextureConverter by lazy {
+        HighBitDepthYuvImageTextureConverter()
+    }
+
     private val asciiArtFilter: AsciiArtImageFilter by lazy {
         AsciiArtImageFilter()
     }
 
+    private val surfaceSize: AtomicReference<Pair<Int, Int>?> by lazy {
+        AtomicReference(null)
+    }
+
+    private val surfaceSizeListener: AtomicReference<SurfaceSizeListener?> by lazy {
+        AtomicReference(null)
+    }
+
     init {
         setEGLContextClientVersion(3)
         setRenderer(FrameRenderer().apply { this@tMediaPlayerView.renderer = this })
@@ -68,6 +82,17 @@ class tMediaPlayerView : GLSurfaceView {
         return asciiArtFilter
     }
 
+    /**
+     * Invoked on GL thread when surface size changed, and immediately if surface size is known.
+     */
+    internal fun setSurfaceSizeListener(l: SurfaceSizeListener?) {
+        surfaceSizeListener.set(l)
+        val size = surfaceSize.get()
+        if (l != null && size != null) {
+            l.onSurfaceSizeChanged(size.first, size.second)
+        }
+    }
+
     fun getScaleType(): ScaleType = this.scaleType.get()
 
     fun requestRenderRgbaFrame(
@@ -75,12 +100,32 @@ class tMediaPlayerView : GLSurfaceView {
         height: Int,
         imageBytes: ByteArray,
         callback: Runnable? = null
+    ) {
+        requestRenderRgbaFrame(
+            width = width,
+            height = height,
+            rgba = ByteBuffer.wrap(imageBytes),
+            rgbaStride = width * 4,
+            callback = callback
+        )
+    }
+
+    /**
+     * Buffers may be direct views of native memory, they must keep valid until callback invoked.
+     * Strides are bytes count of a row.
+     */
+    fun requestRenderRgbaFrame(
+        width: Int,
+        height: Int,
+        rgba: ByteBuffer,
+        rgbaStride: Int,
+        callback: Runnable? = null
     ) {
         requestRender(
             ImageData(
                 imageWidth = width,
                 imageHeight = height,
-                imageRawData = ImageRawData.RgbaRawData(rgbaBytes = imageBytes),
+                imageRawData = ImageRawData.RgbaRawData(rgba = rgba, rgbaStride = rgbaStride),
                 callback
             )
         )
@@ -93,15 +138,42 @@ class tMediaPlayerView : GLSurfaceView {
         uBytes: ByteArray,
         vBytes: ByteArray,
         callback: Runnable? = null
+    ) {
+        requestRenderYuv420pFrame(
+            width = width,
+            height = height,
+            y = ByteBuffer.wrap(yBytes),
+            yStride = width,
+            u = ByteBuffer.wrap(uBytes),
+            uStride = width / 2,
+            v = ByteBuffer.wrap(vBytes),
+            vStride = width / 2,
+            callback = callback
+        )
+    }
+
+    fun requestRenderYuv420pFrame(
+        width: Int,
+        height: Int,
+        y: ByteBuffer,
+        yStride: Int,
+        u: ByteBuffer,
+        uStride: Int,
+        v: ByteBuffer,
+        vStride: Int,
+        callback: Runnable? = null
     ) {
         requestRender(
             ImageData(
                 imageWidth = width,
                 imageHeight = height,
                 imageRawData = ImageRawData.Yuv420pRawData(
-                    yBytes = yBytes,
-                    uBytes = uBytes,
-                    vBytes = vBytes
+                    y = y,
+                    yStride = yStride,
+                    u = u,
+                    uStride = uStride,
+                    v = v,
+                    vStride = vStride
                 ),
                 callback = callback
             )
@@ -114,36 +186,116 @@ class tMediaPlayerView : GLSurfaceView {
         yBytes: ByteArray,
         uvBytes: ByteArray,
         callback: Runnable? = null
+    ) {
+        requestRenderYuv420spFrame(
+            width = width,
+            height = height,
+            y = ByteBuffer.wrap(yBytes),
+            yStride = width,
+            uv = ByteBuffer.wrap(uvBytes),
+            uvStride = width,
+            yuv420spType = Yuv420spType.Nv12,
+            callback = callback
+        )
+    }
+
+    fun requestRenderNv21Frame(
+        width: Int,
+        height: Int,
+        yBytes: ByteArray,
+        vuBytes: ByteArray,
+        callback: Runnable? = null
+    ) {
+        requestRenderYuv420spFrame(
+            width = width,
+            height = height,
+            y = ByteBuffer.wrap(yBytes),
+            yStride = width,
+            uv = ByteBuffer.wrap(vuBytes),
+            uvStride = width,
+            yuv420spType = Yuv420spType.Nv21,
+            callback = callback
+        )
+    }
+
+    fun requestRenderYuv420spFrame(
+        width: Int,
+        height: Int,
+        y: ByteBuffer,
+        yStride: Int,
+        uv: ByteBuffer,
+        uvStride: Int,
+        yuv420spType: Yuv420spType,
+        callback: Runnable? = null
     ) {
         requestRender(
             ImageData(
                 imageWidth = width,
                 imageHeight = height,
                 imageRawData = ImageRawData.Yuv420spRawData(
-                    yBytes = yBytes,
-                    uvBytes = uvBytes,
-                    yuv420spType = Yuv420spType.Nv12
+                    y = y,
+                    yStride = yStride,
+                    uv = uv,
+                    uvStride = uvStride,
+                    yuv420spType = yuv420spType
                 ),
                 callback = callback
             )
         )
     }
 
-    fun requestRenderNv21Frame(
+    /**
+     * 16 bits per sample planes, 10 bits valid in low bits. Strides are bytes count of a row.
+     */
+    fun requestRenderYuv420p10Frame(
         width: Int,
         height: Int,
-        yBytes: ByteArray,
-        vuBytes: ByteArray,
+        y: ByteBuffer,
+        yStride: Int,
+        u: ByteBuffer,
+        uStride: Int,
+        v: ByteBuffer,
+        vStride: Int,
         callback: Runnable? = null
     ) {
         requestRender(
             ImageData(
                 imageWidth = width,
                 imageHeight = height,
-                imageRawData = ImageRawData.Yuv420spRawData(
-                    yBytes = yBytes,
-                    uvBytes = vuBytes,
-                    yuv420spType = Yuv420spType.Nv21
+                imageRawData = ImageRawData.Yuv420p10RawData(
+                    y = y,
+                    yStride = yStride,
+                    u = u,
+                    uStride = uStride,
+                    v = v,
+                    vStride = vStride
+                ),
+                callback = callback
+            )
+        )
+    }
+
+    /**
+     * 16 bits per sample planes, 10 bits valid in high bits. Strides are bytes count of a row.
+     */
+    fun requestRenderP010Frame(
+        width: Int,
+        height: Int,
+        y: ByteBuffer,
+        yStride: Int,
+        uv: ByteBuffer,
+        uvStride: Int,
+        callback: Runnable? = null
+    ) {
+        requestRender(
+            ImageData(
+                imageWidth = width,
+                imageHeight = height,
+                imageRawData = ImageRawData.P010RawData(
+                    y = y,
+                    yStride = yStride,
+                    uv = uv,
+                    uvStride = uvStride
                 ),
                 callback = callback
             )
@@ -172,6 +324,8 @@ class tMediaPlayerView : GLSurfaceView {
 
         private var glRendererData: GLRendererData? = null
 
+        private var lastConvertTextureId: Int = 0
+
         override fun onSurfaceCreated(gl: GL10, config: EGLConfig) {
             val glVersion = gl.glGetString(GLES30.GL_VERSION)
             MediaLog.d(TAG, "Support gl version: $glVersion")
@@ -204,6 +358,8 @@ class tMediaPlayerView : GLSurfaceView {
         override fun onSurfaceChanged(gl: GL10, width: Int, height: Int) {
             sizeCache = SurfaceSizeCache(gl, width, height)
             GLES30.glViewport(0, 0, width, height)
+            surfaceSize.set(width to height)
+            surfaceSizeListener.get()?.onSurfaceSizeChanged(width, height)
         }
 
         override fun onDrawFrame(gl: GL10) {
@@ -216,8 +372,15 @@ class tMediaPlayerView : GLSurfaceView {
                     is ImageRawData.RgbaRawData -> rgbaTexConverter
                     is ImageRawData.Yuv420pRawData -> yuv420pTexConverter
                     is ImageRawData.Yuv420spRawData -> yuv420spTexConverter
+                    is ImageRawData.Yuv420p10RawData, is ImageRawData.P010RawData -> highBitDepthYuvTexConverter
+                }
+                val convertTextureId = if (imageData.hasInvokedCallback.get() && lastConvertTextureId != 0) {
+                    // Redraw, image buffers may be recycled after callback, reuse converted texture.
+                    lastConvertTextureId
+                } else {
+                    texConverter.convertImageToTexture(context = context, surfaceSize = screenSize, imageData = imageData)
                 }
-                val convertTextureId = texConverter.convertImageToTexture(context = context, surfaceSize = screenSize, imageData = imageData)
+                lastConvertTextureId = convertTextureId
 
                 val filterOutput = asciiArtFilter.filter(
                     context = context,
@@ -298,6 +461,7 @@ class tMediaPlayerView : GLSurfaceView {
 
         fun recycle() {
             sizeCache = null
+            lastConvertTextureId = 0
             val data = glRendererData
             if (data != null) {
                 GLES30.glDeleteBuffers(1, intArrayOf(data.VBO), 0)
@@ -306,6 +470,7 @@ class tMediaPlayerView : GLSurfaceView {
             rgbaTexConverter.recycle()
             yuv420pTexConverter.recycle()
             yuv420spTexConverter.recycle()
+            highBitDepthYuvTexConverter.recycle()
         }
 
     }
@@ -318,22 +483,48 @@ class tMediaPlayerView : GLSurfaceView {
 
         enum class Yuv420spType { Nv12, Nv21 }
 
+        internal fun interface SurfaceSizeListener {
+            fun onSurfaceSizeChanged(width: Int, height: Int)
+        }
+
         sealed class ImageRawData {
             class RgbaRawData(
-                val rgbaBytes: ByteArray
+                val rgba: ByteBuffer,
+                val rgbaStride: Int
             ) : ImageRawData()
 
             class Yuv420pRawData(
-                val yBytes: ByteArray,
-                val uBytes: ByteArray,
-                val vBytes: ByteArray
+                val y: ByteBuffer,
+                val yStride: Int,
+                val u: ByteBuffer,
+                val uStride: Int,
+                val v: ByteBuffer,
+                val vStride: Int
             ) : ImageRawData()
 
             class Yuv420spRawData(
-                val yBytes: ByteArray,
-                val uvBytes: ByteArray,
+                val y: ByteBuffer,
+                val yStride: Int,
+                val uv: ByteBuffer,
+                val uvStride: Int,
                 val yuv420spType: Yuv420spType
             ) : ImageRawData()
+
+            class Yuv420p10RawData(
+                val y: ByteBuffer,
+                val yStride: Int,
+                val u: ByteBuffer,
+                val uStride: Int,
+                val v: ByteBuffer,
+                val vStride: Int
+            ) : ImageRawData()
+
+            class P010RawData(
+                val y: ByteBuffer,
+                val yStride: Int,
+                val uv: ByteBuffer,
+                val uvStride: Int
+            ) : ImageRawData()
         }
 
         data class ImageData(
@@ -0,0 +1,174 @@
+package com.tans.tmediaplayer.player.playerview.texconverter
+
+import android.content.Context
+import android.opengl.GLES30
+import com.tans.tmediaplayer.MediaLog
+import com.tans.tmediaplayer.R
+import com.tans.tmediaplayer.player.playerview.compileShaderProgram
+import com.tans.tmediaplayer.player.playerview.glGenBuffers
+import com.tans.tmediaplayer.player.playerview.glGenTextureAndSetDefaultParams
+import com.tans.tmediaplayer.player.playerview.glGenVertexArrays
+import com.tans.tmediaplayer.player.playerview.glTexImage2DWithStride
+import com.tans.tmediaplayer.player.playerview.offScreenRender
+import com.tans.tmediaplayer.player.playerview.tMediaPlayerView
+import com.tans.tmediaplayer.player.playerview.toGlBuffer
+import java.util.concurrent.atomic.AtomicReference
+
+/**
+ * Yuv420p10 and P010, samples uploaded as 16 bits integer textures without down conversion.
+ */
+internal class HighBitDepthYuvImageTextureConverter : ImageTextureConverter {
+
+    private val renderData: AtomicReference<RenderData?> by lazy {
+        AtomicReference()
+    }
+
+    override fun convertImageToTexture(
+        context: Context,
+        surfaceSize: tMediaPlayerView.Companion.SurfaceSizeCache,
+        imageData: tMediaPlayerView.Companion.ImageData
+    ): Int {
+        val rawImageData = imageData.imageRawData
+        return if (rawImageData is tMediaPlayerView.Companion.ImageRawData.Yuv420p10RawData || rawImageData is tMediaPlayerView.Companion.ImageRawData.P010RawData) {
+            val renderData = ensureRenderData(context)
+            if (renderData != null) {
+                offScreenRender(
+                    outputTexId = renderData.outputTexId,
+                    outputTexWidth = imageData.imageWidth,
+                    outputTexHeight = imageData.imageHeight
+                ) {
+                    GLES30.glUseProgram(renderData.program)
+                    if (rawImageData is tMediaPlayerView.Companion.ImageRawData.Yuv420p10RawData) {
+                        // y
+                        GLES30.glActiveTexture(GLES30.GL_TEXTURE0)
+                        GLES30.glBindTexture(GLES30.GL_TEXTURE_2D, renderData.yTexId)
+                        glTexImage2DWithStride(GLES30.GL_R16UI, imageData.imageWidth, imageData.imageHeight,
+                            GLES30.GL_RED_INTEGER, 2, rawImageData.y, rawImageData.yStride, GLES30.GL_UNSIGNED_SHORT)
+                        GLES30.glUniform1i(GLES30.glGetUniformLocation(renderData.program, "yTexture"), 0)
+
+                        // u
+                        GLES30.glActiveTexture(GLES30.GL_TEXTURE1)
+                        GLES30.glBindTexture(GLES30.GL_TEXTURE_2D, renderData.uTexId)
+                        glTexImage2DWithStride(GLES30.GL_R16UI, imageData.imageWidth / 2, imageData.imageHeight / 2,
+                            GLES30.GL_RED_INTEGER, 2, rawImageData.u, rawImageData.uStride, GLES30.GL_UNSIGNED_SHORT)
+                        GLES30.glUniform1i(GLES30.glGetUniformLocation(renderData.program, "uTexture"), 1)
+
+                        // v
+                        GLES30.glActiveTexture(GLES30.GL_TEXTURE2)
+                        GLES30.glBindTexture(GLES30.GL_TEXTURE_2D, renderData.vTexId)
+                        glTexImage2DWithStride(GLES30.GL_R16UI, imageData.imageWidth / 2, imageData.imageHeight / 2,
+                            GLES30.GL_RED_INTEGER, 2, rawImageData.v, rawImageData.vStride, GLES30.GL_UNSIGNED_SHORT)
+                        GLES30.glUniform1i(GLES30.glGetUniformLocation(renderData.program, "vTexture"), 2)
+
+                        GLES30.glUniform1i(GLES30.glGetUniformLocation(renderData.program, "semiPlanar"), 0)
+                        GLES30.glUniform1f(GLES30.glGetUniformLocation(renderData.program, "sampleScale"), 1.0f / 1023.0f)
+                    } else if (rawImageData is tMediaPlayerView.Companion.ImageRawData.P010RawData) {
+                        // y
+                        GLES30.glActiveTexture(GLES30.GL_TEXTURE0)
+                        GLES30.glBindTexture(GLES30.GL_TEXTURE_2D, renderData.yTexId)
+                        glTexImage2DWithStride(GLES30.GL_R16UI, imageData.imageWidth, imageData.imageHeight,
+                            GLES30.GL_RED_INTEGER, 2, rawImageData.y, rawImageData.yStride, GLES30.GL_UNSIGNED_SHORT)
+                        GLES30.glUniform1i(GLES30.glGetUniformLocation(renderData.program, "yTexture"), 0)
+
+                        // uv
+                        GLES30.glActiveTexture(GLES30.GL_TEXTURE1)
+                        GLES30.glBindTexture(GLES30.GL_TEXTURE_2D, renderData.uTexId)
+                        glTexImage2DWithStride(GLES30.GL_RG16UI, imageData.imageWidth / 2, imageData.imageHeight / 2,
+                            GLES30.GL_RG_INTEGER, 4, rawImageData.uv, rawImageData.uvStride, GLES30.GL_UNSIGNED_SHORT)
+                        GLES30.glUniform1i(GLES30.glGetUniformLocation(renderData.program, "uTexture"), 1)
+                        // Not sampled, bind to unit of uv.
+                        GLES30.glUniform1i(GLES30.glGetUniformLocation(renderData.program, "vTexture"), 1)
+
+                        GLES30.glUniform1i(GLES30.glGetUniformLocation(renderData.program, "semiPlanar"), 1)
+                        GLES30.glUniform1f(GLES30.glGetUniformLocation(renderData.program, "sampleScale"), 1.0f / 65535.0f)
+                    }
+
+                    GLES30.glBindVertexArray(renderData.vao)
+                    GLES30.glBindBuffer(GLES30.GL_ARRAY_BUFFER, renderData.vbo)
+                    GLES30.glDrawArrays(GLES30.GL_TRIANGLE_FAN, 0, 4)
+                }
+                renderData.outputTexId
+            } else {
+                MediaLog.e(TAG, "Render data is null.")
+                0
+            }
+        } else {
+            MediaLog.e(TAG, "Wrong image type: ${imageData.imageRawData::class.java.simpleName}")
+            0
+        }
+    }
+
+    override fun recycle() {
+        val renderData = this.renderData.get()
+        if (renderData != null) {
+            this.renderData.set(null)
+            GLES30.glDeleteTextures(1, intArrayOf(renderData.yTexId), 0)
+            GLES30.glDeleteTextures(1, intArrayOf(renderData.uTexId), 0)
+            GLES30.glDeleteTextures(1, intArrayOf(renderData.vTexId), 0)
+            GLES30.glDeleteBuffers(1, intArrayOf(renderData.vbo), 0)
+            GLES30.glDeleteTextures(1, intArrayOf(renderData.outputTexId), 0)
+            GLES30.glDeleteProgram(renderData.program)
+        }
+    }
+
+    private fun ensureRenderData(context: Context): RenderData? {
+        val renderData = renderData.get()
+        if (renderData != null) {
+            return renderData
+        } else {
+            val program = compileShaderProgram(context, R.raw.t_media_player_yuv420p_vert, R.raw.t_media_player_yuv16_frag) ?: return null
+            val outputTexId = glGenTextureAndSetDefaultParams()
+            val yTexId = glGenIntegerTexture()
+            val uTexId = glGenIntegerTexture()
+            val vTexId = glGenIntegerTexture()
+            val vertices = floatArrayOf(
+                // 坐标(position 0)   // 纹理坐标
+                -1.0f, 1.0f,        0.0f, 1.0f,    // 左上角
+                1.0f, 1.0f,         1.0f, 1.0f,   // 右上角
+                1.0f, -1.0f,        1.0f, 0.0f,   // 右下角
+                -1.0f, -1.0f,       0.0f, 0.0f,   // 左下角
+            )
+            val vao = glGenVertexArrays()
+            val vbo = glGenBuffers()
+            GLES30.glBindVertexArray(vao)
+            GLES30.glBindBuffer(GLES30.GL_ARRAY_BUFFER, vbo)
+            GLES30.glVertexAttribPointer(0, 4, GLES30.GL_FLOAT, false, 16, 0)
+            GLES30.glEnableVertexAttribArray(0)
+            GLES30.glBufferData(GLES30.GL_ARRAY_BUFFER, vertices.size * 4, vertices.toGlBuffer(), GLES30.GL_STATIC_DRAW)
+            val result = RenderData(
+                yTexId = yTexId,
+                uTexId = uTexId,
+                vTexId = vTexId,
+                vao = vao,
+                vbo = vbo,
+                program = program,
+                outputTexId = outputTexId
+            )
+            this.renderData.set(result)
+            return result
+        }
+    }
+
+    /**
+     * Integer textures are incomplete with linear filter.
+     */
+    private fun glGenIntegerTexture(): Int {
+        val tex = glGenTextureAndSetDefaultParams()
+        GLES30.glTexParameteri(GLES30.GL_TEXTURE_2D, GLES30.GL_TEXTURE_MIN_FILTER, GLES30.GL_NEAREST)
+        GLES30.glTexParameteri(GLES30.GL_TEXTURE_2D, GLES30.GL_TEXTURE_MAG_FILTER, GLES30.GL_NEAREST)
+        return tex
+    }
+
+    companion object {
+        private const val TAG = "HighBitDepthYuvImageTextureConverter"
+        data class RenderData(
+            val yTexId: Int,
+            val uTexId: Int,
+            val vTexId: Int,
+            val vao: Int,
+            val vbo: Int,
+            val program: Int,
+            val outputTexId: Int
+        )
+    }
+}
\ No newline at end of file
@@ -4,8 +4,8 @@ import android.content.Context
 import android.opengl.GLES30
 import com.tans.tmediaplayer.MediaLog
 import com.tans.tmediaplayer.player.playerview.glGenTextureAndSetDefaultParams
+import com.tans.tmediaplayer.player.playerview.glTexImage2DWithStride
 import com.tans.tmediaplayer.player.playerview.tMediaPlayerView
-import java.nio.ByteBuffer
 import java.util.concurrent.atomic.AtomicReference
 
 internal class RgbaImageTextureConverter : ImageTextureConverter {
@@ -22,16 +22,14 @@ internal class RgbaImageTextureConverter : ImageTextureConverter {
         return if (imageData.imageRawData is tMediaPlayerView.Companion.ImageRawData.RgbaRawData) {
             val renderData = ensureRenderData()
             GLES30.glBindTexture(GLES30.GL_TEXTURE_2D, renderData.outputTexId)
-            GLES30.glTexImage2D(
-                GLES30.GL_TEXTURE_2D,
-                0,
+            glTexImage2DWithStride(
                 GLES30.GL_RGBA,
                 imageData.imageWidth,
                 imageData.imageHeight,
-                0,
                 GLES30.GL_RGBA,
-                GLES30.GL_UNSIGNED_BYTE,
-                ByteBuffer.wrap(imageData.imageRawData.rgbaBytes)
+                4,
+                imageData.imageRawData.rgba,
+                imageData.imageRawData.rgbaStride
             )
             renderData.outputTexId
         } else {
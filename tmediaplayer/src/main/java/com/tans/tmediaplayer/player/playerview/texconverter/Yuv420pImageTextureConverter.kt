@@ -8,10 +8,10 @@ import com.tans.tmediaplayer.player.playerview.compileShaderProgram
 import com.tans.tmediaplayer.player.playerview.glGenBuffers
 import com.tans.tmediaplayer.player.playerview.glGenTextureAndSetDefaultParams
 import com.tans.tmediaplayer.player.playerview.glGenVertexArrays
+import com.tans.tmediaplayer.player.playerview.glTexImage2DWithStride
 import com.tans.tmediaplayer.player.playerview.offScreenRender
 import com.tans.tmediaplayer.player.playerview.tMediaPlayerView
 import com.tans.tmediaplayer.player.playerview.toGlBuffer
-import java.nio.ByteBuffer
 import java.util.concurrent.atomic.AtomicReference
 
 internal class Yuv420pImageTextureConverter : ImageTextureConverter {
@@ -38,22 +38,22 @@ internal class Yuv420pImageTextureConverter : ImageTextureConverter {
                     // y
                     GLES30.glActiveTexture(GLES30.GL_TEXTURE0)
                     GLES30.glBindTexture(GLES30.GL_TEXTURE_2D, renderData.yTexId)
-                    GLES30.glTexImage2D(GLES30.GL_TEXTURE_2D, 0, GLES30.GL_LUMINANCE, imageData.imageWidth, imageData.imageHeight,
-                        0, GLES30.GL_LUMINANCE, GLES30.GL_UNSIGNED_BYTE, ByteBuffer.wrap(rawImageData.yBytes))
+                    glTexImage2DWithStride(GLES30.GL_LUMINANCE, imageData.imageWidth, imageData.imageHeight,
+                        GLES30.GL_LUMINANCE, 1, rawImageData.y, rawImageData.yStride)
                     GLES30.glUniform1i(GLES30.glGetUniformLocation(renderData.program, "yTexture"), 0)
 
                     // u
                     GLES30.glActiveTexture(GLES30.GL_TEXTURE1)
                     GLES30.glBindTexture(GLES30.GL_TEXTURE_2D, renderData.uTexId)
-                    GLES30.glTexImage2D(GLES30.GL_TEXTURE_2D, 0, GLES30.GL_LUMINANCE, imageData.imageWidth / 2, imageData.imageHeight / 2,
-                        0, GLES30.GL_LUMINANCE, GLES30.GL_UNSIGNED_BYTE, ByteBuffer.wrap(rawImageData.uBytes))
+                    glTexImage2DWithStride(GLES30.GL_LUMINANCE, imageData.imageWidth / 2, imageData.imageHeight / 2,
+                        GLES30.GL_LUMINANCE, 1, rawImageData.u, rawImageData.uStride)
                     GLES30.glUniform1i(GLES30.glGetUniformLocation(renderData.program, "uTexture"), 1)
 
                     // v
                     GLES30.glActiveTexture(GLES30.GL_TEXTURE2)
                     GLES30.glBindTexture(GLES30.GL_TEXTURE_2D, renderData.vTexId)
-                    GLES30.glTexImage2D(GLES30.GL_TEXTURE_2D, 0, GLES30.GL_LUMINANCE, imageData.imageWidth / 2, imageData.imageHeight / 2,
-                        0, GLES30.GL_LUMINANCE, GLES30.GL_UNSIGNED_BYTE, ByteBuffer.wrap(rawImageData.vBytes))
+                    glTexImage2DWithStride(GLES30.GL_LUMINANCE, imageData.imageWidth / 2, imageData.imageHeight / 2,
+                        GLES30.GL_LUMINANCE, 1, rawImageData.v, rawImageData.vStride)
                     GLES30.glUniform1i(GLES30.glGetUniformLocation(renderData.program, "vTexture"), 2)
 
                     GLES30.glBindVertexArray(renderData.vao)
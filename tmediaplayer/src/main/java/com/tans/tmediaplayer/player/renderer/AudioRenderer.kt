@@ -11,7 +11,7 @@ import com.tans.tmediaplayer.player.model.AudioSampleRate
 import com.tans.tmediaplayer.player.model.OptResult
 import com.tans.tmediaplayer.player.rwqueue.AudioFrame
 import com.tans.tmediaplayer.player.rwqueue.AudioFrameQueue
-import com.tans.tmediaplayer.player.rwqueue.PacketQueue
+import com.tans.tmediaplayer.player.rwqueue.NativePacketQueue
 import com.tans.tmediaplayer.player.tMediaPlayer
 import java.util.concurrent.LinkedBlockingDeque
 import java.util.concurrent.atomic.AtomicBoolean
@@ -23,7 +23,7 @@ internal class AudioRenderer(
     outputSampleBitDepth: AudioSampleBitDepth,
     bufferQueueSize: Int = 12,
     private val audioFrameQueue: AudioFrameQueue,
-    private val audioPacketQueue: PacketQueue,
+    private val audioPacketQueue: NativePacketQueue,
     private val player: tMediaPlayer
 ) {
     private val audioTrack: tMediaAudioTrack by lazy {
@@ -37,6 +37,7 @@ internal class AudioRenderer(
             if (frame != null) {
                 player.audioClock.setClock(frame.pts, frame.serial)
                 player.externalClock.syncToClock(player.audioClock)
+                player.frameRendered()
                 audioFrameQueue.enqueueWritable(frame)
                 player.writeableAudioFrameReady()
             }
@@ -12,18 +12,20 @@ import com.tans.tmediaplayer.player.model.SYNC_THRESHOLD_MIN
 import com.tans.tmediaplayer.player.model.SyncType
 import com.tans.tmediaplayer.player.model.VIDEO_REFRESH_RATE
 import com.tans.tmediaplayer.player.playerview.tMediaPlayerView
-import com.tans.tmediaplayer.player.rwqueue.PacketQueue
+import com.tans.tmediaplayer.player.rwqueue.NativePacketQueue
 import com.tans.tmediaplayer.player.rwqueue.VideoFrame
 import com.tans.tmediaplayer.player.rwqueue.VideoFrameQueue
 import com.tans.tmediaplayer.player.tMediaPlayer
 import java.util.concurrent.atomic.AtomicBoolean
+import java.util.concurrent.atomic.AtomicLong
 import java.util.concurrent.atomic.AtomicReference
+import kotlin.math.abs
 import kotlin.math.max
 import kotlin.math.min
 
 internal class VideoRenderer(
     private val videoFrameQueue: VideoFrameQueue,
-    private val videoPacketQueue: PacketQueue,
+    private val videoPacketQueue: NativePacketQueue,
     private val player: tMediaPlayer
 ) {
     private val playerView: AtomicReference<tMediaPlayerView?> = AtomicReference()
@@ -51,6 +53,9 @@ internal class VideoRenderer(
 
     private val renderForce: AtomicBoolean = AtomicBoolean(false)
 
+    // Pts of last frame sent to player view, -1 means no frame rendered.
+    private val lastRenderedPts: AtomicLong = AtomicLong(-1L)
+
     private val videoRendererHandler: Handler by lazy {
         object : Handler(videoRendererThread.looper) {
 
@@ -179,6 +184,8 @@ internal class VideoRenderer(
             }
 
             fun renderVideoFrame(frame: VideoFrame) {
+                player.frameRendered()
+                lastRenderedPts.set(frame.pts)
                 val playerView = this@VideoRenderer.playerView.get()
                 if (playerView != null) {
                     when (frame.imageType) {
@@ -190,9 +197,12 @@ internal class VideoRenderer(
                                 playerView.requestRenderYuv420pFrame(
                                     width = frame.width,
                                     height = frame.height,
-                                    yBytes = y,
-                                    uBytes = u,
-                                    vBytes = v
+                                    y = y,
+                                    yStride = frame.yStride,
+                                    u = u,
+                                    uStride = frame.uStride,
+                                    v = v,
+                                    vStride = frame.vStride
                                 ) {
                                     videoFrameQueue.enqueueWritable(frame)
                                     player.writeableVideoFrameReady()
@@ -207,11 +217,14 @@ internal class VideoRenderer(
                             val y = frame.yBuffer
                             val uv = frame.uvBuffer
                             if (y != null && uv != null) {
-                                playerView.requestRenderNv12Frame(
+                                playerView.requestRenderYuv420spFrame(
                                     width = frame.width,
                                     height = frame.height,
-                                    yBytes = y,
-                                    uvBytes = uv
+                                    y = y,
+                                    yStride = frame.yStride,
+                                    uv = uv,
+                                    uvStride = frame.uvStride,
+                                    yuv420spType = tMediaPlayerView.Companion.Yuv420spType.Nv12
                                 ) {
                                     videoFrameQueue.enqueueWritable(frame)
                                     player.writeableVideoFrameReady()
@@ -226,11 +239,14 @@ internal class VideoRenderer(
                             val y = frame.yBuffer
                             val vu = frame.uvBuffer
                             if (y != null && vu != null) {
-                                playerView.requestRenderNv21Frame(
+                                playerView.requestRenderYuv420spFrame(
                                     width = frame.width,
                                     height = frame.height,
-                                    yBytes = y,
-                                    vuBytes = vu
+                                    y = y,
+                                    yStride = frame.yStride,
+                                    uv = vu,
+                                    uvStride = frame.uvStride,
+                                    yuv420spType = tMediaPlayerView.Companion.Yuv420spType.Nv21
                                 ) {
                                     videoFrameQueue.enqueueWritable(frame)
                                     player.writeableVideoFrameReady()
@@ -247,7 +263,53 @@ internal class VideoRenderer(
                                 playerView.requestRenderRgbaFrame(
                                     width = frame.width,
                                     height = frame.height,
-                                    imageBytes = rgba
+                                    rgba = rgba,
+                                    rgbaStride = frame.rgbaStride
+                                ) {
+                                    videoFrameQueue.enqueueWritable(frame)
+                                    player.writeableVideoFrameReady()
+                                }
+                            } else {
+                                MediaLog.e(TAG, "Wrong ${frame.imageType} image.")
+                                videoFrameQueue.enqueueWritable(frame)
+                                player.writeableVideoFrameReady()
+                            }
+                        }
+                        ImageRawType.Yuv420p10 -> {
+                            val y = frame.yBuffer
+                            val u = frame.uBuffer
+                            val v = frame.vBuffer
+                            if (y != null && u != null && v != null) {
+                                playerView.requestRenderYuv420p10Frame(
+                                    width = frame.width,
+                                    height = frame.height,
+                                    y = y,
+                                    yStride = frame.yStride,
+                                    u = u,
+                                    uStride = frame.uStride,
+                                    v = v,
+                                    vStride = frame.vStride
+                                ) {
+                                    videoFrameQueue.enqueueWritable(frame)
+                                    player.writeableVideoFrameReady()
+                                }
+                            } else {
+                                MediaLog.e(TAG, "Wrong ${frame.imageType} image.")
+                                videoFrameQueue.enqueueWritable(frame)
+                                player.writeableVideoFrameReady()
+                            }
+                        }
+                        ImageRawType.P010 -> {
+                            val y = frame.yBuffer
+                            val uv = frame.uvBuffer
+                            if (y != null && uv != null) {
+                                playerView.requestRenderP010Frame(
+                                    width = frame.width,
+                                    height = frame.height,
+                                    y = y,
+                                    yStride = frame.yStride,
+                                    uv = uv,
+                                    uvStride = frame.uvStride
                                 ) {
                                     videoFrameQueue.enqueueWritable(frame)
                                     player.writeableVideoFrameReady()
@@ -270,7 +332,19 @@ internal class VideoRenderer(
             }
 
             fun frameDuration(current: LastRenderFrame, next: VideoFrame): Long {
-                return if (current.serial == next.serial) {
+                val trickPlaySpeed = player.getTrickPlaySpeed()
+                return if (current.serial == next.serial && trickPlaySpeed != 0) {
+                    // Key frames only, media time between them passes at trick play speed, pts decrease when rewind.
+                    abs(next.pts - current.pts) / abs(trickPlaySpeed)
+                } else if (current.serial == next.serial && player.isReversePlayback()) {
+                    // Pts decrease when reverse playback.
+                    val duration = current.pts - next.pts
+                    if (duration <= 0) {
+                        current.duration
+                    } else {
+                        duration
+                    }
+                } else if (current.serial == next.serial) {
                     val duration = next.pts - current.pts
                     if (duration <= 0) {
                         current.duration
@@ -343,19 +417,24 @@ internal class VideoRenderer(
         }
     }
 
-    fun requestRenderForce() {
+    fun requestRenderForce(): Boolean {
         val state = getState()
-        if (state != RendererState.NotInit && state != RendererState.Released) {
+        return if (state != RendererState.NotInit && state != RendererState.Released) {
             if (renderForce.compareAndSet(false, true)) {
                 requestRender()
+                true
             } else {
                 MediaLog.e(TAG, "Force render error, already have a force render task.")
+                false
             }
         } else {
             MediaLog.e(TAG, "Force render error, because of state: $state")
+            false
         }
     }
 
+    fun getLastRenderedPts(): Long = lastRenderedPts.get()
+
     fun release() {
         synchronized(this) {
             val state = getState()
@@ -375,6 +454,8 @@ internal class VideoRenderer(
         this.playerView.set(view)
     }
 
+    fun hasPlayerView(): Boolean = playerView.get() != null
+
     fun getState(): RendererState = state.get()
 
     private fun requestRender(delay: Long = 0) {
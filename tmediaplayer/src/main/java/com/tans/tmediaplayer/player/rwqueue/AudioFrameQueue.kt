@@ -28,6 +28,13 @@ internal class AudioFrameQueue(private val player: tMediaPlayer) : BaseReadWrite
         super.enqueueReadable(b)
     }
 
+    /**
+     * Frame info already filled by batch decode descriptors.
+     */
+    fun enqueueDecodedReadable(b: AudioFrame) {
+        super.enqueueReadable(b)
+    }
+
     override fun enqueueWritable(b: AudioFrame) {
         b.pts = 0
         b.duration = 0
@@ -0,0 +1,83 @@
+package com.tans.tmediaplayer.player.rwqueue
+
+import com.tans.tmediaplayer.MediaLog
+import com.tans.tmediaplayer.player.tMediaPlayer
+import java.util.concurrent.locks.ReentrantReadWriteLock
+import kotlin.concurrent.read
+import kotlin.concurrent.write
+
+/**
+ * Audio/Video packet queue, packets are pushed by native packet reader and popped by native decoders,
+ * Java side only read aggregate counters.
+ */
+internal class NativePacketQueue(
+    private val player: tMediaPlayer
+) {
+
+    val nativeQueue: Long = player.allocPacketQueueInternal()
+
+    /**
+     * Native accessors hold read lock, release holds write lock, so native queue can't be freed during an access from
+     * clock, renderers or decoders.
+     */
+    private val releaseLock: ReentrantReadWriteLock = ReentrantReadWriteLock()
+
+    private var isReleased: Boolean = nativeQueue == 0L
+
+    init {
+        if (nativeQueue == 0L) {
+            MediaLog.e(TAG, "Alloc native packet queue fail.")
+        }
+    }
+
+    /**
+     * False if native queue alloc fail or released.
+     */
+    fun isAvailable(): Boolean = releaseLock.read { !isReleased }
+
+    fun getCount(): Int = releaseLock.read { if (isReleased) 0 else player.getPacketQueueCountInternal(nativeQueue) }
+
+    fun isCanRead(): Boolean = getCount() > 0
+
+    fun getDuration(): Long = releaseLock.read { if (isReleased) 0L else player.getPacketQueueDurationInternal(nativeQueue) }
+
+    fun getSizeInBytes(): Long = releaseLock.read { if (isReleased) 0L else player.getPacketQueueSizeInBytesInternal(nativeQueue) }
+
+    fun getSerial(): Int = releaseLock.read { if (isReleased) 0 else player.getPacketQueueSerialInternal(nativeQueue) }
+
+    /**
+     * Only call by packet reader thread, old serial packets are dropped by decoders.
+     */
+    fun flushReadableBuffer() {
+        releaseLock.read {
+            if (!isReleased) {
+                player.flushPacketQueueInternal(nativeQueue)
+            }
+        }
+    }
+
+    /**
+     * Need packet reader and decoders stopped.
+     */
+    fun clear() {
+        releaseLock.read {
+            if (!isReleased) {
+                player.clearPacketQueueInternal(nativeQueue)
+            }
+        }
+    }
+
+    fun release() {
+        releaseLock.write {
+            if (!isReleased) {
+                isReleased = true
+                player.releasePacketQueueInternal(nativeQueue)
+                MediaLog.d(TAG, "Release native packet queue.")
+            }
+        }
+    }
+
+    companion object {
+        private const val TAG = "NativePacketQueue"
+    }
+}
@@ -1,6 +1,7 @@
 package com.tans.tmediaplayer.player.rwqueue
 
 import com.tans.tmediaplayer.player.model.ImageRawType
+import java.nio.ByteBuffer
 
 internal class VideoFrame(val nativeFrame: Long) {
     var pts: Long = 0L
@@ -9,11 +10,21 @@ internal class VideoFrame(val nativeFrame: Long) {
     var imageType: ImageRawType = ImageRawType.Unknown
     var width: Int = 0
     var height: Int = 0
-    var yBuffer: ByteArray? = null
-    var uBuffer: ByteArray? = null
-    var vBuffer: ByteArray? = null
-    var uvBuffer: ByteArray? = null
-    var rgbaBuffer: ByteArray? = null
+    /**
+     * Direct views of native planes, or packed copies when plane can't be viewed. Valid until frame enqueued writable.
+     * Strides are bytes count of a row.
+     */
+    var yBuffer: ByteBuffer? = null
+    var yStride: Int = 0
+    var uBuffer: ByteBuffer? = null
+    var uStride: Int = 0
+    var vBuffer: ByteBuffer? = null
+    var vStride: Int = 0
+    var uvBuffer: ByteBuffer? = null
+    var uvStride: Int = 0
+    var rgbaBuffer: ByteBuffer? = null
+    var rgbaStride: Int = 0
+    val packedCopies: Array<ByteArray?> = arrayOfNulls(3)
     var isEof: Boolean = false
 
     override fun toString(): String {
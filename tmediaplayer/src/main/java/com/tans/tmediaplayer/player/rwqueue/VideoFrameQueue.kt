@@ -3,6 +3,7 @@ package com.tans.tmediaplayer.player.rwqueue
 import com.tans.tmediaplayer.MediaLog
 import com.tans.tmediaplayer.player.model.ImageRawType
 import com.tans.tmediaplayer.player.tMediaPlayer
+import java.nio.ByteBuffer
 import java.util.concurrent.atomic.AtomicInteger
 
 internal class VideoFrameQueue(private val player: tMediaPlayer) : BaseReadWriteQueue<VideoFrame>() {
@@ -30,61 +31,116 @@ internal class VideoFrameQueue(private val player: tMediaPlayer) : BaseReadWrite
             b.imageType = player.getVideoFrameTypeNativeInternal(b.nativeFrame)
             b.width = player.getVideoWidthNativeInternal(b.nativeFrame)
             b.height = player.getVideoHeightNativeInternal(b.nativeFrame)
-            when (b.imageType) {
-                ImageRawType.Yuv420p -> {
-                    // Y
-                    val ySize = player.getVideoFrameYSizeNativeInternal(b.nativeFrame)
-                    if (b.yBuffer?.size != ySize) {
-                        b.yBuffer = ByteArray(ySize)
-                    }
-                    player.getVideoFrameYBytesNativeInternal(b.nativeFrame, b.yBuffer!!)
+            loadPlanes(b)
+        }
+        super.enqueueReadable(b)
+    }
 
-                    // U
-                    val uSize = player.getVideoFrameUSizeNativeInternal(b.nativeFrame)
-                    if (b.uBuffer?.size != uSize) {
-                        b.uBuffer = ByteArray(uSize)
-                    }
-                    player.getVideoFrameUBytesNativeInternal(b.nativeFrame, b.uBuffer!!)
+    /**
+     * Frame info already filled by batch decode descriptors, only planes need load.
+     */
+    fun enqueueDecodedReadable(b: VideoFrame) {
+        loadPlanes(b)
+        super.enqueueReadable(b)
+    }
 
-                    // V
-                    val vSize = player.getVideoFrameVSizeNativeInternal(b.nativeFrame)
-                    if (b.vBuffer?.size != vSize) {
-                        b.vBuffer = ByteArray(vSize)
-                    }
-                    player.getVideoFrameVBytesNativeInternal(b.nativeFrame, b.vBuffer!!)
+    private fun loadPlanes(b: VideoFrame) {
+        when (b.imageType) {
+            ImageRawType.Yuv420p -> {
+                loadPlane(b, 0, b.width, player::getVideoFrameYSizeNativeInternal, player::getVideoFrameYBytesNativeInternal) { buffer, stride ->
+                    b.yBuffer = buffer
+                    b.yStride = stride
                 }
-                ImageRawType.Nv12, ImageRawType.Nv21 -> {
-                    // Y
-                    val ySize = player.getVideoFrameYSizeNativeInternal(b.nativeFrame)
-                    if (b.yBuffer?.size != ySize) {
-                        b.yBuffer = ByteArray(ySize)
-                    }
-                    player.getVideoFrameYBytesNativeInternal(b.nativeFrame, b.yBuffer!!)
-
-                    // UV/VU
-                    val uvSize = player.getVideoFrameUVSizeNativeInternal(b.nativeFrame)
-                    if (b.uvBuffer?.size != uvSize) {
-                        b.uvBuffer = ByteArray(uvSize)
-                    }
-                    player.getVideoFrameUVBytesNativeInternal(b.nativeFrame, b.uvBuffer!!)
+                loadPlane(b, 1, b.width / 2, player::getVideoFrameUSizeNativeInternal, player::getVideoFrameUBytesNativeInternal) { buffer, stride ->
+                    b.uBuffer = buffer
+                    b.uStride = stride
                 }
-                ImageRawType.Rgba -> {
-                    // Rgba
-                    val rgbaSize = player.getVideoFrameRgbaSizeNativeInternal(b.nativeFrame)
-                    if (b.rgbaBuffer?.size != rgbaSize) {
-                        b.rgbaBuffer = ByteArray(rgbaSize)
-                    }
-                    player.getVideoFrameRgbaBytesNativeInternal(b.nativeFrame, b.rgbaBuffer!!)
+                loadPlane(b, 2, b.width / 2, player::getVideoFrameVSizeNativeInternal, player::getVideoFrameVBytesNativeInternal) { buffer, stride ->
+                    b.vBuffer = buffer
+                    b.vStride = stride
                 }
-                ImageRawType.Unknown -> {
-
+            }
+            ImageRawType.Nv12, ImageRawType.Nv21 -> {
+                loadPlane(b, 0, b.width, player::getVideoFrameYSizeNativeInternal, player::getVideoFrameYBytesNativeInternal) { buffer, stride ->
+                    b.yBuffer = buffer
+                    b.yStride = stride
+                }
+                // UV/VU
+                loadPlane(b, 1, b.width, player::getVideoFrameUVSizeNativeInternal, player::getVideoFrameUVBytesNativeInternal) { buffer, stride ->
+                    b.uvBuffer = buffer
+                    b.uvStride = stride
                 }
             }
+            ImageRawType.Rgba -> {
+                loadPlane(b, 0, b.width * 4, player::getVideoFrameRgbaSizeNativeInternal, player::getVideoFrameRgbaBytesNativeInternal) { buffer, stride ->
+                    b.rgbaBuffer = buffer
+                    b.rgbaStride = stride
+                }
+            }
+            ImageRawType.Yuv420p10 -> {
+                loadPlane(b, 0, b.width * 2, player::getVideoFrameYSizeNativeInternal, player::getVideoFrameYBytesNativeInternal) { buffer, stride ->
+                    b.yBuffer = buffer
+                    b.yStride = stride
+                }
+                loadPlane(b, 1, b.width, player::getVideoFrameUSizeNativeInternal, player::getVideoFrameUBytesNativeInternal) { buffer, stride ->
+                    b.uBuffer = buffer
+                    b.uStride = stride
+                }
+                loadPlane(b, 2, b.width, player::getVideoFrameVSizeNativeInternal, player::getVideoFrameVBytesNativeInternal) { buffer, stride ->
+                    b.vBuffer = buffer
+                    b.vStride = stride
+                }
+            }
+            ImageRawType.P010 -> {
+                loadPlane(b, 0, b.width * 2, player::getVideoFrameYSizeNativeInternal, player::getVideoFrameYBytesNativeInternal) { buffer, stride ->
+                    b.yBuffer = buffer
+                    b.yStride = stride
+                }
+                loadPlane(b, 1, b.width * 2, player::getVideoFrameUVSizeNativeInternal, player::getVideoFrameUVBytesNativeInternal) { buffer, stride ->
+                    b.uvBuffer = buffer
+                    b.uvStride = stride
+                }
+            }
+            ImageRawType.Unknown -> {
+
+            }
+        }
+    }
+
+    /**
+     * Use direct view of native plane, copy to packed array only when the plane can't be viewed.
+     */
+    private inline fun loadPlane(
+        b: VideoFrame,
+        plane: Int,
+        packedStride: Int,
+        sizeGetter: (Long) -> Int,
+        bytesGetter: (Long, ByteArray) -> Unit,
+        setter: (ByteBuffer, Int) -> Unit
+    ) {
+        val view = player.getVideoFramePlaneInternal(b.nativeFrame, plane)
+        if (view != null) {
+            setter(view, player.getVideoFrameLineSizeInternal(b.nativeFrame, plane))
+        } else {
+            val size = sizeGetter(b.nativeFrame)
+            var bytes = b.packedCopies[plane]
+            if (bytes?.size != size) {
+                bytes = ByteArray(size)
+                b.packedCopies[plane] = bytes
+            }
+            bytesGetter(b.nativeFrame, bytes)
+            setter(ByteBuffer.wrap(bytes), packedStride)
         }
-        super.enqueueReadable(b)
     }
 
     override fun enqueueWritable(b: VideoFrame) {
+        // Return referenced decoder frame, plane views are invalid.
+        player.unrefVideoBufferInternal(b.nativeFrame)
+        b.yBuffer = null
+        b.uBuffer = null
+        b.vBuffer = null
+        b.uvBuffer = null
+        b.rgbaBuffer = null
         b.pts = 0
         b.duration = 0
         b.serial = 0
@@ -1,5 +1,6 @@
 package com.tans.tmediaplayer.player
 
+import android.os.SystemClock
 import android.widget.TextView
 import androidx.annotation.Keep
 import com.tans.tmediaplayer.MediaLog
@@ -11,35 +12,55 @@ import com.tans.tmediaplayer.player.model.AudioSampleBitDepth
 import com.tans.tmediaplayer.player.model.AudioSampleFormat
 import com.tans.tmediaplayer.player.model.AudioSampleRate
 import com.tans.tmediaplayer.player.model.AudioStreamInfo
-import com.tans.tmediaplayer.player.model.DecodeResult
+import com.tans.tmediaplayer.player.model.AudioTrackInfo
+import com.tans.tmediaplayer.player.model.BlockingIOStats
+import com.tans.tmediaplayer.player.model.DecodeToBuffersResult
 import com.tans.tmediaplayer.player.model.FFmpegCodec
+import com.tans.tmediaplayer.player.model.FileIOMode
+import com.tans.tmediaplayer.player.model.FileIOStats
+import com.tans.tmediaplayer.player.model.FrameStepStats
+import com.tans.tmediaplayer.player.model.LateVideoFrameDropStats
 import com.tans.tmediaplayer.player.model.ImageRawType
 import com.tans.tmediaplayer.player.model.MediaInfo
 import com.tans.tmediaplayer.player.model.OptResult
-import com.tans.tmediaplayer.player.model.ReadPacketResult
+import com.tans.tmediaplayer.player.model.PacketAllocStats
+import com.tans.tmediaplayer.player.model.PrepareTimings
+import com.tans.tmediaplayer.player.model.ProbeCacheStats
+import com.tans.tmediaplayer.player.model.ReadPacketsToQueueResult
+import com.tans.tmediaplayer.player.model.ReversePlaybackStats
 import com.tans.tmediaplayer.player.model.SubtitleStreamInfo
 import com.tans.tmediaplayer.player.model.SyncType
+import com.tans.tmediaplayer.player.model.VideoConvertCacheStats
+import com.tans.tmediaplayer.player.model.VideoConvertStats
+import com.tans.tmediaplayer.player.model.VideoDecodeDegradeStats
+import com.tans.tmediaplayer.player.model.VideoDecodeThreadType
+import com.tans.tmediaplayer.player.model.VideoDecodeThreadsStats
 import com.tans.tmediaplayer.player.model.VideoPixelFormat
 import com.tans.tmediaplayer.player.model.VideoStreamInfo
-import com.tans.tmediaplayer.player.model.toDecodeResult
+import com.tans.tmediaplayer.player.model.toBlockingIOOp
+import com.tans.tmediaplayer.player.model.toDecodeToBuffersResult
 import com.tans.tmediaplayer.player.model.toImageRawType
 import com.tans.tmediaplayer.player.model.toOptResult
-import com.tans.tmediaplayer.player.model.toReadPacketResult
+import com.tans.tmediaplayer.player.model.toReadPacketsToQueueResult
+import com.tans.tmediaplayer.player.model.toVideoDecodeThreadType
 import com.tans.tmediaplayer.player.pktreader.PacketReader
 import com.tans.tmediaplayer.player.playerview.tMediaPlayerView
 import com.tans.tmediaplayer.player.renderer.AudioRenderer
 import com.tans.tmediaplayer.player.renderer.RendererState
 import com.tans.tmediaplayer.player.renderer.VideoRenderer
-import com.tans.tmediaplayer.player.rwqueue.AudioFrame
 import com.tans.tmediaplayer.player.rwqueue.AudioFrameQueue
-import com.tans.tmediaplayer.player.rwqueue.Packet
-import com.tans.tmediaplayer.player.rwqueue.PacketQueue
-import com.tans.tmediaplayer.player.rwqueue.VideoFrame
+import com.tans.tmediaplayer.player.rwqueue.NativePacketQueue
 import com.tans.tmediaplayer.player.rwqueue.VideoFrameQueue
 import com.tans.tmediaplayer.subtitle.ExternalSubtitle
 import com.tans.tmediaplayer.subtitle.InternalSubtitle
+import java.nio.ByteBuffer
 import java.util.concurrent.Executors
+import java.util.concurrent.atomic.AtomicBoolean
+import java.util.concurrent.atomic.AtomicInteger
+import java.util.concurrent.atomic.AtomicLong
 import java.util.concurrent.atomic.AtomicReference
+import kotlin.math.abs
+import kotlin.math.max
 
 @Suppress("ClassName")
 @Keep
@@ -48,6 +69,28 @@ class tMediaPlayer(
     private val audioOutputSampleRate: AudioSampleRate = AudioSampleRate.Rate48000,
     private val audioOutputSampleBitDepth: AudioSampleBitDepth = AudioSampleBitDepth.SixteenBits,
     private val enableVideoHardwareDecoder: Boolean = true,
+    private val fileIOMode: FileIOMode = FileIOMode.Default,
+    // Ring buffer size of ReadAhead and blocks cache size of AsyncRead and UringRead.
+    private val fileReadAheadBufferSize: Long = DEFAULT_READ_AHEAD_BUFFER_SIZE,
+    // Bounded probing, streams not found by prepare are reported by tMediaPlayerListener.onStreamsDiscovered().
+    private val fastStartPrepare: Boolean = false,
+    private val videoDecodeThreadType: VideoDecodeThreadType = VideoDecodeThreadType.Auto,
+    // 0 means compute by resolution and cpu cores.
+    private val videoDecodeThreadCount: Int = 0,
+    // Skip decode work of late video frames, video decoder catch up with master clock.
+    private val videoDecodeDegrade: Boolean = true,
+    // Drop decoded video frames late than master clock before conversion and copy.
+    private val dropLateVideoFrame: Boolean = true,
+    // Render 10 bits Yuv420p10 and P010 frames directly, skip conversion to 8 bits Yuv420p.
+    private val videoHighBitDepthPassthrough: Boolean = true,
+    // Slice threads of sws conversion, 0 means compute by resolution and cpu cores.
+    private val videoConvertThreadCount: Int = 0,
+    // Downscale decoded frames much larger than attached view's surface, bandwidth scales with view size.
+    private val videoDownscaleToView: Boolean = true,
+    // Frame cache budget of reverse playback's GOP decoder.
+    private val reversePlaybackCacheSize: Long = DEFAULT_REVERSE_PLAYBACK_CACHE_SIZE,
+    // Memory of recently decoded frames kept for stepFrame() backward, frames are only kept while paused.
+    private val frameStepCacheSize: Long = DEFAULT_FRAME_STEP_CACHE_SIZE
 ) : IPlayer {
 
     private val listener: AtomicReference<tMediaPlayerListener?> by lazy {
@@ -58,12 +101,42 @@ class tMediaPlayer(
         AtomicReference(tMediaPlayerState.NoInit)
     }
 
-    private val audioPacketQueue: PacketQueue by lazy {
-        PacketQueue(this)
+    private val audioPacketQueue: NativePacketQueue by lazy {
+        NativePacketQueue(this)
     }
 
-    private val videoPacketQueue: PacketQueue by lazy {
-        PacketQueue(this)
+    // Shared by all native players created by this player, interrupt blocking io of FFmpeg.
+    private val nativeInterrupt: Long = allocInterruptNative()
+
+    // Calls outside player lock use nativeInterrupt with this lock, so it is never used after released.
+    private val interruptLock = Any()
+    private var isInterruptReleased: Boolean = false
+
+    private val blockingIOTimeout: AtomicLong = AtomicLong(0L)
+
+    private val playerView: AtomicReference<tMediaPlayerView?> by lazy {
+        AtomicReference(null)
+    }
+
+    // Surface size of attached view, 0 means not limited.
+    private val videoTargetOutputSize: AtomicReference<Pair<Int, Int>> by lazy {
+        AtomicReference(0 to 0)
+    }
+
+    private val viewSurfaceSizeListener: tMediaPlayerView.Companion.SurfaceSizeListener by lazy {
+        tMediaPlayerView.Companion.SurfaceSizeListener { width, height ->
+            updateVideoTargetOutputSize(width, height)
+        }
+    }
+
+    // Key frame only trick play speed, 0 is normal play, negative is rewind.
+    private val trickPlaySpeed: AtomicInteger = AtomicInteger(0)
+
+    // Play video backward from GOPs decoded by native, audio is muted.
+    private val reversePlayback: AtomicBoolean = AtomicBoolean(false)
+
+    private val videoPacketQueue: NativePacketQueue by lazy {
+        NativePacketQueue(this)
     }
 
     private val audioFrameQueue: AudioFrameQueue by lazy {
@@ -137,6 +210,13 @@ class tMediaPlayer(
 
     private val externalSubtitle: AtomicReference<ExternalSubtitle?> = AtomicReference(null)
 
+    // Prepare timings, uptime millis.
+    @Volatile
+    private var prepareStartTime: Long = 0L
+    @Volatile
+    private var timeToPrepared: Long = -1L
+    private val timeToFirstFrame: AtomicLong = AtomicLong(-1L)
+
     // region public methods
     @Synchronized
     override fun prepare(file: String): OptResult {
@@ -148,6 +228,13 @@ class tMediaPlayer(
                         MediaLog.e(TAG, "Prepare fail, player has released.")
                         return OptResult.Fail
                     }
+                    if (!audioPacketQueue.isAvailable() || !videoPacketQueue.isAvailable()) {
+                        MediaLog.e(TAG, "Prepare fail, native packet queues are not available.")
+                        return OptResult.Fail
+                    }
+                    prepareStartTime = SystemClock.uptimeMillis()
+                    timeToPrepared = -1L
+                    timeToFirstFrame.set(-1L)
                     val lastMediaInfo = getMediaInfo()
                     dispatchNewState(new = tMediaPlayerState.NoInit, old = lastState)
                     if (lastMediaInfo != null) {
@@ -156,9 +243,9 @@ class tMediaPlayer(
                         MediaLog.d(TAG, "Release last native player.")
                     }
 
-                    // Flush pkt and frame queues.
-                    audioPacketQueue.flushReadableBuffer()
-                    videoPacketQueue.flushReadableBuffer()
+                    // Clear pkt queues and flush frame queues.
+                    audioPacketQueue.clear()
+                    videoPacketQueue.clear()
                     audioFrameQueue.flushReadableBuffer()
                     videoFrameQueue.flushReadableBuffer()
 
@@ -167,15 +254,24 @@ class tMediaPlayer(
                     videoClock.initClock(videoPacketQueue)
                     audioClock.initClock(audioPacketQueue)
                     externalClock.initClock(null)
+                    trickPlaySpeed.set(0)
+                    reversePlayback.set(false)
 
                     val nativePlayer = createPlayerNative()
+                    attachPacketQueuesNative(nativePlayer, videoPacketQueue.nativeQueue, audioPacketQueue.nativeQueue)
+                    attachInterruptNative(nativePlayer, nativeInterrupt)
                     val result = prepareNative(
                         nativePlayer = nativePlayer,
                         file = file,
                         requestHw = enableVideoHardwareDecoder,
                         targetAudioChannels = audioOutputChannel.channel,
                         targetAudioSampleRate = audioOutputSampleRate.rate,
-                        targetAudioSampleBitDepth = audioOutputSampleBitDepth.depth
+                        targetAudioSampleBitDepth = audioOutputSampleBitDepth.depth,
+                        ioMode = fileIOMode.ordinal,
+                        readAheadBufferSize = fileReadAheadBufferSize,
+                        fastStart = fastStartPrepare,
+                        videoDecodeThreadType = videoDecodeThreadType.ordinal,
+                        videoDecodeThreadCount = videoDecodeThreadCount
                     ).toOptResult().let {
                         if (it == OptResult.Success) {
                             val mediaInfo = getMediaInfo(nativePlayer)
@@ -191,7 +287,8 @@ class tMediaPlayer(
                     }
                     if (result == OptResult.Success) {
                         // Load media file success.
-                        MediaLog.d(TAG, "Prepare player success: mediaInfo=${getMediaInfo()}")
+                        timeToPrepared = SystemClock.uptimeMillis() - prepareStartTime
+                        MediaLog.d(TAG, "Prepare player success cost ${timeToPrepared}ms: mediaInfo=${getMediaInfo()}")
 
                         // Start reader and decoders
                         packetReader.requestReadPkt()
@@ -204,6 +301,18 @@ class tMediaPlayer(
                         audioRenderer.pause()
                         videoRenderer.pause()
 
+                        // Streams discard
+                        setVideoDiscardedNative(nativePlayer, !videoRenderer.hasPlayerView())
+                        setVideoLateFramePolicyNative(nativePlayer, videoDecodeDegrade, dropLateVideoFrame)
+                        setVideoHighBitDepthPassthroughNative(nativePlayer, videoHighBitDepthPassthrough)
+                        setVideoConvertThreadCountNative(nativePlayer, videoConvertThreadCount)
+                        setFrameStepCacheSizeNative(nativePlayer, frameStepCacheSize)
+                        if (videoDownscaleToView) {
+                            val (targetWidth, targetHeight) = videoTargetOutputSize.get()
+                            setVideoTargetOutputSizeNative(nativePlayer, targetWidth, targetHeight)
+                        }
+                        setSelectedSubtitleStreamNative(nativePlayer, -1)
+
                         // Subtitle
                         internalSubtitle.get()?.resetSubtitle()
                         val lastExternalSubtitle = externalSubtitle.get()
@@ -248,6 +357,8 @@ class tMediaPlayer(
             if (dispatchNewState(new = playingState, old = state)) {
                 MediaLog.d(TAG, "Request play.")
                 playReadPacketNative(playingState.mediaInfo.nativePlayer)
+                // Cached step frames are dropped by video decoder.
+                setFrameStepCacheEnabledNative(playingState.mediaInfo.nativePlayer, false)
                 // Play clocks
                 videoClock.play()
                 audioClock.play()
@@ -290,6 +401,7 @@ class tMediaPlayer(
             if (dispatchNewState(new = pauseState, old = state)) {
                 MediaLog.d(TAG, "Request pause.")
                 pauseReadPacketNative(pauseState.mediaInfo.nativePlayer)
+                setFrameStepCacheEnabledNative(pauseState.mediaInfo.nativePlayer, true)
                 // Pause clocks
                 videoClock.pause()
                 audioClock.pause()
@@ -336,6 +448,8 @@ class tMediaPlayer(
             } else {
                 if (dispatchNewState(new = seekingState, old = state)) {
                     MediaLog.d(TAG, "Request seek $position")
+                    // Reader may block on a slow source.
+                    cancelInterruptNative(nativeInterrupt)
                     packetReader.requestSeek(position)
                     OptResult.Success
                 } else {
@@ -366,6 +480,12 @@ class tMediaPlayer(
         return if (stopState != null) {
             if (dispatchNewState(new = stopState, old = state)) {
                 MediaLog.d(TAG, "Request stop.")
+                if (trickPlaySpeed.get() != 0) {
+                    applyTrickPlaySpeed(stopState.mediaInfo.nativePlayer, 0)
+                }
+                if (reversePlayback.get()) {
+                    applyReversePlayback(stopState.mediaInfo.nativePlayer, false)
+                }
                 // Update clocks and pause them.
                 videoClock.setClock(stopState.mediaInfo.duration, videoPacketQueue.getSerial())
                 videoClock.pause()
@@ -394,8 +514,22 @@ class tMediaPlayer(
         }
     }
 
-    @Synchronized
     override fun release(): OptResult {
+        // Blocking prepare or read return, so locks can be acquired.
+        withInterrupt { abortInterruptNative(it) }
+        return releaseLocked()
+    }
+
+    private inline fun withInterrupt(action: (nativeInterrupt: Long) -> Unit) {
+        synchronized(interruptLock) {
+            if (!isInterruptReleased && getState() != tMediaPlayerState.Released) {
+                action(nativeInterrupt)
+            }
+        }
+    }
+
+    @Synchronized
+    private fun releaseLocked(): OptResult {
         synchronized(packetReader) {
             synchronized(audioDecoder) {
                 synchronized(videoDecoder) {
@@ -418,6 +552,7 @@ class tMediaPlayer(
                         // Renders
                         audioRenderer.release()
                         videoRenderer.release()
+                        playerView.getAndSet(null)?.setSurfaceSizeListener(null)
 
                         // Packet queues
                         audioPacketQueue.release()
@@ -431,6 +566,11 @@ class tMediaPlayer(
                         internalSubtitle.set(null)
                         externalSubtitle.get()?.release()
                         externalSubtitle.set(null)
+
+                        synchronized(interruptLock) {
+                            isInterruptReleased = true
+                            releaseInterruptNative(nativeInterrupt)
+                        }
                         MediaLog.d(TAG, "Release player")
                         return OptResult.Success
                     } else {
@@ -462,7 +602,21 @@ class tMediaPlayer(
     }
 
     override fun attachPlayerView(view: tMediaPlayerView?) {
+        val lastView = playerView.getAndSet(view)
+        if (lastView !== view) {
+            lastView?.setSurfaceSizeListener(null)
+        }
         videoRenderer.attachPlayerView(view)
+        if (view != null) {
+            view.setSurfaceSizeListener(viewSurfaceSizeListener)
+        } else {
+            updateVideoTargetOutputSize(0, 0)
+        }
+        val info = getMediaInfo()
+        if (info != null) {
+            // No view, stop demux video packets.
+            setVideoDiscardedNative(info.nativePlayer, view == null)
+        }
     }
 
     override fun attachSubtitleView(view: TextView?) {
@@ -496,6 +650,7 @@ class tMediaPlayer(
             } else {
                 internalSubtitle?.selectSubtitleStream(subtitle)
             }
+            setSelectedSubtitleStreamNative(info.nativePlayer, subtitle?.streamId ?: -1)
         } else {
             MediaLog.e(TAG, "Wrong subtitle stream info: $subtitle")
         }
@@ -511,7 +666,9 @@ class tMediaPlayer(
 
     @Synchronized
     override fun loadExternalSubtitleFile(file: String) {
-        if (getMediaInfo() != null) {
+        val info = getMediaInfo()
+        if (info != null) {
+            setSelectedSubtitleStreamNative(info.nativePlayer, -1)
             val interSubtitle = internalSubtitle.get()
             if (interSubtitle != null) {
                 interSubtitle.release()
@@ -545,10 +702,425 @@ class tMediaPlayer(
             null
         }
     }
+
+    /**
+     * Only reopen audio decoder, video keep decoding and new audio track play from current progress.
+     */
+    @Synchronized
+    override fun selectAudioTrack(track: AudioTrackInfo): OptResult {
+        val info = getMediaInfo()
+        if (info == null || !info.audioTracks.contains(track)) {
+            MediaLog.e(TAG, "Wrong audio track: $track")
+            return OptResult.Fail
+        }
+        val nativePlayer = info.nativePlayer
+        synchronized(packetReader) {
+            synchronized(audioDecoder) {
+                if (audioStreamIdNative(nativePlayer) == track.streamId) {
+                    return OptResult.Success
+                }
+                val position = getProgress().let { if (it >= 0L) it else videoClock.getClock() }
+                val start = SystemClock.uptimeMillis()
+                val result = switchAudioStreamNative(nativePlayer, track.streamId, position).toOptResult()
+                if (result != OptResult.Success) {
+                    MediaLog.e(TAG, "Switch audio track fail: $track")
+                    return result
+                }
+                // Audio queue flush and clock reset run on packet reader thread.
+                packetReader.requestSwitchAudio(position)
+                val audioStreamInfo = getAudioStreamInfo(nativePlayer)
+                while (true) {
+                    val oldState = getState()
+                    val oldMediaInfo = getMediaInfoByState(oldState) ?: break
+                    val newState = oldState.updateMediaInfo(oldMediaInfo.copy(audioStreamInfo = audioStreamInfo)) ?: break
+                    if (state.compareAndSet(oldState, newState)) {
+                        break
+                    }
+                }
+                MediaLog.d(TAG, "Switch audio track to ${track.streamId} at ${position}ms, cost ${SystemClock.uptimeMillis() - start}ms")
+            }
+        }
+        return OptResult.Success
+    }
+
+    @Synchronized
+    override fun getSelectedAudioTrack(): AudioTrackInfo? {
+        val info = getMediaInfo() ?: return null
+        if (info.audioTracks.isEmpty()) {
+            return null
+        }
+        val streamId = audioStreamIdNative(info.nativePlayer)
+        return info.audioTracks.find { it.streamId == streamId }
+    }
+
+    /**
+     * Custom file io stats, null if current file use FFmpeg default protocol.
+     */
+    fun getFileIOStats(): FileIOStats? {
+        val nativePlayer = getMediaInfo()?.nativePlayer ?: return null
+        val stats = LongArray(4)
+        return if (getFileIOStatsNative(nativePlayer, stats)) {
+            FileIOStats(
+                bytesRead = stats[0],
+                readSyscalls = stats[1],
+                stallTimeInMicros = stats[2],
+                seekCount = stats[3]
+            )
+        } else {
+            null
+        }
+    }
+
+    /**
+     * Blocking FFmpeg io (open, probe, read and seek) of player and external subtitle longer than timeout
+     * is interrupted, 0 means no timeout.
+     */
+    fun setBlockingIOTimeout(timeoutInMillis: Long) {
+        blockingIOTimeout.set(max(0L, timeoutInMillis))
+        withInterrupt { setInterruptTimeoutNative(it, blockingIOTimeout.get()) }
+        if (getState() != tMediaPlayerState.Released) {
+            externalSubtitle.get()?.setBlockingIOTimeout(blockingIOTimeout.get())
+        }
+    }
+
+    fun getBlockingIOTimeout(): Long = blockingIOTimeout.get()
+
+    /**
+     * Interrupt current blocking io, later calls are not affected.
+     */
+    fun cancelBlockingIO() {
+        withInterrupt { cancelInterruptNative(it) }
+        if (getState() != tMediaPlayerState.Released) {
+            externalSubtitle.get()?.cancelBlockingIO()
+        }
+    }
+
+    fun getBlockingIOStats(): BlockingIOStats? {
+        val stats = LongArray(5)
+        var isReleased = true
+        withInterrupt {
+            getInterruptStatsNative(it, stats)
+            isReleased = false
+        }
+        if (isReleased) {
+            return null
+        }
+        return BlockingIOStats(
+            interruptCount = stats[0],
+            lastInterruptedOp = stats[1].toInt().toBlockingIOOp(),
+            lastInterruptedCostInMicros = stats[2],
+            maxInterruptedCostInMicros = stats[3],
+            maxBlockingCostInMicros = stats[4]
+        )
+    }
+
+    fun getPrepareTimings(): PrepareTimings {
+        return PrepareTimings(
+            timeToPreparedInMillis = timeToPrepared,
+            timeToFirstFrameInMillis = timeToFirstFrame.get()
+        )
+    }
+
+    fun getPacketAllocStats(): PacketAllocStats? {
+        val nativePlayer = getMediaInfo()?.nativePlayer ?: return null
+        val stats = LongArray(5)
+        return if (getPacketAllocStatsNative(nativePlayer, stats)) {
+            PacketAllocStats(
+                packets = stats[0],
+                payloadAllocations = stats[1],
+                payloadBytes = stats[2],
+                largePayloads = stats[3],
+                maxPayloadSize = stats[4]
+            )
+        } else {
+            null
+        }
+    }
+
+    fun getVideoDecodeThreadsStats(): VideoDecodeThreadsStats? {
+        val nativePlayer = getMediaInfo()?.nativePlayer ?: return null
+        val stats = LongArray(6)
+        return if (getVideoDecodeThreadsStatsNative(nativePlayer, stats)) {
+            VideoDecodeThreadsStats(
+                threadType = stats[0].toInt().toVideoDecodeThreadType(),
+                threadCount = stats[1].toInt(),
+                decodedFrames = stats[2],
+                avgDecodeCostInMicros = stats[3],
+                maxDecodeCostInMicros = stats[4],
+                retuneCount = stats[5]
+            )
+        } else {
+            null
+        }
+    }
+
+    fun getVideoDecodeDegradeStats(): VideoDecodeDegradeStats? {
+        val nativePlayer = getMediaInfo()?.nativePlayer ?: return null
+        val stats = LongArray(7)
+        return if (getVideoDecodeDegradeStatsNative(nativePlayer, stats)) {
+            VideoDecodeDegradeStats(
+                currentLevel = stats[0].toInt(),
+                levelChanges = stats[1],
+                timeAtLevelInMillis = stats.drop(2)
+            )
+        } else {
+            null
+        }
+    }
+
+    fun getLateVideoFrameDropStats(): LateVideoFrameDropStats? {
+        val nativePlayer = getMediaInfo()?.nativePlayer ?: return null
+        val droppedFrames = getLateVideoFrameDropsNative(nativePlayer)
+        val avgDeliverCost = videoDecoder.getAvgFrameDeliverCostInMicros()
+        return LateVideoFrameDropStats(
+            droppedFrames = droppedFrames,
+            avgFrameDeliverCostInMicros = avgDeliverCost,
+            savedCpuTimeInMicros = droppedFrames * avgDeliverCost
+        )
+    }
+
+    fun getVideoConvertStats(): VideoConvertStats? {
+        val nativePlayer = getMediaInfo()?.nativePlayer ?: return null
+        val stats = LongArray(4)
+        return if (getVideoConvertStatsNative(nativePlayer, stats)) {
+            VideoConvertStats(
+                sliceThreadCount = stats[0].toInt(),
+                convertedFrames = stats[1],
+                avgConvertCostInMicros = stats[2],
+                maxConvertCostInMicros = stats[3]
+            )
+        } else {
+            null
+        }
+    }
+
+    fun getProbeCacheStats(): ProbeCacheStats {
+        val stats = LongArray(4)
+        getProbeCacheStatsNative(stats)
+        return ProbeCacheStats(
+            hits = stats[0],
+            misses = stats[1],
+            hitsProbeTimeInMicros = stats[2],
+            missesProbeTimeInMicros = stats[3]
+        )
+    }
+
+    fun clearProbeCache() {
+        clearProbeCacheNative()
+    }
+
+    fun getVideoConvertCacheStats(): VideoConvertCacheStats {
+        val stats = LongArray(4)
+        getVideoConvertCacheStatsNative(stats)
+        return VideoConvertCacheStats(
+            hits = stats[0],
+            misses = stats[1],
+            evictions = stats[2],
+            idleContexts = stats[3].toInt()
+        )
+    }
+
+    fun clearVideoConvertCache() {
+        clearVideoConvertCacheNative()
+    }
+
+    /**
+     * Fast forward (positive) or rewind (negative) by showing key frames only, audio is muted.
+     * Speed absolute value need in [TRICK_PLAY_MIN_SPEED, TRICK_PLAY_MAX_SPEED], 0 back to normal play.
+     */
+    @Synchronized
+    fun setTrickPlaySpeed(speed: Int): OptResult {
+        val state = getState()
+        val mediaInfo = getMediaInfo()
+        if (mediaInfo == null || (state !is tMediaPlayerState.Playing && state !is tMediaPlayerState.Paused)) {
+            MediaLog.e(TAG, "Wrong state: $state for setTrickPlaySpeed() method.")
+            return OptResult.Fail
+        }
+        if (mediaInfo.videoStreamInfo == null || mediaInfo.videoStreamInfo.isAttachment) {
+            MediaLog.e(TAG, "Trick play need video stream.")
+            return OptResult.Fail
+        }
+        if (speed != 0 && abs(speed) !in TRICK_PLAY_MIN_SPEED .. TRICK_PLAY_MAX_SPEED) {
+            MediaLog.e(TAG, "Wrong trick play speed: $speed")
+            return OptResult.Fail
+        }
+        if (speed == trickPlaySpeed.get()) {
+            return OptResult.Success
+        }
+        val position = getProgress().let { if (it >= 0L) it else videoClock.getClock() }.coerceIn(0L, mediaInfo.duration)
+        if (speed != 0 && reversePlayback.get()) {
+            applyReversePlayback(mediaInfo.nativePlayer, false)
+        }
+        applyTrickPlaySpeed(mediaInfo.nativePlayer, speed)
+        MediaLog.d(TAG, "Trick play speed: $speed, position: $position")
+        // Flush queued packets and frames, restart from current position.
+        return seekTo(position)
+    }
+
+    fun getTrickPlaySpeed(): Int = trickPlaySpeed.get()
+
+    /**
+     * Play video backward at normal speed, audio is muted. Native decodes the GOP before current position forward
+     * into a bounded frame cache and emits frames from the newest one, previous GOP is prefetched.
+     */
+    @Synchronized
+    fun setReversePlayback(enabled: Boolean): OptResult {
+        val state = getState()
+        val mediaInfo = getMediaInfo()
+        if (mediaInfo == null || (state !is tMediaPlayerState.Playing && state !is tMediaPlayerState.Paused)) {
+            MediaLog.e(TAG, "Wrong state: $state for setReversePlayback() method.")
+            return OptResult.Fail
+        }
+        if (mediaInfo.videoStreamInfo == null || mediaInfo.videoStreamInfo.isAttachment) {
+            MediaLog.e(TAG, "Reverse playback need video stream.")
+            return OptResult.Fail
+        }
+        if (enabled == reversePlayback.get()) {
+            return OptResult.Success
+        }
+        val position = getProgress().let { if (it >= 0L) it else videoClock.getClock() }.coerceIn(0L, mediaInfo.duration)
+        if (enabled && trickPlaySpeed.get() != 0) {
+            applyTrickPlaySpeed(mediaInfo.nativePlayer, 0)
+        }
+        if (!applyReversePlayback(mediaInfo.nativePlayer, enabled)) {
+            MediaLog.e(TAG, "Set reverse playback fail.")
+            return OptResult.Fail
+        }
+        MediaLog.d(TAG, "Reverse playback: $enabled, position: $position")
+        // Flush queued packets and frames, restart from current position.
+        return seekTo(position)
+    }
+
+    fun isReversePlayback(): Boolean = reversePlayback.get()
+
+    /**
+     * Show next (1) or previous (-1) video frame when paused.
+     * Forward step shows the next frame of live decoder. Backward step replays frames decoded since paused and cached by native
+     * without decoding, if the previous frame is not cached, seek to the key frame and decode to it.
+     */
+    @Synchronized
+    fun stepFrame(step: Int): OptResult {
+        val state = getState()
+        if (state !is tMediaPlayerState.Paused) {
+            MediaLog.e(TAG, "Wrong state: $state for stepFrame() method.")
+            return OptResult.Fail
+        }
+        val mediaInfo = state.mediaInfo
+        if (mediaInfo.videoStreamInfo == null || mediaInfo.videoStreamInfo.isAttachment) {
+            MediaLog.e(TAG, "Step frame need video stream.")
+            return OptResult.Fail
+        }
+        if (trickPlaySpeed.get() != 0 || reversePlayback.get()) {
+            MediaLog.e(TAG, "Step frame not support trick play and reverse playback.")
+            return OptResult.Fail
+        }
+        return when (step) {
+            1 -> {
+                if (videoRenderer.requestRenderForce()) OptResult.Success else OptResult.Fail
+            }
+            -1 -> {
+                val showingPts = videoRenderer.getLastRenderedPts()
+                if (showingPts < 0L) {
+                    MediaLog.e(TAG, "Step frame backward fail, no frame showing.")
+                    return OptResult.Fail
+                }
+                val seekPosition = videoDecoder.stepBackward(mediaInfo.nativePlayer, showingPts) ?: return OptResult.Fail
+                if (seekPosition < 0L) {
+                    MediaLog.d(TAG, "Step frame backward from $showingPts, cached.")
+                    videoRenderer.requestRenderForce()
+                    OptResult.Success
+                } else {
+                    MediaLog.d(TAG, "Step frame backward from $showingPts, decode from $seekPosition.")
+                    // Paused seek result renders the frame before showing frame.
+                    seekTo(seekPosition.coerceIn(0L, mediaInfo.duration))
+                }
+            }
+            else -> {
+                MediaLog.e(TAG, "Wrong step: $step")
+                OptResult.Fail
+            }
+        }
+    }
+
+    fun getFrameStepStats(): FrameStepStats? {
+        val nativePlayer = getMediaInfo()?.nativePlayer ?: return null
+        val stats = LongArray(6)
+        return if (getFrameStepStatsNative(nativePlayer, stats)) {
+            FrameStepStats(
+                cachedFrames = stats[0],
+                cachedBytes = stats[1],
+                cacheHits = stats[2],
+                cacheMisses = stats[3],
+                redecodedFrames = stats[4],
+                replayedFrames = stats[5]
+            )
+        } else {
+            null
+        }
+    }
+
+    fun getReversePlaybackStats(): ReversePlaybackStats? {
+        val nativePlayer = getMediaInfo()?.nativePlayer ?: return null
+        val stats = LongArray(8)
+        return if (getReversePlaybackStatsNative(nativePlayer, stats)) {
+            ReversePlaybackStats(
+                cachedBytes = stats[0],
+                peakCachedBytes = stats[1],
+                cachedFrames = stats[2],
+                decodedGops = stats[3],
+                decodedFrames = stats[4],
+                gopDecodeTimeInMicros = stats[5],
+                emittedFrames = stats[6],
+                stallTimeInMicros = stats[7]
+            )
+        } else {
+            null
+        }
+    }
     // endregion
 
     // region Player internal methods.
 
+    private fun applyTrickPlaySpeed(nativePlayer: Long, speed: Int) {
+        trickPlaySpeed.set(speed)
+        setTrickPlaySpeedNative(nativePlayer, speed)
+        // Video is master clock when trick play.
+        val clockSpeed = if (speed != 0) speed.toDouble() else 1.0
+        videoClock.setSpeed(clockSpeed)
+        externalClock.setSpeed(clockSpeed)
+    }
+
+    private fun applyReversePlayback(nativePlayer: Long, enabled: Boolean): Boolean {
+        if (setReversePlaybackNative(nativePlayer, enabled, reversePlaybackCacheSize).toOptResult() != OptResult.Success) {
+            return false
+        }
+        reversePlayback.set(enabled)
+        // Video is master clock when reverse playback, clock runs backward.
+        val clockSpeed = if (enabled) -1.0 else 1.0
+        videoClock.setSpeed(clockSpeed)
+        externalClock.setSpeed(clockSpeed)
+        return true
+    }
+
+    private fun updateVideoTargetOutputSize(width: Int, height: Int) {
+        videoTargetOutputSize.set(width to height)
+        if (videoDownscaleToView) {
+            val nativePlayer = getMediaInfo()?.nativePlayer ?: return
+            setVideoTargetOutputSizeNative(nativePlayer, width, height)
+        }
+    }
+
+    /**
+     * Call by packet reader thread after audio packet queue flushed for new audio track.
+     */
+    internal fun switchAudioResult(position: Long) {
+        // Old track frames dropped by serial changed.
+        audioRenderer.flush()
+        audioClock.setClock(position, audioPacketQueue.getSerial())
+        externalClock.syncToClock(audioClock)
+        audioDecoder.requestDecode()
+    }
+
     internal fun seekResult(position: Long, result: OptResult) {
         val state = getState()
         if (result == OptResult.Success) {
@@ -602,6 +1174,9 @@ class tMediaPlayer(
         val mediaInfo = getMediaInfo()
         return if (mediaInfo == null) {
             ExternalClock
+        } else if ((trickPlaySpeed.get() != 0 || reversePlayback.get()) && mediaInfo.videoStreamInfo != null && !mediaInfo.videoStreamInfo.isAttachment) {
+            // Audio is discarded when trick play and reverse playback.
+            VideoMaster
         } else if (syncType == VideoMaster) {
             if (mediaInfo.videoStreamInfo != null && !mediaInfo.videoStreamInfo.isAttachment) {
                 VideoMaster
@@ -641,18 +1216,66 @@ class tMediaPlayer(
         }
     }
 
-    private fun getMediaInfo(nativePlayer: Long): MediaInfo {
-        fun convertMetadataToMap(metadataArray: Array<String>): Map<String, String> {
-            val metadata = mutableMapOf<String, String>()
-            repeat(metadataArray.size / 2) {
-                val key = metadataArray[it * 2]
-                val value = metadataArray[it * 2 + 1]
-                metadata[key] = value
+    private fun convertMetadataToMap(metadataArray: Array<String>): Map<String, String> {
+        val metadata = mutableMapOf<String, String>()
+        repeat(metadataArray.size / 2) {
+            val key = metadataArray[it * 2]
+            val value = metadataArray[it * 2 + 1]
+            metadata[key] = value
+        }
+        return metadata
+    }
+
+    private fun getSubtitleStreams(nativePlayer: Long): List<SubtitleStreamInfo> {
+        val subTitleStreams = mutableListOf<SubtitleStreamInfo>()
+        val subtitleStreamCount = subtitleStreamCountNative(nativePlayer)
+        if (subtitleStreamCount > 0) {
+            repeat(subtitleStreamCount) { index ->
+                subTitleStreams.add(
+                    SubtitleStreamInfo(
+                        streamId = subtitleStreamIdNative(nativePlayer, index),
+                        metadata = convertMetadataToMap(subtitleStreamMetadataNative(nativePlayer, index))
+                    )
+                )
             }
-            return metadata
+            MediaLog.d(TAG, "Find subtitle streams: $subTitleStreams")
         }
+        return subTitleStreams
+    }
 
-        val audioStreamInfo: AudioStreamInfo? = if (containAudioStreamNative(nativePlayer)) {
+    private fun tMediaPlayerState.updateMediaInfo(mediaInfo: MediaInfo): tMediaPlayerState? {
+        return when (this) {
+            tMediaPlayerState.NoInit -> null
+            is tMediaPlayerState.Error -> null
+            tMediaPlayerState.Released -> null
+            is tMediaPlayerState.Paused -> copy(mediaInfo = mediaInfo)
+            is tMediaPlayerState.PlayEnd -> copy(mediaInfo = mediaInfo)
+            is tMediaPlayerState.Playing -> copy(mediaInfo = mediaInfo)
+            is tMediaPlayerState.Prepared -> copy(mediaInfo = mediaInfo)
+            is tMediaPlayerState.Stopped -> copy(mediaInfo = mediaInfo)
+            is tMediaPlayerState.Seeking -> lastState.updateMediaInfo(mediaInfo)?.let { copy(lastState = it) }
+        }
+    }
+
+    private fun getAudioTracks(nativePlayer: Long): List<AudioTrackInfo> {
+        val audioTracks = mutableListOf<AudioTrackInfo>()
+        repeat(audioStreamCountNative(nativePlayer)) { index ->
+            val codecId = audioStreamCodecIdAtNative(nativePlayer, index)
+            audioTracks.add(
+                AudioTrackInfo(
+                    streamId = audioStreamIdAtNative(nativePlayer, index),
+                    audioCodec = FFmpegCodec.entries.find { it.codecId == codecId } ?: FFmpegCodec.UNKNOWN,
+                    audioChannels = audioStreamChannelsAtNative(nativePlayer, index),
+                    audioSimpleRate = audioStreamSampleRateAtNative(nativePlayer, index),
+                    metadata = convertMetadataToMap(audioStreamMetadataAtNative(nativePlayer, index))
+                )
+            )
+        }
+        return audioTracks
+    }
+
+    private fun getAudioStreamInfo(nativePlayer: Long): AudioStreamInfo? {
+        return if (containAudioStreamNative(nativePlayer)) {
             val codecId = audioCodecIdNative(nativePlayer)
             val sampleFormatId = audioSampleFmtNative(nativePlayer)
             AudioStreamInfo(
@@ -673,6 +1296,10 @@ class tMediaPlayer(
             MediaLog.d(TAG, "Don't find audio stream")
             null
         }
+    }
+
+    private fun getMediaInfo(nativePlayer: Long): MediaInfo {
+        val audioStreamInfo = getAudioStreamInfo(nativePlayer)
         val videoStreamInfo: VideoStreamInfo? = if (containVideoStreamNative(nativePlayer)) {
             val codecId = videoCodecIdNative(nativePlayer)
             val pixelFormatId = videoPixelFmtNative(nativePlayer)
@@ -695,19 +1322,7 @@ class tMediaPlayer(
             MediaLog.d(TAG, "Don't find video stream")
             null
         }
-        val subTitleStreams = mutableListOf<SubtitleStreamInfo>()
-        val subtitleStreamCount = subtitleStreamCountNative(nativePlayer)
-        if (subtitleStreamCount > 0) {
-            repeat(subtitleStreamCount) { index ->
-                subTitleStreams.add(
-                    SubtitleStreamInfo(
-                        streamId = subtitleStreamIdNative(nativePlayer, index),
-                        metadata = convertMetadataToMap(subtitleStreamMetadataNative(nativePlayer, index))
-                    )
-                )
-            }
-            MediaLog.d(TAG, "Find subtitle streams: $subTitleStreams")
-        }
+        val subTitleStreams = getSubtitleStreams(nativePlayer)
         return MediaInfo(
             nativePlayer = nativePlayer,
             duration = durationNative(nativePlayer),
@@ -715,7 +1330,8 @@ class tMediaPlayer(
             containerName = getContainerNameNative(nativePlayer),
             audioStreamInfo = audioStreamInfo,
             videoStreamInfo = videoStreamInfo,
-            subtitleStreams = subTitleStreams
+            subtitleStreams = subTitleStreams,
+            audioTracks = if (audioStreamInfo != null) getAudioTracks(nativePlayer) else emptyList()
         )
     }
 
@@ -746,6 +1362,39 @@ class tMediaPlayer(
         }
     }
 
+    /**
+     * Call by packet reader thread, update MediaInfo if fast start prepare discovered new streams.
+     */
+    internal fun checkNewStreamsDiscovered(nativePlayer: Long) {
+        if (takeNewStreamsDiscoveredNative(nativePlayer)) {
+            val subtitleStreams = getSubtitleStreams(nativePlayer)
+            while (true) {
+                val oldState = getState()
+                val oldMediaInfo = getMediaInfoByState(oldState)
+                if (oldMediaInfo == null || oldMediaInfo.nativePlayer != nativePlayer) {
+                    return
+                }
+                val newMediaInfo = oldMediaInfo.copy(subtitleStreams = subtitleStreams)
+                val newState = oldState.updateMediaInfo(newMediaInfo) ?: return
+                if (state.compareAndSet(oldState, newState)) {
+                    MediaLog.d(TAG, "New streams discovered: $subtitleStreams")
+                    callbackExecutor.execute {
+                        listener.get()?.onStreamsDiscovered(newMediaInfo)
+                    }
+                    return
+                }
+            }
+        }
+    }
+
+    internal fun frameRendered() {
+        if (timeToFirstFrame.get() < 0L && timeToPrepared >= 0L) {
+            if (timeToFirstFrame.compareAndSet(-1L, SystemClock.uptimeMillis() - prepareStartTime)) {
+                MediaLog.d(TAG, "Time to first frame: ${timeToFirstFrame.get()}ms")
+            }
+        }
+    }
+
     internal fun readableVideoPacketReady() {
         videoDecoder.readablePacketReady()
     }
@@ -800,12 +1449,20 @@ class tMediaPlayer(
             ) {
                 MediaLog.d(TAG, "Play end.")
                 if (dispatchNewState(new = tMediaPlayerState.PlayEnd(mediaInfo), old = state)) {
+                    // Rewind ends at start.
+                    val endPosition = if (trickPlaySpeed.get() < 0 || reversePlayback.get()) 0L else mediaInfo.duration
+                    if (trickPlaySpeed.get() != 0) {
+                        applyTrickPlaySpeed(mediaInfo.nativePlayer, 0)
+                    }
+                    if (reversePlayback.get()) {
+                        applyReversePlayback(mediaInfo.nativePlayer, false)
+                    }
                     // Clocks
-                    videoClock.setClock(mediaInfo.duration, videoPacketQueue.getSerial())
+                    videoClock.setClock(endPosition, videoPacketQueue.getSerial())
                     videoClock.pause()
-                    audioClock.setClock(mediaInfo.duration, audioPacketQueue.getSerial())
+                    audioClock.setClock(endPosition, audioPacketQueue.getSerial())
                     audioClock.pause()
-                    externalClock.setClock(mediaInfo.duration, audioPacketQueue.getSerial())
+                    externalClock.setClock(endPosition, audioPacketQueue.getSerial())
                     externalClock.pause()
                     // Renders
                     audioRenderer.pause()
@@ -837,11 +1494,92 @@ class tMediaPlayer(
         requestHw: Boolean,
         targetAudioChannels: Int,
         targetAudioSampleRate: Int,
-        targetAudioSampleBitDepth: Int): Int
+        targetAudioSampleBitDepth: Int,
+        ioMode: Int,
+        readAheadBufferSize: Long,
+        fastStart: Boolean,
+        videoDecodeThreadType: Int,
+        videoDecodeThreadCount: Int): Int
+
+    private external fun getFileIOStatsNative(nativePlayer: Long, stats: LongArray): Boolean
+
+    private external fun attachInterruptNative(nativePlayer: Long, nativeInterrupt: Long)
+
+    private external fun allocInterruptNative(): Long
+
+    private external fun abortInterruptNative(nativeInterrupt: Long)
+
+    private external fun cancelInterruptNative(nativeInterrupt: Long)
+
+    private external fun setInterruptTimeoutNative(nativeInterrupt: Long, timeoutInMillis: Long)
 
-    internal fun readPacketInternal(nativePlayer: Long): ReadPacketResult = readPacketNative(nativePlayer).toReadPacketResult()
+    private external fun getInterruptStatsNative(nativeInterrupt: Long, stats: LongArray)
 
-    private external fun readPacketNative(nativePlayer: Long): Int
+    private external fun releaseInterruptNative(nativeInterrupt: Long)
+
+    private external fun takeNewStreamsDiscoveredNative(nativePlayer: Long): Boolean
+
+    private external fun getPacketAllocStatsNative(nativePlayer: Long, stats: LongArray): Boolean
+
+    private external fun getVideoDecodeThreadsStatsNative(nativePlayer: Long, stats: LongArray): Boolean
+
+    private external fun getVideoDecodeDegradeStatsNative(nativePlayer: Long, stats: LongArray): Boolean
+
+    private external fun getLateVideoFrameDropsNative(nativePlayer: Long): Long
+
+    private external fun getVideoConvertStatsNative(nativePlayer: Long, stats: LongArray): Boolean
+
+    private external fun getProbeCacheStatsNative(stats: LongArray)
+
+    private external fun clearProbeCacheNative()
+
+    private external fun getVideoConvertCacheStatsNative(stats: LongArray)
+
+    private external fun clearVideoConvertCacheNative()
+
+    private external fun attachPacketQueuesNative(nativePlayer: Long, nativeVideoQueue: Long, nativeAudioQueue: Long)
+
+    internal fun readPacketsToQueuesInternal(
+        nativePlayer: Long,
+        maxBytes: Long,
+        maxDurationInMillis: Long,
+        requestAttachment: Boolean
+    ): ReadPacketsToQueueResult = readPacketsToQueuesNative(nativePlayer, maxBytes, maxDurationInMillis, requestAttachment).toReadPacketsToQueueResult()
+
+    private external fun readPacketsToQueuesNative(
+        nativePlayer: Long,
+        maxBytes: Long,
+        maxDurationInMillis: Long,
+        requestAttachment: Boolean
+    ): Int
+
+    private external fun setSelectedSubtitleStreamNative(nativePlayer: Long, streamIndex: Int)
+
+    private external fun setVideoDiscardedNative(nativePlayer: Long, discarded: Boolean)
+
+    private external fun setVideoLateFramePolicyNative(nativePlayer: Long, degrade: Boolean, dropLateFrames: Boolean)
+
+    private external fun setVideoHighBitDepthPassthroughNative(nativePlayer: Long, passthrough: Boolean)
+
+    private external fun setVideoConvertThreadCountNative(nativePlayer: Long, threadCount: Int)
+
+    private external fun setVideoTargetOutputSizeNative(nativePlayer: Long, width: Int, height: Int)
+
+    private external fun setTrickPlaySpeedNative(nativePlayer: Long, speed: Int)
+
+    private external fun setReversePlaybackNative(nativePlayer: Long, enabled: Boolean, cacheSize: Long): Int
+
+    private external fun getReversePlaybackStatsNative(nativePlayer: Long, stats: LongArray): Boolean
+
+    private external fun setFrameStepCacheSizeNative(nativePlayer: Long, cacheSize: Long)
+
+    private external fun setFrameStepCacheEnabledNative(nativePlayer: Long, enabled: Boolean)
+
+    internal fun stepVideoFrameBackwardInternal(nativePlayer: Long, showingPts: Long): Long = stepVideoFrameBackwardNative(nativePlayer, showingPts)
+
+    private external fun stepVideoFrameBackwardNative(nativePlayer: Long, showingPts: Long): Long
+
+    private external fun getFrameStepStatsNative(nativePlayer: Long, stats: LongArray): Boolean
 
     private external fun pauseReadPacketNative(nativePlayer: Long): Int
 
@@ -855,37 +1593,46 @@ class tMediaPlayer(
 
     private external fun seekToNative(nativePlayer: Long, targetPosInMillis: Long): Int
 
-    internal fun decodeVideoInternal(nativePlayer: Long, pkt: Packet?): DecodeResult {
-        return decodeVideoNative(nativePlayer, pkt?.nativePacket ?: 0L).toDecodeResult()
-    }
-
-    private external fun decodeVideoNative(nativePlayer: Long, nativeBuffer: Long): Int
-
-    internal fun flushVideoCodecBufferInternal(nativePlayer: Long) = flushVideoCodecBufferNative(nativePlayer)
+    internal fun videoPacketSerialInternal(nativePlayer: Long): Int = videoPacketSerialNative(nativePlayer)
 
-    private external fun flushVideoCodecBufferNative(nativePlayer: Long)
-
-    internal fun moveDecodedVideoFrameToBufferInternal(nativePlayer: Long, videoFrame: VideoFrame): OptResult {
-        return moveDecodedVideoFrameToBufferNative(nativePlayer, videoFrame.nativeFrame).toOptResult()
-    }
+    private external fun videoPacketSerialNative(nativePlayer: Long): Int
 
-    private external fun moveDecodedVideoFrameToBufferNative(nativePlayer: Long, nativeBuffer: Long): Int
-
-    internal fun decodeAudioInternal(nativePlayer: Long, pkt: Packet?): DecodeResult {
-        return decodeAudioNative(nativePlayer, pkt?.nativePacket ?: 0L).toDecodeResult()
+    internal fun decodeVideoToBuffersInternal(
+        nativePlayer: Long,
+        nativeBuffers: LongArray,
+        count: Int,
+        descriptors: LongArray
+    ): DecodeToBuffersResult {
+        // Video is master clock, it never late.
+        val masterClock = if (getSyncType() != VideoMaster) getMasterClock() else -1L
+        return decodeVideoToBuffersNative(nativePlayer, nativeBuffers, count, masterClock, descriptors).toDecodeToBuffersResult()
     }
 
-    private external fun decodeAudioNative(nativePlayer: Long, nativeBuffer: Long): Int
+    private external fun decodeVideoToBuffersNative(
+        nativePlayer: Long,
+        nativeBuffers: LongArray,
+        count: Int,
+        masterClockInMillis: Long,
+        descriptors: LongArray
+    ): Int
 
-    internal fun flushAudioCodecBufferInternal(nativePlayer: Long) = flushAudioCodecBufferNative(nativePlayer)
+    internal fun decodeAudioToBuffersInternal(
+        nativePlayer: Long,
+        nativeBuffers: LongArray,
+        count: Int,
+        descriptors: LongArray
+    ): DecodeToBuffersResult = decodeAudioToBuffersNative(nativePlayer, nativeBuffers, count, descriptors).toDecodeToBuffersResult()
 
-    private external fun flushAudioCodecBufferNative(nativePlayer: Long)
+    private external fun decodeAudioToBuffersNative(
+        nativePlayer: Long,
+        nativeBuffers: LongArray,
+        count: Int,
+        descriptors: LongArray
+    ): Int
 
-    internal fun moveDecodedAudioFrameToBufferInternal(nativePlayer: Long, audioFrame: AudioFrame): OptResult {
-        return moveDecodedAudioFrameToBufferNative(nativePlayer, audioFrame.nativeFrame).toOptResult()
-    }
+    internal fun audioPacketSerialInternal(nativePlayer: Long): Int = audioPacketSerialNative(nativePlayer)
 
-    private external fun moveDecodedAudioFrameToBufferNative(nativePlayer: Long, nativeBuffer: Long): Int
+    private external fun audioPacketSerialNative(nativePlayer: Long): Int
 
     private external fun releaseNative(nativePlayer: Long)
     // endregion
@@ -948,6 +1695,22 @@ class tMediaPlayer(
     private external fun audioDecoderNameNative(nativePlayer: Long): String
 
     private external fun audioStreamMetadataNative(nativePlayer: Long): Array<String>
+
+    private external fun audioStreamIdNative(nativePlayer: Long): Int
+
+    private external fun audioStreamCountNative(nativePlayer: Long): Int
+
+    private external fun audioStreamIdAtNative(nativePlayer: Long, index: Int): Int
+
+    private external fun audioStreamCodecIdAtNative(nativePlayer: Long, index: Int): Int
+
+    private external fun audioStreamChannelsAtNative(nativePlayer: Long, index: Int): Int
+
+    private external fun audioStreamSampleRateAtNative(nativePlayer: Long, index: Int): Int
+
+    private external fun audioStreamMetadataAtNative(nativePlayer: Long, index: Int): Array<String>
+
+    private external fun switchAudioStreamNative(nativePlayer: Long, streamIndex: Int, positionInMillis: Long): Int
     // endregion
 
     // region Native subtitle stream info
@@ -974,6 +1737,40 @@ class tMediaPlayer(
     private external fun releasePacketNative(nativeBuffer: Long)
     // endregion
 
+    // region Native packet queue
+    internal fun allocPacketQueueInternal(): Long = allocPacketQueueNative()
+
+    private external fun allocPacketQueueNative(): Long
+
+    internal fun getPacketQueueCountInternal(nativeQueue: Long): Int = getPacketQueueCountNative(nativeQueue)
+
+    private external fun getPacketQueueCountNative(nativeQueue: Long): Int
+
+    internal fun getPacketQueueSizeInBytesInternal(nativeQueue: Long): Long = getPacketQueueSizeInBytesNative(nativeQueue)
+
+    private external fun getPacketQueueSizeInBytesNative(nativeQueue: Long): Long
+
+    internal fun getPacketQueueDurationInternal(nativeQueue: Long): Long = getPacketQueueDurationNative(nativeQueue)
+
+    private external fun getPacketQueueDurationNative(nativeQueue: Long): Long
+
+    internal fun getPacketQueueSerialInternal(nativeQueue: Long): Int = getPacketQueueSerialNative(nativeQueue)
+
+    private external fun getPacketQueueSerialNative(nativeQueue: Long): Int
+
+    internal fun flushPacketQueueInternal(nativeQueue: Long) = flushPacketQueueNative(nativeQueue)
+
+    private external fun flushPacketQueueNative(nativeQueue: Long)
+
+    internal fun clearPacketQueueInternal(nativeQueue: Long) = clearPacketQueueNative(nativeQueue)
+
+    private external fun clearPacketQueueNative(nativeQueue: Long)
+
+    internal fun releasePacketQueueInternal(nativeQueue: Long) = releasePacketQueueNative(nativeQueue)
+
+    private external fun releasePacketQueueNative(nativeQueue: Long)
+    // endregion
+
     // region Native video buffer
     internal fun allocVideoBufferInternal(): Long = allocVideoBufferNative()
 
@@ -1042,6 +1839,21 @@ class tMediaPlayer(
     internal fun releaseVideoBufferInternal(nativeBuffer: Long) = releaseVideoBufferNative(nativeBuffer)
 
     private external fun releaseVideoBufferNative(nativeBuffer: Long)
+
+    internal fun unrefVideoBufferInternal(nativeBuffer: Long) = unrefVideoBufferNative(nativeBuffer)
+
+    private external fun unrefVideoBufferNative(nativeBuffer: Long)
+
+    internal fun getVideoFrameLineSizeInternal(nativeBuffer: Long, plane: Int): Int = getVideoFrameLineSizeNative(nativeBuffer, plane)
+
+    private external fun getVideoFrameLineSizeNative(nativeBuffer: Long, plane: Int): Int
+
+    /**
+     * Direct view of native plane memory without copy, it's valid until the buffer is unref or reused.
+     */
+    internal fun getVideoFramePlaneInternal(nativeBuffer: Long, plane: Int): ByteBuffer? = getVideoFramePlaneNative(nativeBuffer, plane)
+
+    private external fun getVideoFramePlaneNative(nativeBuffer: Long, plane: Int): ByteBuffer?
     // endregion
 
     // region Native audio buffer
@@ -1070,6 +1882,19 @@ class tMediaPlayer(
     companion object {
         private const val TAG = "tMediaPlayer"
 
+        // 8 mb
+        private const val DEFAULT_READ_AHEAD_BUFFER_SIZE = 8L * 1024L * 1024L
+
+        // 64 mb
+        private const val DEFAULT_REVERSE_PLAYBACK_CACHE_SIZE = 64L * 1024L * 1024L
+
+        // 32 mb
+        private const val DEFAULT_FRAME_STEP_CACHE_SIZE = 32L * 1024L * 1024L
+
+        // Keep same with native.
+        const val TRICK_PLAY_MIN_SPEED = 4
+        const val TRICK_PLAY_MAX_SPEED = 32
+
         init {
             System.loadLibrary("tmediaplayer")
         }
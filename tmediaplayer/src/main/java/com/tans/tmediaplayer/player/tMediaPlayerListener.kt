@@ -1,9 +1,16 @@
 package com.tans.tmediaplayer.player
 
+import com.tans.tmediaplayer.player.model.MediaInfo
+
 @Suppress("ClassName")
 interface tMediaPlayerListener {
 
     fun onPlayerState(state: tMediaPlayerState)
 
     fun onProgressUpdate(progress: Long, duration: Long)
+
+    /**
+     * Fast start prepare discovered streams after prepared.
+     */
+    fun onStreamsDiscovered(mediaInfo: MediaInfo) {}
 }
\ No newline at end of file
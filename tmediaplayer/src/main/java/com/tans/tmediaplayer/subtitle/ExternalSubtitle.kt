@@ -126,6 +126,7 @@ internal class ExternalSubtitle(val player: tMediaPlayer) {
 
     init {
         externalSubtitlePktReaderNative.set(createExternalSubtitlePktReaderNative())
+        setBlockingIOTimeout(player.getBlockingIOTimeout())
         pktReaderThread
         while (!isLooperPrepared.get()) {}
         readerHandler
@@ -141,6 +142,8 @@ internal class ExternalSubtitle(val player: tMediaPlayer) {
         if (lastLoadedFile != file) {
             val state = getState()
             if (state in activeStates) {
+                // Last file may still loading.
+                cancelBlockingIO()
                 loadedFile.set(file)
                 readerHandler.removeMessages(HandlerMsg.RequestLoadFile.ordinal)
                 val msg = readerHandler.obtainMessage(HandlerMsg.RequestLoadFile.ordinal, file)
@@ -164,6 +167,20 @@ internal class ExternalSubtitle(val player: tMediaPlayer) {
         }
     }
 
+    fun setBlockingIOTimeout(timeoutInMillis: Long) {
+        val readerNative = externalSubtitlePktReaderNative.get()
+        if (readerNative != null) {
+            setTimeoutNative(readerNative, timeoutInMillis)
+        }
+    }
+
+    fun cancelBlockingIO() {
+        val readerNative = externalSubtitlePktReaderNative.get()
+        if (readerNative != null) {
+            cancelNative(readerNative)
+        }
+    }
+
     fun play() {
         subtitle.play()
     }
@@ -177,6 +194,11 @@ internal class ExternalSubtitle(val player: tMediaPlayer) {
     }
 
     fun release() {
+        val readerNativeToAbort = externalSubtitlePktReaderNative.get()
+        if (readerNativeToAbort != null) {
+            // Reader thread may block on file io and hold the lock.
+            abortNative(readerNativeToAbort)
+        }
         synchronized(this) {
             val readerNative = externalSubtitlePktReaderNative.get()
             val state = state.get()
@@ -222,6 +244,12 @@ internal class ExternalSubtitle(val player: tMediaPlayer) {
 
     private external fun movePacketRefNative(readerNative: Long, packetNative: Long)
 
+    private external fun setTimeoutNative(readerNative: Long, timeoutInMillis: Long)
+
+    private external fun cancelNative(readerNative: Long)
+
+    private external fun abortNative(readerNative: Long)
+
     private external fun releaseNative(readerNative: Long)
 
     companion object {
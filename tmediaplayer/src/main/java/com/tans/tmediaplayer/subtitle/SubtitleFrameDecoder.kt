@@ -58,7 +58,8 @@ internal class SubtitleFrameDecoder(
                                                 requestDecode()
                                                 MediaLog.d(TAG, "Decode subtitle success: $frame")
                                             }
-                                            DecodeResult.Fail, DecodeResult.FailAndNeedMorePkt, DecodeResult.DecodeEnd -> {
+                                            DecodeResult.Fail, DecodeResult.FailAndNeedMorePkt, DecodeResult.DecodeEnd,
+                                            DecodeResult.NoPkt, DecodeResult.PktEof -> {
                                                 if (decodeResult == DecodeResult.Fail) {
                                                     MediaLog.e(TAG, "Decode subtitle fail.")
                                                 }
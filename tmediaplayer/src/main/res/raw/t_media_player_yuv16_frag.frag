@@ -0,0 +1,36 @@
+#version 300 es
+precision highp float;
+precision highp usampler2D;
+// 16 bits per sample, integer textures only support nearest sampling.
+uniform usampler2D yTexture;
+// U plane of yuv420p10, UV plane of P010.
+uniform usampler2D uTexture;
+uniform usampler2D vTexture;
+uniform int semiPlanar;
+// 1 / 1023 for low bits samples, 1 / 65535 for high bits samples.
+uniform float sampleScale;
+
+in vec2 TexCoord;
+out vec4 FragColor;
+
+vec3 yuvToRgb(float y, float u, float v) {
+    float r, g, b;
+    r = 1.164 * (y - 0.063) + 1.793 * (v - 0.502);
+    g = 1.164 * (y - 0.063) - 0.213 * (u - 0.502) - 0.533 * (v - 0.502);
+    b = 1.164 * (y - 0.063) + 2.112 * (u - 0.502);
+    return vec3(r, g, b);
+}
+
+void main() {
+    float y, u, v;
+    y = float(texture(yTexture, TexCoord).r) * sampleScale;
+    if (semiPlanar == 0) {
+        u = float(texture(uTexture, TexCoord).r) * sampleScale;
+        v = float(texture(vTexture, TexCoord).r) * sampleScale;
+    } else {
+        uvec4 uv = texture(uTexture, TexCoord);
+        u = float(uv.r) * sampleScale;
+        v = float(uv.g) * sampleScale;
+    }
+    FragColor = vec4(yuvToRgb(y, u, v), 1.0);
+}